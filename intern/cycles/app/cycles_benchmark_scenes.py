@@ -0,0 +1,337 @@
+#!/usr/bin/env python3
+#
+# Copyright 2011-2021 Blender Foundation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Generate XML scenes for benchmarking the Cycles standalone executable, and optionally run
+# them with --benchmark and gather the reports into a single JSON file.
+#
+# Scenes are generated from a fixed seed so results are comparable between builds:
+#
+#   cycles_benchmark_scenes.py --output-dir scenes
+#   cycles_benchmark_scenes.py --output-dir scenes --cycles ./bin/cycles --threads 8 \
+#                              --results results.json
+
+import argparse
+import json
+import math
+import os
+import random
+import subprocess
+import sys
+import xml.dom.minidom as dom
+import xml.etree.ElementTree as etree
+
+
+def floats(values):
+    return " ".join("%g" % v for v in values)
+
+
+def write(root, filepath):
+    s = etree.tostring(root)
+    s = dom.parseString(s).toprettyxml()
+
+    with open(filepath, "w") as f:
+        f.write(s)
+
+
+# Scene Building Blocks
+
+def add_common(root, args):
+    etree.SubElement(root, "integrator", max_bounce="4", seed="0")
+
+    # Camera at the origin looking down +Z, at the scene in front of it.
+    tfm = etree.SubElement(root, "transform", translate="0 1 -12")
+    etree.SubElement(tfm, "camera", width=str(args.width), height=str(args.height),
+                     fov="0.7")
+
+    background = etree.SubElement(root, "background")
+    etree.SubElement(background, "background", name="bg", strength="0.2",
+                     color="0.8 0.85 1.0")
+    etree.SubElement(background, "connect", **{"from": "bg background", "to": "output surface"})
+
+    shader = etree.SubElement(root, "shader", name="diffuse")
+    etree.SubElement(shader, "principled_bsdf", name="bsdf", base_color="0.6 0.6 0.6")
+    etree.SubElement(shader, "connect", **{"from": "bsdf bsdf", "to": "output surface"})
+
+    shader = etree.SubElement(root, "shader", name="emission")
+    etree.SubElement(shader, "emission", name="emission", strength="1")
+    etree.SubElement(shader, "connect", **{"from": "emission emission", "to": "output surface"})
+
+
+def add_plane(parent, size, name=None):
+    P = [-size, 0, -size, size, 0, -size, size, 0, size, -size, 0, size]
+    attrs = {"P": floats(P), "nverts": "4", "verts": "0 1 2 3"}
+    if name:
+        attrs["name"] = name
+    etree.SubElement(parent, "mesh", **attrs)
+
+
+def add_grid(parent, resolution, size, subdivision=None):
+    P = []
+    for j in range(resolution + 1):
+        for i in range(resolution + 1):
+            P += [size * (2.0 * i / resolution - 1.0), 0.0, size * (2.0 * j / resolution - 1.0)]
+
+    verts = []
+    for j in range(resolution):
+        for i in range(resolution):
+            v = j * (resolution + 1) + i
+            verts += [v, v + 1, v + resolution + 2, v + resolution + 1]
+
+    attrs = {"P": floats(P), "nverts": " ".join(["4"] * (resolution * resolution)),
+             "verts": " ".join(str(v) for v in verts)}
+    if subdivision:
+        attrs["subdivision"] = subdivision
+    etree.SubElement(parent, "mesh", **attrs)
+
+
+def add_box(parent, size, name=None):
+    s = size
+    P = [-s, -s, -s, s, -s, -s, s, s, -s, -s, s, -s,
+         -s, -s, s, s, -s, s, s, s, s, -s, s, s]
+    verts = [0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4, 2, 3, 7, 6, 1, 2, 6, 5, 0, 4, 7, 3]
+    attrs = {"P": floats(P), "nverts": "4 4 4 4 4 4", "verts": " ".join(str(v) for v in verts)}
+    if name:
+        attrs["name"] = name
+    etree.SubElement(parent, "mesh", **attrs)
+
+
+def add_sphere(parent, segments, rings, radius, name=None):
+    P = [0.0, radius, 0.0]
+    for j in range(1, rings):
+        theta = math.pi * j / rings
+        for i in range(segments):
+            phi = 2.0 * math.pi * i / segments
+            P += [radius * math.sin(theta) * math.cos(phi),
+                  radius * math.cos(theta),
+                  radius * math.sin(theta) * math.sin(phi)]
+    P += [0.0, -radius, 0.0]
+    bottom = 1 + (rings - 1) * segments
+
+    nverts = []
+    verts = []
+    for i in range(segments):
+        nverts.append(3)
+        verts += [0, 1 + (i + 1) % segments, 1 + i]
+    for j in range(rings - 2):
+        for i in range(segments):
+            a = 1 + j * segments
+            b = a + segments
+            nverts.append(4)
+            verts += [a + i, a + (i + 1) % segments, b + (i + 1) % segments, b + i]
+    for i in range(segments):
+        a = 1 + (rings - 2) * segments
+        nverts.append(3)
+        verts += [bottom, a + i, a + (i + 1) % segments]
+
+    attrs = {"P": floats(P), "nverts": " ".join(str(n) for n in nverts),
+             "verts": " ".join(str(v) for v in verts)}
+    if name:
+        attrs["name"] = name
+    etree.SubElement(parent, "mesh", **attrs)
+
+
+def add_ground(root):
+    state = etree.SubElement(root, "state", shader="diffuse")
+    add_plane(state, 20.0)
+
+
+# Scenes
+
+def scene_lights(root, args, rng):
+    """Many small point lights above a ground plane with a few spheres."""
+    add_ground(root)
+
+    state = etree.SubElement(root, "state", shader="diffuse", interpolation="smooth")
+    for i in range(8):
+        tfm = etree.SubElement(state, "transform",
+                               translate=floats([rng.uniform(-6, 6), 1.0, rng.uniform(0, 10)]))
+        add_sphere(tfm, 32, 16, 1.0)
+
+    state = etree.SubElement(root, "state", shader="emission")
+    for i in range(args.lights):
+        co = [rng.uniform(-10, 10), rng.uniform(0.5, 6.0), rng.uniform(-2, 18)]
+        strength = [rng.uniform(0.2, 5.0) for _ in range(3)]
+        etree.SubElement(state, "light", light_type="point", co=floats(co), size="0.05",
+                         strength=floats(strength), use_mis="true")
+
+
+def scene_instances(root, args, rng):
+    """Many instances of a few meshes with random transforms."""
+    add_ground(root)
+
+    state = etree.SubElement(root, "state", shader="diffuse", interpolation="smooth")
+    hidden = etree.SubElement(state, "transform", translate="0 -1000 0")
+    add_sphere(hidden, 24, 12, 0.2, name="sphere")
+    add_box(hidden, 0.2, name="box")
+
+    for i in range(args.instances):
+        translate = [rng.uniform(-10, 10), rng.uniform(0.2, 6.0), rng.uniform(0, 20)]
+        rotate = [rng.uniform(0, 360), rng.random(), rng.random(), rng.random() + 0.01]
+        tfm = etree.SubElement(state, "transform", translate=floats(translate),
+                               rotate=floats(rotate))
+        etree.SubElement(tfm, "instance", geometry=rng.choice(("sphere", "box")))
+
+    light = etree.SubElement(root, "state", shader="emission")
+    etree.SubElement(light, "light", light_type="distant", dir="-0.3 -1 0.5", angle="0.05",
+                     strength="3 3 3", use_mis="true")
+
+
+def scene_hair(root, args, rng):
+    """Dense hair curves over a sphere."""
+    add_ground(root)
+
+    state = etree.SubElement(root, "state", shader="diffuse", interpolation="smooth")
+    tfm = etree.SubElement(state, "transform", translate="0 2 6")
+    add_sphere(tfm, 32, 16, 2.0)
+
+    P = []
+    num_keys = 5
+    for i in range(args.curves):
+        # Uniform directions on the sphere, curving down with gravity.
+        z = rng.uniform(-1.0, 1.0)
+        phi = rng.uniform(0.0, 2.0 * math.pi)
+        r = math.sqrt(1.0 - z * z)
+        n = [r * math.cos(phi), z, r * math.sin(phi)]
+        for k in range(num_keys):
+            t = k / (num_keys - 1)
+            length = 2.0 + 0.8 * t
+            P += [n[0] * length, n[1] * length - 0.6 * t * t, n[2] * length]
+
+    etree.SubElement(tfm, "hair", P=floats(P), radius="0.004",
+                     nkeys=" ".join([str(num_keys)] * args.curves))
+
+    light = etree.SubElement(root, "state", shader="emission")
+    etree.SubElement(light, "light", light_type="distant", dir="-0.3 -1 0.5", angle="0.05",
+                     strength="3 3 3", use_mis="true")
+
+
+def scene_volume(root, args, rng):
+    """Heterogeneous volume in a box, lit by a few lights."""
+    add_ground(root)
+
+    shader = etree.SubElement(root, "shader", name="smoke")
+    etree.SubElement(shader, "noise_texture", name="noise", scale="2", detail="4")
+    etree.SubElement(shader, "principled_volume", name="volume", color="0.8 0.8 0.8")
+    etree.SubElement(shader, "connect", **{"from": "noise fac", "to": "volume density"})
+    etree.SubElement(shader, "connect", **{"from": "volume volume", "to": "output volume"})
+
+    state = etree.SubElement(root, "state", shader="smoke")
+    tfm = etree.SubElement(state, "transform", translate="0 2.5 6")
+    add_box(tfm, 2.5)
+
+    light = etree.SubElement(root, "state", shader="emission")
+    for i in range(4):
+        co = [rng.uniform(-6, 6), rng.uniform(3, 6), rng.uniform(0, 10)]
+        etree.SubElement(light, "light", light_type="point", co=floats(co), size="0.2",
+                         strength="40 40 40", use_mis="true")
+
+
+def scene_displacement(root, args, rng):
+    """Adaptive subdivision of a grid with procedural true displacement."""
+    shader = etree.SubElement(root, "shader", name="displace", displacement_method="true")
+    etree.SubElement(shader, "principled_bsdf", name="bsdf", base_color="0.6 0.5 0.4")
+    etree.SubElement(shader, "noise_texture", name="noise", scale="1.5", detail="6")
+    etree.SubElement(shader, "displacement", name="displacement", scale="1.5")
+    etree.SubElement(shader, "connect", **{"from": "bsdf bsdf", "to": "output surface"})
+    etree.SubElement(shader, "connect", **{"from": "noise fac", "to": "displacement height"})
+    etree.SubElement(shader, "connect",
+                     **{"from": "displacement displacement", "to": "output displacement"})
+
+    state = etree.SubElement(root, "state", shader="displace", interpolation="smooth",
+                             dicing_rate=str(args.dicing_rate))
+    tfm = etree.SubElement(state, "transform", translate="0 0 8")
+    add_grid(tfm, 8, 12.0, subdivision="catmull-clark")
+
+    light = etree.SubElement(root, "state", shader="emission")
+    etree.SubElement(light, "light", light_type="distant", dir="-0.5 -1 0.3", angle="0.05",
+                     strength="3 3 3", use_mis="true")
+
+
+SCENES = {
+    "lights": scene_lights,
+    "instances": scene_instances,
+    "hair": scene_hair,
+    "volume": scene_volume,
+    "displacement": scene_displacement,
+}
+
+
+def generate(args):
+    os.makedirs(args.output_dir, exist_ok=True)
+
+    filepaths = []
+    for name in args.scenes:
+        # Seed per scene, so one scene doesn't change when others are modified.
+        rng = random.Random("%s-%d" % (name, args.seed))
+
+        root = etree.Element("cycles")
+        add_common(root, args)
+        SCENES[name](root, args, rng)
+
+        filepath = os.path.join(args.output_dir, name + ".xml")
+        write(root, filepath)
+        filepaths.append(filepath)
+
+    return filepaths
+
+
+def run(args, filepaths):
+    results = {}
+    for filepath in filepaths:
+        name = os.path.splitext(os.path.basename(filepath))[0]
+        command = [args.cycles, "--benchmark", "--samples", str(args.samples),
+                   "--threads", str(args.threads), filepath]
+
+        print("Rendering %s" % name, file=sys.stderr)
+        output = subprocess.check_output(command, universal_newlines=True)
+        # The report is the last JSON object written to standard output.
+        results[name] = json.loads(output[output.index("{\n"):])
+
+    if args.results:
+        with open(args.results, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+    else:
+        json.dump(results, sys.stdout, indent=2, sort_keys=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate and run Cycles benchmark scenes.")
+    parser.add_argument("--output-dir", required=True, help="Directory to write scenes to")
+    parser.add_argument("--scenes", nargs="+", choices=sorted(SCENES.keys()),
+                        default=sorted(SCENES.keys()), help="Scenes to generate")
+    parser.add_argument("--seed", type=int, default=0, help="Seed for scene generation")
+    parser.add_argument("--width", type=int, default=640)
+    parser.add_argument("--height", type=int, default=360)
+    parser.add_argument("--lights", type=int, default=1000, help="Number of lights")
+    parser.add_argument("--instances", type=int, default=100000, help="Number of instances")
+    parser.add_argument("--curves", type=int, default=200000, help="Number of hair curves")
+    parser.add_argument("--dicing-rate", type=float, default=1.0,
+                        help="Dicing rate of the displaced grid, in pixels")
+    parser.add_argument("--cycles", help="Cycles executable, to render the generated scenes")
+    parser.add_argument("--samples", type=int, default=16)
+    parser.add_argument("--threads", type=int, default=0,
+                        help="Render threads, fix for comparable results")
+    parser.add_argument("--results", help="File to write results to, standard output if unset")
+    args = parser.parse_args()
+
+    filepaths = generate(args)
+    if args.cycles:
+        run(args, filepaths)
+
+
+if __name__ == "__main__":
+    main()
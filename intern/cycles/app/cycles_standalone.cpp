@@ -22,6 +22,7 @@
 #include "render/integrator.h"
 #include "render/scene.h"
 #include "render/session.h"
+#include "render/stats.h"
 
 #include "util/util_args.h"
 #include "util/util_foreach.h"
@@ -54,6 +55,10 @@ struct Options {
   bool quiet;
   bool show_help, interactive, pause;
   string output_path;
+  bool spool;
+  bool benchmark;
+  string benchmark_path;
+  double load_time;
 } options;
 
 static void session_print(const string &str)
@@ -121,6 +126,9 @@ static BufferParams &session_buffer_params()
   buffer_params.full_width = options.width;
   buffer_params.full_height = options.height;
 
+  /* Name the combined pass, to find it when writing spooled tiles. */
+  Pass::add(PASS_COMBINED, buffer_params.passes, "Combined");
+
   return buffer_params;
 }
 
@@ -128,8 +136,14 @@ static void scene_init()
 {
   options.scene = new Scene(options.scene_params, options.session->device);
 
+  if (options.benchmark) {
+    options.scene->enable_update_stats();
+  }
+
   /* Read XML */
+  const double load_start_time = time_dt();
   xml_read_file(options.scene, options.filepath.c_str());
+  options.load_time = time_dt() - load_start_time;
 
   /* Camera width/height override? */
   if (!(options.width == 0 || options.height == 0)) {
@@ -178,6 +192,159 @@ static void session_exit()
   }
 }
 
+/* Benchmark
+ *
+ * Machine readable report of the scene update times, render throughput, memory usage and,
+ * for CPU devices, the kernel profiling samples, to compare performance between builds. */
+
+static string json_string(const string &str)
+{
+  string result = "\"";
+  foreach (char c, str) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    }
+    else if ((unsigned char)c < 0x20) {
+      result += string_printf("\\u%04x", c);
+    }
+    else {
+      result += c;
+    }
+  }
+  return result + "\"";
+}
+
+static string json_time_stats(const NamedTimeStats &stats)
+{
+  string result = string_printf("{\"total\": %f, \"entries\": {", stats.total_time);
+  for (size_t i = 0; i < stats.entries.size(); i++) {
+    result += string_printf("%s%s: %f",
+                            (i == 0) ? "" : ", ",
+                            json_string(stats.entries[i].name).c_str(),
+                            stats.entries[i].time);
+  }
+  return result + "}}";
+}
+
+static string json_nested_sample_stats(NamedNestedSampleStats &stats)
+{
+  string result = string_printf("{\"name\": %s, \"self_samples\": %llu, \"sum_samples\": %llu",
+                                json_string(stats.name).c_str(),
+                                (unsigned long long)stats.self_samples,
+                                (unsigned long long)stats.sum_samples);
+  if (!stats.entries.empty()) {
+    result += ", \"entries\": [";
+    for (size_t i = 0; i < stats.entries.size(); i++) {
+      result += (i == 0) ? "" : ", ";
+      result += json_nested_sample_stats(stats.entries[i]);
+    }
+    result += "]";
+  }
+  return result + "}";
+}
+
+static string json_sample_count_stats(const NamedSampleCountStats &stats)
+{
+  string result = "{";
+  bool first = true;
+  foreach (const NamedSampleCountStats::entry_map::value_type &entry, stats.entries) {
+    result += string_printf("%s%s: {\"samples\": %llu, \"hits\": %llu}",
+                            first ? "" : ", ",
+                            json_string(entry.second.name.string()).c_str(),
+                            (unsigned long long)entry.second.samples,
+                            (unsigned long long)entry.second.hits);
+    first = false;
+  }
+  return result + "}";
+}
+
+static void benchmark_report()
+{
+  Session *session = options.session;
+  Scene *scene = options.scene;
+
+  double total_time, render_time;
+  session->progress.get_time(total_time, render_time);
+
+  const int samples = session->params.samples;
+  const double pixel_samples = (double)options.width * options.height * samples;
+
+  RenderStats render_stats;
+  session->collect_statistics(&render_stats);
+
+  string report = "{\n";
+  report += string_printf("  \"file\": %s,\n", json_string(options.filepath).c_str());
+  report += string_printf("  \"device\": %s,\n",
+                          json_string(session->params.device.description).c_str());
+  report += string_printf("  \"threads\": %d,\n", session->params.threads);
+  report += string_printf("  \"width\": %d,\n  \"height\": %d,\n  \"samples\": %d,\n",
+                          options.width,
+                          options.height,
+                          samples);
+  report += string_printf("  \"scene\": {\"objects\": %d, \"geometry\": %d, \"lights\": %d, "
+                          "\"shaders\": %d},\n",
+                          (int)scene->objects.size(),
+                          (int)scene->geometry.size(),
+                          (int)scene->lights.size(),
+                          (int)scene->shaders.size());
+
+  /* Timings in seconds, the render time excludes scene updates. */
+  report += string_printf("  \"time\": {\"load\": %f, \"total\": %f, \"render\": %f},\n",
+                          options.load_time,
+                          total_time,
+                          render_time);
+  report += string_printf("  \"pixel_samples_per_second\": %f,\n",
+                          (render_time > 0.0) ? pixel_samples / render_time : 0.0);
+
+  SceneUpdateStats *update_stats = scene->update_stats;
+  report += "  \"update\": {\n";
+  report += "    \"scene\": " + json_time_stats(update_stats->scene.times) + ",\n";
+  report += "    \"geometry\": " + json_time_stats(update_stats->geometry.times) + ",\n";
+  report += "    \"light\": " + json_time_stats(update_stats->light.times) + ",\n";
+  report += "    \"object\": " + json_time_stats(update_stats->object.times) + ",\n";
+  report += "    \"image\": " + json_time_stats(update_stats->image.times) + ",\n";
+  report += "    \"background\": " + json_time_stats(update_stats->background.times) + ",\n";
+  report += "    \"camera\": " + json_time_stats(update_stats->camera.times) + ",\n";
+  report += "    \"film\": " + json_time_stats(update_stats->film.times) + ",\n";
+  report += "    \"integrator\": " + json_time_stats(update_stats->integrator.times) + ",\n";
+  report += "    \"osl\": " + json_time_stats(update_stats->osl.times) + ",\n";
+  report += "    \"svm\": " + json_time_stats(update_stats->svm.times) + ",\n";
+  report += "    \"tables\": " + json_time_stats(update_stats->tables.times) + "\n";
+  report += "  },\n";
+
+  /* Device memory in bytes. */
+  report += string_printf("  \"memory\": {\"used\": %llu, \"peak\": %llu, \"geometry\": %llu, "
+                          "\"textures\": %llu}",
+                          (unsigned long long)session->stats.mem_used,
+                          (unsigned long long)session->stats.mem_peak,
+                          (unsigned long long)render_stats.mesh.geometry.total_size,
+                          (unsigned long long)render_stats.image.textures.total_size);
+
+  if (render_stats.has_profiling) {
+    render_stats.kernel.update_sum();
+    report += ",\n  \"profiling\": {\n";
+    report += "    \"kernel\": " + json_nested_sample_stats(render_stats.kernel) + ",\n";
+    report += "    \"shaders\": " + json_sample_count_stats(render_stats.shaders) + ",\n";
+    report += "    \"objects\": " + json_sample_count_stats(render_stats.objects) + "\n";
+    report += "  }";
+  }
+  report += "\n}\n";
+
+  if (options.benchmark_path.empty()) {
+    printf("%s", report.c_str());
+    return;
+  }
+
+  FILE *f = path_fopen(options.benchmark_path, "wb");
+  if (!f) {
+    fprintf(stderr, "Failed to write benchmark report %s\n", options.benchmark_path.c_str());
+    return;
+  }
+  fwrite(report.data(), 1, report.size(), f);
+  fclose(f);
+}
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
 static void display_info(Progress &progress)
 {
@@ -367,6 +534,8 @@ static void options_parse(int argc, const char **argv)
   options.filepath = "";
   options.session = NULL;
   options.quiet = false;
+  options.benchmark = false;
+  options.load_time = 0.0;
 
   /* device names */
   string device_names = "";
@@ -414,6 +583,10 @@ static void options_parse(int argc, const char **argv)
              "--output %s",
              &options.output_path,
              "File path to write output image",
+             "--spool",
+             &options.spool,
+             "Write finished tiles straight to the output file as a tiled multilayer EXR, "
+             "without keeping the full render in memory",
              "--threads %d",
              &options.session_params.threads,
              "CPU Rendering Threads",
@@ -429,6 +602,12 @@ static void options_parse(int argc, const char **argv)
              "--tile-height %d",
              &options.session_params.tile_size.y,
              "Tile height in pixels",
+             "--benchmark",
+             &options.benchmark,
+             "Render in background and print a JSON report of timings and memory usage",
+             "--benchmark-output %s",
+             &options.benchmark_path,
+             "File path to write the benchmark report to, instead of standard output",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -490,8 +669,21 @@ static void options_parse(int argc, const char **argv)
   options.session_params.background = true;
 #endif
 
-  /* Use progressive rendering */
-  options.session_params.progressive = true;
+  if (options.benchmark) {
+    /* Progress messages would mix with the report. */
+    options.session_params.background = true;
+    options.session_params.use_profiling = true;
+    options.quiet = true;
+  }
+
+  if (options.spool) {
+    options.session_params.background = true;
+    options.session_params.spool_filepath = options.output_path;
+  }
+
+  /* Use progressive rendering, unless tiles are spooled since they must be finished one by one
+   * to be freed. */
+  options.session_params.progressive = !options.spool;
 
   /* find matching device */
   DeviceType device_type = Device::type_from_string(devicename.c_str());
@@ -527,6 +719,10 @@ static void options_parse(int argc, const char **argv)
     fprintf(stderr, "No file path specified\n");
     exit(EXIT_FAILURE);
   }
+  else if (options.spool && options.output_path == "") {
+    fprintf(stderr, "No output file path specified for spooling\n");
+    exit(EXIT_FAILURE);
+  }
 
   /* For smoother Viewport */
   options.session_params.start_resolution = 64;
@@ -547,6 +743,9 @@ int main(int argc, const char **argv)
 #endif
     session_init();
     options.session->wait();
+    if (options.benchmark) {
+      benchmark_report();
+    }
     session_exit();
 #ifdef WITH_CYCLES_STANDALONE_GUI
   }
@@ -26,6 +26,7 @@
 #include "render/camera.h"
 #include "render/film.h"
 #include "render/graph.h"
+#include "render/hair.h"
 #include "render/integrator.h"
 #include "render/light.h"
 #include "render/mesh.h"
@@ -379,28 +380,35 @@ static void xml_read_background(XMLReadState &state, xml_node node)
 
 /* Mesh */
 
-static Mesh *xml_add_mesh(Scene *scene, const Transform &tfm)
+static void xml_add_object(Scene *scene, Geometry *geom, const Transform &tfm)
 {
-  /* create mesh */
-  Mesh *mesh = new Mesh();
-  scene->geometry.push_back(mesh);
-
-  /* create object*/
   Object *object = new Object();
-  object->set_geometry(mesh);
+  object->set_geometry(geom);
   object->set_tfm(tfm);
   scene->objects.push_back(object);
+}
 
-  return mesh;
+static void xml_add_geometry(const XMLReadState &state, Geometry *geom, xml_node node)
+{
+  /* named geometry can be instanced by later nodes */
+  string name;
+  if (xml_read_string(&name, node, "name")) {
+    geom->name = ustring(name);
+  }
+
+  array<Node *> used_shaders = geom->get_used_shaders();
+  used_shaders.push_back_slow(state.shader);
+  geom->set_used_shaders(used_shaders);
+
+  state.scene->geometry.push_back(geom);
+  xml_add_object(state.scene, geom, state.tfm);
 }
 
 static void xml_read_mesh(const XMLReadState &state, xml_node node)
 {
   /* add mesh */
-  Mesh *mesh = xml_add_mesh(state.scene, state.tfm);
-  array<Node *> used_shaders = mesh->get_used_shaders();
-  used_shaders.push_back_slow(state.shader);
-  mesh->set_used_shaders(used_shaders);
+  Mesh *mesh = new Mesh();
+  xml_add_geometry(state, mesh, node);
 
   /* read state */
   int shader = 0;
@@ -539,6 +547,64 @@ static void xml_read_mesh(const XMLReadState &state, xml_node node)
   }
 }
 
+/* Hair */
+
+static void xml_read_hair(const XMLReadState &state, xml_node node)
+{
+  /* add hair */
+  Hair *hair = new Hair();
+  xml_add_geometry(state, hair, node);
+
+  /* read curve keys, with one radius per key or a single radius for all keys */
+  vector<float3> P;
+  vector<float> radius;
+  vector<int> nkeys;
+
+  xml_read_float3_array(P, node, "P");
+  xml_read_float_array(radius, node, "radius");
+  xml_read_int_array(nkeys, node, "nkeys");
+
+  size_t num_keys = 0;
+  foreach (int n, nkeys) {
+    num_keys += n;
+  }
+  if (num_keys != P.size() || (radius.size() != 1 && radius.size() != P.size())) {
+    fprintf(stderr, "Invalid hair, expected %d keys and radii.\n", (int)num_keys);
+    return;
+  }
+
+  hair->reserve_curves(nkeys.size(), P.size());
+
+  int first_key = 0;
+  for (size_t i = 0; i < nkeys.size(); i++) {
+    for (int j = first_key; j < first_key + nkeys[i]; j++) {
+      hair->add_curve_key(P[j], (radius.size() == 1) ? radius[0] : radius[j]);
+    }
+    hair->add_curve(first_key, 0);
+    first_key += nkeys[i];
+  }
+}
+
+/* Instance */
+
+static void xml_read_instance(const XMLReadState &state, xml_node node)
+{
+  /* add object for previously read geometry */
+  string name;
+  if (!xml_read_string(&name, node, "geometry")) {
+    return;
+  }
+
+  foreach (Geometry *geom, state.scene->geometry) {
+    if (geom->name == name) {
+      xml_add_object(state.scene, geom, state.tfm);
+      return;
+    }
+  }
+
+  fprintf(stderr, "Unknown geometry \"%s\".\n", name.c_str());
+}
+
 /* Light */
 
 static void xml_read_light(XMLReadState &state, xml_node node)
@@ -638,6 +704,12 @@ static void xml_read_scene(XMLReadState &state, xml_node scene_node)
     else if (string_iequals(node.name(), "mesh")) {
       xml_read_mesh(state, node);
     }
+    else if (string_iequals(node.name(), "hair")) {
+      xml_read_hair(state, node);
+    }
+    else if (string_iequals(node.name(), "instance")) {
+      xml_read_instance(state, node);
+    }
     else if (string_iequals(node.name(), "light")) {
       xml_read_light(state, node);
     }
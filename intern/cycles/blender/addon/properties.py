@@ -397,6 +397,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=0.0, max=1.0,
         default=0.01,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights by their estimated contribution to the shading point, rather than by their size. "
+        "Reduces noise in scenes with many lights",
+        default=False,
+    )
 
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
@@ -687,12 +693,25 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Use special type BVH optimized for hair (uses more ram but renders faster)",
         default=True,
     )
+    debug_use_bvh_quantized_nodes: BoolProperty(
+        name="Compress BVH",
+        description="Store BVH node bounds quantized to 8 bits, using less memory but testing "
+        "slightly more nodes during ray traversal",
+        default=False,
+    )
     debug_bvh_time_steps: IntProperty(
         name="BVH Time Steps",
         description="Split BVH primitives by this number of time steps to speed up render time in cost of memory",
         default=0,
         min=0, max=16,
     )
+    debug_use_bvh_refit: BoolProperty(
+        name="Refit BVH",
+        description="Refit the BVH of deforming geometry between frames instead of rebuilding it, "
+        "when rendering animations with persistent data. Faster scene updates, but rendering may "
+        "get slower as the geometry deforms further away from the last built BVH",
+        default=False,
+    )
     tile_order: EnumProperty(
         name="Tile Order",
         description="Tile order for rendering",
@@ -800,6 +819,35 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Load tiles of image textures on demand at the resolution needed for rendering, "
+        "instead of loading full images into memory (CPU only)",
+        default=False,
+    )
+
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by image tiles in the texture cache, in megabytes",
+        default=4096,
+        min=1, max=1048576,
+        subtype='UNSIGNED',
+    )
+
+    texture_auto_convert: BoolProperty(
+        name="Auto Convert",
+        description="Convert images to tiled and mipmapped .tx files for efficient loading, "
+        "converted files are stored in the cache directory and reused for following renders",
+        default=True,
+    )
+
+    texture_cache_path: StringProperty(
+        name="Cache Directory",
+        description="Directory to store converted images, the user cache directory when empty",
+        default="",
+        subtype='DIR_PATH',
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
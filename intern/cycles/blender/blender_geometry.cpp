@@ -232,4 +232,37 @@ void BlenderSync::sync_geometry_motion(BL::Depsgraph &b_depsgraph,
   }
 }
 
+bool BlenderSync::geometry_is_modified(Geometry *geom)
+{
+  /* Geometry synced in this loop may still be written to by its task, so assume it to be
+   * modified rather than reading its flags. */
+  if (geometry_synced.find(geom) != geometry_synced.end()) {
+    return true;
+  }
+
+  return geom->is_modified();
+}
+
+void BlenderSync::apply_deferred_geometry_updates()
+{
+  /* Applied in the order of the objects, so the last object using the geometry wins. */
+  for (const GeometryMotionSettings &settings : geometry_motion_settings) {
+    Geometry *geom = settings.geom;
+    geom->set_use_motion_blur(false);
+    geom->set_motion_steps(0);
+    geom->set_motion_steps(settings.motion_steps);
+    if (settings.use_motion_blur) {
+      geom->set_use_motion_blur(true);
+    }
+  }
+
+  geometry_motion_settings.clear();
+
+  for (Object *object : objects_tag_update) {
+    object->tag_update(scene);
+  }
+
+  objects_tag_update.clear();
+}
+
 CCL_NAMESPACE_END
@@ -184,10 +184,6 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
     return NULL;
   }
 
-  /* Use task pool only for non-instances, since sync_dupli_particle accesses
-   * geometry. This restriction should be removed for better performance. */
-  TaskPool *object_geom_task_pool = (is_instance) ? NULL : geom_task_pool;
-
   /* key to lookup object */
   ObjectKey key(b_parent, persistent_id, b_ob_instance, use_particle_hair);
   Object *object;
@@ -212,7 +208,7 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
                              object,
                              motion_time,
                              use_particle_hair,
-                             object_geom_task_pool);
+                             geom_task_pool);
     }
 
     return object;
@@ -233,7 +229,7 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
                                      b_ob_instance,
                                      object_updated,
                                      use_particle_hair,
-                                     object_geom_task_pool);
+                                     geom_task_pool);
   object->set_geometry(geometry);
 
   /* special case not tracked by object update flags */
@@ -271,7 +267,7 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
    * transform comparison should not be needed, but duplis don't work perfect
    * in the depsgraph and may not signal changes, so this is a workaround */
   if (object->is_modified() || object_updated ||
-      (object->get_geometry() && object->get_geometry()->is_modified()) ||
+      (object->get_geometry() && geometry_is_modified(object->get_geometry())) ||
       tfm != object->get_tfm()) {
     object->name = b_ob.name().c_str();
     object->set_pass_id(b_ob.pass_index());
@@ -283,24 +279,20 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
     /* motion blur */
     Scene::MotionType need_motion = scene->need_motion();
     if (need_motion != Scene::MOTION_NONE && object->get_geometry()) {
-      Geometry *geom = object->get_geometry();
-      geom->set_use_motion_blur(false);
-      geom->set_motion_steps(0);
-
       uint motion_steps;
+      bool use_motion_blur = false;
 
       if (need_motion == Scene::MOTION_BLUR) {
         motion_steps = object_motion_steps(b_parent, b_ob, Object::MAX_MOTION_STEPS);
-        geom->set_motion_steps(motion_steps);
-        if (motion_steps && object_use_deform_motion(b_parent, b_ob)) {
-          geom->set_use_motion_blur(true);
-        }
+        use_motion_blur = motion_steps && object_use_deform_motion(b_parent, b_ob);
       }
       else {
         motion_steps = 3;
-        geom->set_motion_steps(motion_steps);
       }
 
+      /* Geometry may still be synced by the task pool, set once all tasks are done. */
+      geometry_motion_settings.push_back({object->get_geometry(), motion_steps, use_motion_blur});
+
       motion.resize(motion_steps, transform_empty());
 
       if (motion_steps) {
@@ -328,7 +320,8 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
       object->set_random_id(hash_uint2(hash_string(object->name.c_str()), 0));
     }
 
-    object->tag_update(scene);
+    /* Geometry may still be synced by the task pool, tag once all tasks are done. */
+    objects_tag_update.push_back(object);
   }
 
   if (is_instance) {
@@ -555,6 +548,8 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
 
   geom_task_pool.wait_work();
 
+  apply_deferred_geometry_updates();
+
   progress.set_sync_status("");
 
   if (!cancel && !motion) {
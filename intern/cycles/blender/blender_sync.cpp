@@ -311,6 +311,7 @@ void BlenderSync::sync_integrator()
   integrator->set_sample_all_lights_direct(get_boolean(cscene, "sample_all_lights_direct"));
   integrator->set_sample_all_lights_indirect(get_boolean(cscene, "sample_all_lights_indirect"));
   integrator->set_light_sampling_threshold(get_float(cscene, "light_sampling_threshold"));
+  integrator->set_use_light_tree(get_boolean(cscene, "use_light_tree"));
 
   SamplingPattern sampling_pattern = (SamplingPattern)get_enum(
       cscene, "sampling_pattern", SAMPLING_NUM_PATTERNS, SAMPLING_PATTERN_SOBOL);
@@ -769,7 +770,9 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
 
   params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
+  params.use_bvh_quantized_nodes = RNA_boolean_get(&cscene, "debug_use_bvh_quantized_nodes");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
+  params.use_bvh_refit = RNA_boolean_get(&cscene, "debug_use_bvh_refit");
 
   PointerRNA csscene = RNA_pointer_get(&b_scene.ptr, "cycles_curves");
   params.hair_subdivisions = get_int(csscene, "subdivisions");
@@ -795,6 +798,11 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  params.texture_cache.use_cache = get_boolean(cscene, "use_texture_cache");
+  params.texture_cache.cache_size = get_int(cscene, "texture_cache_size");
+  params.texture_cache.auto_convert = get_boolean(cscene, "texture_auto_convert");
+  params.texture_cache.cache_path = get_string(cscene, "texture_cache_path");
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
@@ -186,6 +186,9 @@ class BlenderSync {
                             bool use_particle_hair,
                             TaskPool *task_pool);
 
+  bool geometry_is_modified(Geometry *geom);
+  void apply_deferred_geometry_updates();
+
   /* Light */
   void sync_light(BL::Object &b_parent,
                   int persistent_id[OBJECT_PERSISTENT_ID_SIZE],
@@ -223,8 +226,8 @@ class BlenderSync {
   id_map<GeometryKey, Geometry> geometry_map;
   id_map<ObjectKey, Light> light_map;
   id_map<ParticleSystemKey, ParticleSystem> particle_system_map;
-  set<Geometry *> geometry_synced;
-  set<Geometry *> geometry_motion_synced;
+  unordered_set<Geometry *> geometry_synced;
+  unordered_set<Geometry *> geometry_motion_synced;
   set<float> motion_times;
   void *world_map;
   bool world_recalc;
@@ -237,6 +240,18 @@ class BlenderSync {
   float dicing_rate;
   int max_subdivisions;
 
+  /* Motion settings of geometry from the objects using it. Geometry synced in the task pool may
+   * still be written to by its task, so these are applied once all tasks are done. */
+  struct GeometryMotionSettings {
+    Geometry *geom;
+    uint motion_steps;
+    bool use_motion_blur;
+  };
+  vector<GeometryMotionSettings> geometry_motion_settings;
+  /* Objects to tag as updated once all tasks are done, tagging writes the modified flags of their
+   * geometry and reads its shaders. */
+  vector<Object *> objects_tag_update;
+
   struct RenderLayerInfo {
     RenderLayerInfo()
         : material_override(PointerRNA_NULL),
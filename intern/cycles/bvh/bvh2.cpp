@@ -39,10 +39,57 @@ int BVHStackEntry::encodeIdx() const
   return (node->is_leaf()) ? ~idx : idx;
 }
 
+/* Quantization of child bounds, relative to the lower bound of the node on each axis, in steps
+ * of a power of two. Bounds are rounded outwards, with the same float operations as the kernel
+ * uses to reconstruct them. */
+
+static float bvh_dequantize(float origin, float scale, int q)
+{
+  return origin + (float)q * scale;
+}
+
+int bvh_quantize_exponent(float origin, float upper)
+{
+  int exponent = -126;
+  if (upper > origin) {
+    frexpf((upper - origin) / 255.0f, &exponent);
+  }
+  exponent = clamp(exponent, -126, 127);
+
+  while (exponent < 127 && bvh_dequantize(origin, ldexpf(1.0f, exponent), 255) < upper) {
+    exponent++;
+  }
+
+  return exponent;
+}
+
+int bvh_quantize_lower(float origin, float scale, float value)
+{
+  int q = (int)clamp(floorf((value - origin) / scale), 0.0f, 255.0f);
+  while (q > 0 && bvh_dequantize(origin, scale, q) > value) {
+    q--;
+  }
+  return q;
+}
+
+int bvh_quantize_upper(float origin, float scale, float value)
+{
+  int q = (int)clamp(ceilf((value - origin) / scale), 0.0f, 255.0f);
+  while (q < 255 && bvh_dequantize(origin, scale, q) < value) {
+    q++;
+  }
+  return q;
+}
+
 BVH2::BVH2(const BVHParams &params_,
            const vector<Geometry *> &geometry_,
            const vector<Object *> &objects_)
-    : BVH(params_, geometry_, objects_)
+    : BVH(params_, geometry_, objects_),
+      build_sah_cost(0.0f),
+      sah_cost(0.0f),
+      num_top_level_nodes(0),
+      num_top_level_leaf_nodes(0),
+      num_top_level_prims(0)
 {
 }
 
@@ -67,6 +114,8 @@ void BVH2::build(Progress &progress, Stats *)
     return;
   }
 
+  build_sah_cost = sah_cost = bvh2_root->computeSubtreeSAHCost(params);
+
   /* BVH builder returns tree in a binary mode (with two children per inner
    * node. Need to adopt that for a wider BVH implementations. */
   BVHNode *root = widen_children_nodes(bvh2_root);
@@ -100,14 +149,46 @@ void BVH2::build(Progress &progress, Stats *)
 
 void BVH2::refit(Progress &progress)
 {
-  progress.set_substatus("Packing BVH primitives");
-  pack_primitives();
+  if (params.top_level) {
+    /* Strip the merged instance BVHs, they are refitted on their own and merged again. */
+    pack.nodes.resize(num_top_level_nodes);
+    pack.leaf_nodes.resize(num_top_level_leaf_nodes);
+    pack.prim_index.resize(num_top_level_prims);
+    pack.prim_type.resize(num_top_level_prims);
+    pack.prim_object.resize(num_top_level_prims);
+    if (pack.prim_time.size()) {
+      pack.prim_time.resize(num_top_level_prims);
+    }
+  }
+
+  progress.set_substatus("Refitting BVH nodes");
+  refit_nodes();
 
   if (progress.get_cancel())
     return;
 
-  progress.set_substatus("Refitting BVH nodes");
-  refit_nodes();
+  if (params.top_level) {
+    /* Back to primitive indices local to the geometry, as after building. Merging the
+     * instances offsets them again. */
+    for (size_t i = 0; i < pack.prim_index.size(); i++) {
+      if (pack.prim_index[i] != -1) {
+        pack.prim_index[i] -= objects[pack.prim_object[i]]->get_geometry()->prim_offset;
+      }
+    }
+  }
+
+  progress.set_substatus("Packing BVH primitives");
+  pack_primitives();
+
+  if (params.top_level) {
+    progress.set_substatus("Packing BVH instances");
+    pack_instances(num_top_level_nodes, num_top_level_leaf_nodes);
+  }
+}
+
+float BVH2::refit_degradation() const
+{
+  return (build_sah_cost > 0.0f) ? sah_cost / build_sah_cost : 1.0f;
 }
 
 BVHNode *BVH2::widen_children_nodes(const BVHNode *root)
@@ -152,6 +233,17 @@ void BVH2::pack_aligned_inner(const BVHStackEntry &e,
                               const BVHStackEntry &e0,
                               const BVHStackEntry &e1)
 {
+  if (params.use_quantized_nodes) {
+    pack_quantized_node(e.idx,
+                        e0.node->bounds,
+                        e1.node->bounds,
+                        e0.encodeIdx(),
+                        e1.encodeIdx(),
+                        e0.node->visibility,
+                        e1.node->visibility);
+    return;
+  }
+
   pack_aligned_node(e.idx,
                     e0.node->bounds,
                     e1.node->bounds,
@@ -173,9 +265,9 @@ void BVH2::pack_aligned_node(int idx,
   assert(c0 < 0 || c0 < pack.nodes.size());
   assert(c1 < 0 || c1 < pack.nodes.size());
 
+  const uint node_flags = PATH_RAY_NODE_UNALIGNED | PATH_RAY_NODE_QUANTIZED;
   int4 data[BVH_NODE_SIZE] = {
-      make_int4(
-          visibility0 & ~PATH_RAY_NODE_UNALIGNED, visibility1 & ~PATH_RAY_NODE_UNALIGNED, c0, c1),
+      make_int4(visibility0 & ~node_flags, visibility1 & ~node_flags, c0, c1),
       make_int4(__float_as_int(b0.min.x),
                 __float_as_int(b1.min.x),
                 __float_as_int(b0.max.x),
@@ -193,6 +285,48 @@ void BVH2::pack_aligned_node(int idx,
   memcpy(&pack.nodes[idx], data, sizeof(int4) * BVH_NODE_SIZE);
 }
 
+void BVH2::pack_quantized_node(int idx,
+                               const BoundBox &b0,
+                               const BoundBox &b1,
+                               int c0,
+                               int c1,
+                               uint visibility0,
+                               uint visibility1)
+{
+  assert(idx + BVH_QUANTIZED_NODE_SIZE <= pack.nodes.size());
+  assert(c0 < 0 || c0 < pack.nodes.size());
+  assert(c1 < 0 || c1 < pack.nodes.size());
+
+  const uint node_flags = PATH_RAY_NODE_UNALIGNED | PATH_RAY_NODE_QUANTIZED;
+  const float3 origin = min(b0.min, b1.min);
+  const float3 upper = max(b0.max, b1.max);
+
+  int4 data[BVH_QUANTIZED_NODE_SIZE];
+  data[0] = make_int4((visibility0 & ~node_flags) | PATH_RAY_NODE_QUANTIZED,
+                      (visibility1 & ~node_flags) | PATH_RAY_NODE_QUANTIZED,
+                      c0,
+                      c1);
+  data[1] = make_int4(
+      __float_as_int(origin.x), __float_as_int(origin.y), __float_as_int(origin.z), 0);
+  data[2] = make_int4(0, 0, 0, 0);
+
+  for (int axis = 0; axis < 3; axis++) {
+    /* Exponent of the scale stored biased, so the kernel can build the float from its bits. */
+    const int exponent = bvh_quantize_exponent(origin[axis], upper[axis]);
+    const float scale = ldexpf(1.0f, exponent);
+    data[1].w |= (exponent + 127) << (axis * 8);
+
+    /* Same order of child bounds as aligned nodes. */
+    const uint q = bvh_quantize_lower(origin[axis], scale, b0.min[axis]) |
+                   (bvh_quantize_lower(origin[axis], scale, b1.min[axis]) << 8) |
+                   (bvh_quantize_upper(origin[axis], scale, b0.max[axis]) << 16) |
+                   (bvh_quantize_upper(origin[axis], scale, b1.max[axis]) << 24);
+    data[2][axis] = (int)q;
+  }
+
+  memcpy(&pack.nodes[idx], data, sizeof(int4) * BVH_QUANTIZED_NODE_SIZE);
+}
+
 void BVH2::pack_unaligned_inner(const BVHStackEntry &e,
                                 const BVHStackEntry &e0,
                                 const BVHStackEntry &e1)
@@ -225,10 +359,11 @@ void BVH2::pack_unaligned_node(int idx,
   float4 data[BVH_UNALIGNED_NODE_SIZE];
   Transform space0 = BVHUnaligned::compute_node_transform(bounds0, aligned_space0);
   Transform space1 = BVHUnaligned::compute_node_transform(bounds1, aligned_space1);
-  data[0] = make_float4(__int_as_float(visibility0 | PATH_RAY_NODE_UNALIGNED),
-                        __int_as_float(visibility1 | PATH_RAY_NODE_UNALIGNED),
-                        __int_as_float(c0),
-                        __int_as_float(c1));
+  data[0] = make_float4(
+      __int_as_float((visibility0 & ~PATH_RAY_NODE_QUANTIZED) | PATH_RAY_NODE_UNALIGNED),
+      __int_as_float((visibility1 & ~PATH_RAY_NODE_QUANTIZED) | PATH_RAY_NODE_UNALIGNED),
+      __int_as_float(c0),
+      __int_as_float(c1));
 
   data[1] = space0.x;
   data[2] = space0.y;
@@ -246,20 +381,25 @@ void BVH2::pack_nodes(const BVHNode *root)
   const size_t num_leaf_nodes = root->getSubtreeSize(BVH_STAT_LEAF_COUNT);
   assert(num_leaf_nodes <= num_nodes);
   const size_t num_inner_nodes = num_nodes - num_leaf_nodes;
+  const size_t aligned_node_size = (params.use_quantized_nodes) ? BVH_QUANTIZED_NODE_SIZE :
+                                                                  BVH_NODE_SIZE;
   size_t node_size;
   if (params.use_unaligned_nodes) {
     const size_t num_unaligned_nodes = root->getSubtreeSize(BVH_STAT_UNALIGNED_INNER_COUNT);
     node_size = (num_unaligned_nodes * BVH_UNALIGNED_NODE_SIZE) +
-                (num_inner_nodes - num_unaligned_nodes) * BVH_NODE_SIZE;
+                (num_inner_nodes - num_unaligned_nodes) * aligned_node_size;
   }
   else {
-    node_size = num_inner_nodes * BVH_NODE_SIZE;
+    node_size = num_inner_nodes * aligned_node_size;
   }
   /* Resize arrays */
   pack.nodes.clear();
   pack.leaf_nodes.clear();
   /* For top level BVH, first merge existing BVH's so we know the offsets. */
   if (params.top_level) {
+    num_top_level_nodes = node_size;
+    num_top_level_leaf_nodes = num_leaf_nodes * BVH_NODE_LEAF_SIZE;
+    num_top_level_prims = pack.prim_index.size();
     pack_instances(node_size, num_leaf_nodes * BVH_NODE_LEAF_SIZE);
   }
   else {
@@ -276,7 +416,7 @@ void BVH2::pack_nodes(const BVHNode *root)
   }
   else {
     stack.push_back(BVHStackEntry(root, nextNodeIdx));
-    nextNodeIdx += root->has_unaligned() ? BVH_UNALIGNED_NODE_SIZE : BVH_NODE_SIZE;
+    nextNodeIdx += inner_node_size(root);
   }
 
   while (stack.size()) {
@@ -297,8 +437,7 @@ void BVH2::pack_nodes(const BVHNode *root)
         }
         else {
           idx[i] = nextNodeIdx;
-          nextNodeIdx += e.node->get_child(i)->has_unaligned() ? BVH_UNALIGNED_NODE_SIZE :
-                                                                 BVH_NODE_SIZE;
+          nextNodeIdx += inner_node_size(e.node->get_child(i));
         }
       }
 
@@ -313,16 +452,27 @@ void BVH2::pack_nodes(const BVHNode *root)
   pack.root_index = (root->is_leaf()) ? -1 : 0;
 }
 
-void BVH2::refit_nodes()
+int BVH2::inner_node_size(const BVHNode *node) const
 {
-  assert(!params.top_level);
+  if (node->has_unaligned()) {
+    return BVH_UNALIGNED_NODE_SIZE;
+  }
+  return (params.use_quantized_nodes) ? BVH_QUANTIZED_NODE_SIZE : BVH_NODE_SIZE;
+}
 
+void BVH2::refit_nodes()
+{
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
-  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  float sah = 0.0f;
+  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility, sah);
+
+  /* Same cost as computed from the build nodes, relative to the area of the root. */
+  const float area = bbox.safe_area();
+  sah_cost = (area > 0.0f) ? sah / area : 0.0f;
 }
 
-void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility, float &sah)
 {
   if (leaf) {
     /* refit leaf node */
@@ -331,7 +481,15 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     const int c0 = data[0].x;
     const int c1 = data[0].y;
 
-    refit_primitives(c0, c1, bbox, visibility);
+    if (c0 < 0) {
+      /* Object instance in the top level BVH, see pack_leaf(). */
+      refit_primitives(~c0, ~c0 + 1, bbox, visibility);
+      sah += bbox.safe_area() * params.primitive_cost(1);
+    }
+    else {
+      refit_primitives(c0, c1, bbox, visibility);
+      sah += bbox.safe_area() * params.primitive_cost(c1 - c0);
+    }
 
     /* TODO(sergey): De-duplicate with pack_leaf(). */
     float4 leaf_data[BVH_NODE_LEAF_SIZE];
@@ -342,24 +500,28 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     memcpy(&pack.leaf_nodes[idx], leaf_data, sizeof(float4) * BVH_NODE_LEAF_SIZE);
   }
   else {
-    assert(idx + BVH_NODE_SIZE <= pack.nodes.size());
+    assert(idx + BVH_QUANTIZED_NODE_SIZE <= pack.nodes.size());
 
     const int4 *data = &pack.nodes[idx];
     const bool is_unaligned = (data[0].x & PATH_RAY_NODE_UNALIGNED) != 0;
+    const bool is_quantized = (data[0].x & PATH_RAY_NODE_QUANTIZED) != 0;
     const int c0 = data[0].z;
     const int c1 = data[0].w;
     /* refit inner node, set bbox from children */
     BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
     uint visibility0 = 0, visibility1 = 0;
 
-    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0);
-    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1);
+    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0, sah);
+    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1, sah);
 
     if (is_unaligned) {
       Transform aligned_space = transform_identity();
       pack_unaligned_node(
           idx, aligned_space, aligned_space, bbox0, bbox1, c0, c1, visibility0, visibility1);
     }
+    else if (is_quantized) {
+      pack_quantized_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
+    }
     else {
       pack_aligned_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
     }
@@ -367,6 +529,7 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     bbox.grow(bbox0);
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
+    sah += bbox.safe_area() * params.node_cost(2);
   }
 }
 
@@ -668,6 +831,10 @@ void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
           nsize = BVH_UNALIGNED_NODE_SIZE;
           nsize_bbox = 0;
         }
+        else if (bvh_nodes[i].x & PATH_RAY_NODE_QUANTIZED) {
+          nsize = BVH_QUANTIZED_NODE_SIZE;
+          nsize_bbox = 0;
+        }
         else {
           nsize = BVH_NODE_SIZE;
           nsize_bbox = 0;
@@ -29,6 +29,13 @@ CCL_NAMESPACE_BEGIN
 #define BVH_NODE_SIZE 4
 #define BVH_NODE_LEAF_SIZE 1
 #define BVH_UNALIGNED_NODE_SIZE 7
+#define BVH_QUANTIZED_NODE_SIZE 3
+
+/* Quantization of the child bounds of quantized nodes, relative to the lower bound of the node
+ * on an axis. The scale is 2 to the power of the exponent, and bounds are rounded outwards. */
+int bvh_quantize_exponent(float origin, float upper);
+int bvh_quantize_lower(float origin, float scale, float value);
+int bvh_quantize_upper(float origin, float scale, float value);
 
 /* Pack Utility */
 struct BVHStackEntry {
@@ -48,8 +55,16 @@ class BVH2 : public BVH {
   void build(Progress &progress, Stats *stats);
   void refit(Progress &progress);
 
+  /* Ratio of the SAH cost after the last refit to the cost after the last build. Refitting
+   * keeps the structure of the tree, so its quality degrades as the geometry deforms. */
+  float refit_degradation() const;
+
   PackedBVH pack;
 
+  /* Surface area heuristic cost of the tree after the last build and after the last refit. */
+  float build_sah_cost;
+  float sah_cost;
+
  protected:
   /* constructor */
   friend class BVH;
@@ -62,6 +77,7 @@ class BVH2 : public BVH {
 
   /* pack */
   void pack_nodes(const BVHNode *root);
+  int inner_node_size(const BVHNode *node) const;
 
   void pack_leaf(const BVHStackEntry &e, const LeafNode *leaf);
   void pack_inner(const BVHStackEntry &e, const BVHStackEntry &e0, const BVHStackEntry &e1);
@@ -77,6 +93,15 @@ class BVH2 : public BVH {
                          uint visibility0,
                          uint visibility1);
 
+  /* Aligned node with child bounds quantized to 8 bits relative to the bounds of the node. */
+  void pack_quantized_node(int idx,
+                           const BoundBox &b0,
+                           const BoundBox &b1,
+                           int c0,
+                           int c1,
+                           uint visibility0,
+                           uint visibility1);
+
   void pack_unaligned_inner(const BVHStackEntry &e,
                             const BVHStackEntry &e0,
                             const BVHStackEntry &e1);
@@ -92,7 +117,7 @@ class BVH2 : public BVH {
 
   /* refit */
   void refit_nodes();
-  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
+  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility, float &sah);
 
   /* Refit range of primitives. */
   void refit_primitives(int start, int end, BoundBox &bbox, uint &visibility);
@@ -103,6 +128,12 @@ class BVH2 : public BVH {
 
   /* merge instance BVH's */
   void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
+
+  /* Size of the top level part of the packed arrays, which are followed by the merged
+   * instance BVHs. */
+  size_t num_top_level_nodes;
+  size_t num_top_level_leaf_nodes;
+  size_t num_top_level_prims;
 };
 
 CCL_NAMESPACE_END
@@ -225,14 +225,24 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
 
 static void rtc_filter_func_thick_curve(const RTCFilterFunctionNArguments *args)
 {
-  const RTCRay *ray = (RTCRay *)args->ray;
-  RTCHit *hit = (RTCHit *)args->hit;
+  /* Stream queries from the split kernel may call this with multiple rays at once. */
+  const unsigned int N = args->N;
+  RTCRayN *ray = args->ray;
+  RTCHitN *hit = args->hit;
+
+  for (unsigned int i = 0; i < N; i++) {
+    if (args->valid[i] == 0) {
+      continue;
+    }
 
-  /* Always ignore backfacing intersections. */
-  if (dot(make_float3(ray->dir_x, ray->dir_y, ray->dir_z),
-          make_float3(hit->Ng_x, hit->Ng_y, hit->Ng_z)) > 0.0f) {
-    *args->valid = 0;
-    return;
+    /* Always ignore backfacing intersections. */
+    const float3 dir = make_float3(
+        RTCRayN_dir_x(ray, N, i), RTCRayN_dir_y(ray, N, i), RTCRayN_dir_z(ray, N, i));
+    const float3 Ng = make_float3(
+        RTCHitN_Ng_x(hit, N, i), RTCHitN_Ng_y(hit, N, i), RTCHitN_Ng_z(hit, N, i));
+    if (dot(dir, Ng) > 0.0f) {
+      args->valid[i] = 0;
+    }
   }
 }
 
@@ -74,6 +74,10 @@ class BVHParams {
    */
   bool use_unaligned_nodes;
 
+  /* Store the child bounds of aligned nodes quantized to 8 bits, for smaller nodes at the
+   * cost of slightly looser bounds. Only used for BVH2 layout. */
+  bool use_quantized_nodes;
+
   /* Split time range to this number of steps and create leaf node for each
    * of this time steps.
    *
@@ -115,6 +119,7 @@ class BVHParams {
     top_level = false;
     bvh_layout = BVH_LAYOUT_BVH2;
     use_unaligned_nodes = false;
+    use_quantized_nodes = false;
 
     num_motion_curve_steps = 0;
     num_motion_triangle_steps = 0;
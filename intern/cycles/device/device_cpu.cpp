@@ -1626,7 +1626,9 @@ int2 CPUSplitKernel::split_kernel_global_size(device_memory & /*kg*/,
                                               device_memory & /*data*/,
                                               DeviceTask & /*task*/)
 {
-  return make_int2(1, 1);
+  /* Number of paths in flight per thread. Enough for the queues to batch rays for stream
+   * intersection and group rays by shader, while keeping the state of all threads small. */
+  return make_int2(32, 32);
 }
 
 uint64_t CPUSplitKernel::state_buffer_size(device_memory &kernel_globals,
@@ -187,6 +187,11 @@ device_texture::device_texture(Device *device,
       data_type = TYPE_UINT16;
       data_elements = 1;
       break;
+    case IMAGE_DATA_TYPE_CACHE:
+      /* Pointer to the ImageCacheTexture. */
+      data_type = TYPE_UINT64;
+      data_elements = 1;
+      break;
     case IMAGE_DATA_NUM_TYPES:
       assert(0);
       return;
@@ -212,6 +217,7 @@ void *device_texture::alloc(const size_t width, const size_t height, const size_
   if (new_size != data_size) {
     device_free();
     host_free();
+    GuardedMemTag mem_tag(GuardedMemTag::IMAGE);
     host_pointer = host_alloc(data_elements * datatype_size(data_type) * new_size);
     assert(device_pointer == 0);
   }
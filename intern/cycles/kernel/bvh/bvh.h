@@ -236,6 +236,56 @@ ccl_device_intersect bool scene_intersect(KernelGlobals *kg,
 #endif   /* __KERNEL_OPTIX__ */
 }
 
+#if defined(__EMBREE__) && defined(__KERNEL_CPU__)
+/* Maximum number of rays intersected by a single stream query. */
+#  define SCENE_INTERSECT_STREAM_SIZE 64
+
+/* Intersect a batch of rays with a single Embree stream query, so that rays with similar paths
+ * through the BVH are traversed together. Only for scenes using Embree. */
+ccl_device_intersect void scene_intersect_stream(KernelGlobals *kg,
+                                                 const Ray *rays,
+                                                 const uint *visibility,
+                                                 Intersection *isects,
+                                                 bool *hits,
+                                                 int num_rays)
+{
+  PROFILING_INIT(kg, PROFILING_INTERSECT);
+
+  kernel_assert(num_rays <= SCENE_INTERSECT_STREAM_SIZE);
+
+  RTCRayHit ray_hits[SCENE_INTERSECT_STREAM_SIZE];
+  int ray_index[SCENE_INTERSECT_STREAM_SIZE];
+  int num_valid_rays = 0;
+
+  for (int i = 0; i < num_rays; i++) {
+    hits[i] = false;
+    if (scene_intersect_valid(&rays[i])) {
+      isects[i].t = rays[i].t;
+      kernel_embree_setup_rayhit(rays[i], ray_hits[num_valid_rays], visibility[i]);
+      ray_index[num_valid_rays++] = i;
+    }
+  }
+
+  if (num_valid_rays == 0) {
+    return;
+  }
+
+  CCLIntersectContext ctx(kg, CCLIntersectContext::RAY_REGULAR);
+  IntersectContext rtc_ctx(&ctx);
+  rtcIntersect1M(
+      kernel_data.bvh.scene, &rtc_ctx.context, ray_hits, num_valid_rays, sizeof(RTCRayHit));
+
+  for (int i = 0; i < num_valid_rays; i++) {
+    const RTCRayHit &ray_hit = ray_hits[i];
+    if (ray_hit.hit.geomID != RTC_INVALID_GEOMETRY_ID &&
+        ray_hit.hit.primID != RTC_INVALID_GEOMETRY_ID) {
+      kernel_embree_convert_hit(kg, &ray_hit.ray, &ray_hit.hit, &isects[ray_index[i]]);
+      hits[ray_index[i]] = true;
+    }
+  }
+}
+#endif /* __EMBREE__ && __KERNEL_CPU__ */
+
 #ifdef __BVH_LOCAL__
 ccl_device_intersect bool scene_intersect_local(KernelGlobals *kg,
                                                 const Ray *ray,
@@ -28,6 +28,17 @@ ccl_device_forceinline Transform bvh_unaligned_node_fetch_space(KernelGlobals *k
   return space;
 }
 
+/* Reconstruct the child bounds of a quantized node on one axis, in the same layout as aligned
+ * nodes. See BVH2::pack_quantized_node(). */
+ccl_device_forceinline float4 bvh_quantized_node_dequantize(float origin, uint exponent, uint q)
+{
+  const float scale = __uint_as_float(exponent << 23);
+  return make_float4(origin + (float)(q & 0xff) * scale,
+                     origin + (float)((q >> 8) & 0xff) * scale,
+                     origin + (float)((q >> 16) & 0xff) * scale,
+                     origin + (float)(q >> 24) * scale);
+}
+
 ccl_device_forceinline int bvh_aligned_node_intersect(KernelGlobals *kg,
                                                       const float3 P,
                                                       const float3 idir,
@@ -38,12 +49,24 @@ ccl_device_forceinline int bvh_aligned_node_intersect(KernelGlobals *kg,
 {
 
   /* fetch node data */
-#ifdef __VISIBILITY_FLAG__
   float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
-#endif
-  float4 node0 = kernel_tex_fetch(__bvh_nodes, node_addr + 1);
-  float4 node1 = kernel_tex_fetch(__bvh_nodes, node_addr + 2);
-  float4 node2 = kernel_tex_fetch(__bvh_nodes, node_addr + 3);
+  float4 node0, node1, node2;
+  if (__float_as_uint(cnodes.x) & PATH_RAY_NODE_QUANTIZED) {
+    const float4 origin = kernel_tex_fetch(__bvh_nodes, node_addr + 1);
+    const float4 quantized = kernel_tex_fetch(__bvh_nodes, node_addr + 2);
+    const uint exponents = __float_as_uint(origin.w);
+    node0 = bvh_quantized_node_dequantize(
+        origin.x, exponents & 0xff, __float_as_uint(quantized.x));
+    node1 = bvh_quantized_node_dequantize(
+        origin.y, (exponents >> 8) & 0xff, __float_as_uint(quantized.y));
+    node2 = bvh_quantized_node_dequantize(
+        origin.z, (exponents >> 16) & 0xff, __float_as_uint(quantized.z));
+  }
+  else {
+    node0 = kernel_tex_fetch(__bvh_nodes, node_addr + 1);
+    node1 = kernel_tex_fetch(__bvh_nodes, node_addr + 2);
+    node2 = kernel_tex_fetch(__bvh_nodes, node_addr + 3);
+  }
 
   /* intersect ray against child nodes */
   float c0lox = (node0.x - P.x) * idir.x;
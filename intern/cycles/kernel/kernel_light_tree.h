@@ -0,0 +1,224 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Selects a light proportional to an estimate of its contribution to the shading point,
+ * by traversing a hierarchy of light bounds. Uses the importance measure of:
+ *
+ * Alejandro Conty Estevez and Christopher Kulla.
+ * Importance Sampling of Many Lights with Adaptive Tree Splitting.
+ *
+ * A single light is selected per sample, the tree is not split adaptively.
+ * Distant and background lights are outside of the tree, they are selected uniformly
+ * with a fixed probability and stored at the start of the emitter array. */
+
+ccl_device float light_tree_importance(const float3 P,
+                                       const ccl_global KernelLightTreeBounds *bounds)
+{
+  if (bounds->energy == 0.0f) {
+    return 0.0f;
+  }
+
+  const float3 bbox_min = make_float3(
+      bounds->bbox_min[0], bounds->bbox_min[1], bounds->bbox_min[2]);
+  const float3 bbox_max = make_float3(
+      bounds->bbox_max[0], bounds->bbox_max[1], bounds->bbox_max[2]);
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius_squared = 0.25f * len_squared(bbox_max - bbox_min);
+
+  const float3 to_P = P - centroid;
+  const float distance_squared = len_squared(to_P);
+
+  /* Bound the angle between the emission directions and the direction to the shading point,
+   * when outside of the bounding sphere. */
+  float cos_theta_prime = 1.0f;
+  if (distance_squared > radius_squared) {
+    const float distance = sqrtf(distance_squared);
+    const float3 axis = make_float3(bounds->axis[0], bounds->axis[1], bounds->axis[2]);
+    const float theta = safe_acosf(dot(axis, to_P) / distance);
+    const float theta_u = safe_asinf(sqrtf(radius_squared) / distance);
+    const float theta_prime = max(theta - bounds->theta_o - theta_u, 0.0f);
+    if (theta_prime >= bounds->theta_e) {
+      return 0.0f;
+    }
+    cos_theta_prime = cosf(theta_prime);
+  }
+
+  /* Avoid the singularity when the shading point is inside the bounds. */
+  return bounds->energy * cos_theta_prime / max(distance_squared, max(radius_squared, 1e-8f));
+}
+
+/* Select an emitter for the shading point, returns its index in the emitter array or -1 when no
+ * emitter contributes. The random number is rescaled to be reused for sampling the light. */
+ccl_device int light_tree_sample(KernelGlobals *kg, const float3 P, float *randu, float *pdf)
+{
+  float r = *randu;
+  float select_pdf = 1.0f;
+
+  const int num_distant = kernel_data.integrator.num_distant_lights;
+  if (num_distant > 0) {
+    const float pdf_distant = num_distant * kernel_data.integrator.pdf_lights;
+    if (r < pdf_distant) {
+      r = r / pdf_distant * num_distant;
+      const int index = min((int)r, num_distant - 1);
+      *randu = clamp(r - index, 0.0f, 1.0f);
+      *pdf = kernel_data.integrator.pdf_lights;
+      return index;
+    }
+    r = clamp((r - pdf_distant) / (1.0f - pdf_distant), 0.0f, 1.0f);
+    select_pdf = 1.0f - pdf_distant;
+  }
+
+  int node_index = 0;
+  const ccl_global KernelLightTreeNode *node = &kernel_tex_fetch(__light_tree_nodes, 0);
+
+  while (node->num_emitters == 0) {
+    const int left_index = node_index + 1;
+    const int right_index = node->child_index;
+    const ccl_global KernelLightTreeNode *left = &kernel_tex_fetch(__light_tree_nodes,
+                                                                   left_index);
+    const ccl_global KernelLightTreeNode *right = &kernel_tex_fetch(__light_tree_nodes,
+                                                                    right_index);
+
+    const float importance_left = light_tree_importance(P, &left->bounds);
+    const float importance_right = light_tree_importance(P, &right->bounds);
+    const float importance_total = importance_left + importance_right;
+    if (importance_total == 0.0f) {
+      return -1;
+    }
+
+    const float probability_left = importance_left / importance_total;
+    if (r < probability_left) {
+      r = clamp(r / probability_left, 0.0f, 1.0f);
+      select_pdf *= probability_left;
+      node_index = left_index;
+      node = left;
+    }
+    else {
+      r = clamp((r - probability_left) / (1.0f - probability_left), 0.0f, 1.0f);
+      select_pdf *= 1.0f - probability_left;
+      node_index = right_index;
+      node = right;
+    }
+  }
+
+  /* Select an emitter in the leaf, proportional to the importance of each of them. */
+  float importance_total = 0.0f;
+  for (int i = 0; i < node->num_emitters; i++) {
+    const ccl_global KernelLightTreeEmitter *emitter = &kernel_tex_fetch(
+        __light_tree_emitters, node->first_emitter + i);
+    importance_total += light_tree_importance(P, &emitter->bounds);
+  }
+  if (importance_total == 0.0f) {
+    return -1;
+  }
+
+  r *= importance_total;
+  int selected = -1;
+  float selected_importance = 0.0f;
+  for (int i = 0; i < node->num_emitters; i++) {
+    const ccl_global KernelLightTreeEmitter *emitter = &kernel_tex_fetch(
+        __light_tree_emitters, node->first_emitter + i);
+    const float importance = light_tree_importance(P, &emitter->bounds);
+    if (importance == 0.0f) {
+      continue;
+    }
+
+    /* Fall back to the last contributing emitter for float rounding errors. */
+    selected = node->first_emitter + i;
+    selected_importance = importance;
+    if (r < importance) {
+      break;
+    }
+    r -= importance;
+  }
+
+  *randu = clamp(r / selected_importance, 0.0f, 1.0f);
+  *pdf = select_pdf * selected_importance / importance_total;
+  return selected;
+}
+
+/* Probability of light_tree_sample selecting the emitter for the shading point. */
+ccl_device float light_tree_pdf(KernelGlobals *kg, const float3 P, int emitter_index)
+{
+  const ccl_global KernelLightTreeEmitter *emitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                       emitter_index);
+  if (emitter->leaf < 0) {
+    return kernel_data.integrator.pdf_lights;
+  }
+
+  const float importance = light_tree_importance(P, &emitter->bounds);
+  if (importance == 0.0f) {
+    return 0.0f;
+  }
+
+  int node_index = emitter->leaf;
+  const ccl_global KernelLightTreeNode *node = &kernel_tex_fetch(__light_tree_nodes, node_index);
+
+  float importance_total = 0.0f;
+  for (int i = 0; i < node->num_emitters; i++) {
+    importance_total += light_tree_importance(
+        P, &kernel_tex_fetch(__light_tree_emitters, node->first_emitter + i).bounds);
+  }
+  float pdf = importance / importance_total;
+
+  /* Walk up to the root, multiplying the probabilities of selecting each node. */
+  while (node_index != 0) {
+    const int parent_index = node->parent;
+    const ccl_global KernelLightTreeNode *parent = &kernel_tex_fetch(__light_tree_nodes,
+                                                                     parent_index);
+    const int sibling_index = (node_index == parent_index + 1) ? parent->child_index :
+                                                                 parent_index + 1;
+
+    const float importance_node = light_tree_importance(P, &node->bounds);
+    const float importance_sibling = light_tree_importance(
+        P, &kernel_tex_fetch(__light_tree_nodes, sibling_index).bounds);
+    pdf *= importance_node / (importance_node + importance_sibling);
+
+    node_index = parent_index;
+    node = parent;
+  }
+
+  const float pdf_distant = kernel_data.integrator.num_distant_lights *
+                            kernel_data.integrator.pdf_lights;
+  return pdf * (1.0f - pdf_distant);
+}
+
+/* Probability per area of selecting the mesh light triangle for the shading point,
+ * the equivalent of pdf_triangles for the light distribution. */
+ccl_device float light_tree_triangle_pdf_area(KernelGlobals *kg,
+                                              const float3 P,
+                                              int object,
+                                              int prim)
+{
+  const uint2 offset = kernel_tex_fetch(__light_tree_objects, object);
+  if (offset.x == LIGHT_TREE_NONE) {
+    return 0.0f;
+  }
+
+  const uint emitter_index = kernel_tex_fetch(__light_tree_triangles, offset.x + prim - offset.y);
+  if (emitter_index == LIGHT_TREE_NONE) {
+    return 0.0f;
+  }
+
+  const float area = kernel_tex_fetch(__light_tree_emitters, emitter_index).area;
+  return (area > 0.0f) ? light_tree_pdf(kg, P, emitter_index) / area : 0.0f;
+}
+
+CCL_NAMESPACE_END
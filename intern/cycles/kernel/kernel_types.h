@@ -59,6 +59,7 @@ CCL_NAMESPACE_BEGIN
 #define OBJECT_NONE (~0)
 #define PRIM_NONE (~0)
 #define LAMP_NONE (~0)
+#define LIGHT_TREE_NONE (~0)
 #define ID_NONE (0.0f)
 
 #define VOLUME_STACK_SIZE 32
@@ -287,8 +288,8 @@ enum PathRayFlag {
                                  PATH_RAY_SHADOW_TRANSPARENT_NON_CATCHER),
   PATH_RAY_SHADOW = (PATH_RAY_SHADOW_OPAQUE | PATH_RAY_SHADOW_TRANSPARENT),
 
-  /* Unused, free to reuse. */
-  PATH_RAY_UNUSED = (1 << 11),
+  /* Special flag to tag quantized BVH nodes. */
+  PATH_RAY_NODE_QUANTIZED = (1 << 11),
 
   /* Ray visibility for volume scattering. */
   PATH_RAY_VOLUME_SCATTER = (1 << 12),
@@ -1387,7 +1388,9 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
-  int pad1, pad2;
+  /* light tree */
+  int use_light_tree;
+  int num_distant_lights;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1521,7 +1524,7 @@ typedef struct KernelLight {
   float max_bounces;
   float random;
   float strength[3];
-  float pad1;
+  int tree_emitter;
   Transform tfm;
   Transform itfm;
   union {
@@ -1548,6 +1551,41 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Bounds of emitters in the light tree: spatial bounding box, total energy and orientation
+ * cone. All emitter normals are within theta_o of the axis, and light is emitted up to
+ * theta_e away from the normals. */
+typedef struct KernelLightTreeBounds {
+  float bbox_min[3];
+  float energy;
+  float bbox_max[3];
+  float theta_o;
+  float axis[3];
+  float theta_e;
+} KernelLightTreeBounds;
+
+typedef struct KernelLightTreeNode {
+  KernelLightTreeBounds bounds;
+  /* Index of the second child for inner nodes, the first child directly follows the node. */
+  int child_index;
+  /* Range of emitters for leaf nodes, num_emitters is zero for inner nodes. */
+  int first_emitter;
+  int num_emitters;
+  int parent;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+typedef struct KernelLightTreeEmitter {
+  KernelLightTreeBounds bounds;
+  /* Index in the light distribution, holding the triangle or lamp. */
+  int distribution_index;
+  /* Leaf node containing the emitter, -1 for distant lights outside of the tree. */
+  int leaf;
+  /* Area of mesh light triangles, their sampling pdf is defined per area. */
+  float area;
+  float pad;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
@@ -584,6 +584,14 @@ template<typename T> struct NanoVDBInterpolator {
 
 #undef SET_CUBIC_SPLINE_WEIGHTS
 
+/* Image paged in on demand by the texture cache, the texture data is a pointer to it. */
+ccl_device float4
+kernel_tex_image_interp_cache(const TextureInfo &info, float x, float y, float2 dx, float2 dy)
+{
+  const ImageCacheTexture *texture = *(const ImageCacheTexture *const *)info.data;
+  return texture->lookup(x, y, dx, dy);
+}
+
 ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
@@ -605,6 +613,9 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
       return TextureInterpolator<ushort4>::interp(info, x, y);
     case IMAGE_DATA_TYPE_FLOAT4:
       return TextureInterpolator<float4>::interp(info, x, y);
+    case IMAGE_DATA_TYPE_CACHE:
+      return kernel_tex_image_interp_cache(
+          info, x, y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f));
     default:
       assert(0);
       return make_float4(
@@ -612,6 +623,20 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Lookup with the derivatives of the texture coordinates, only cached images are filtered
+ * by them. */
+ccl_device float4 kernel_tex_image_interp_deriv(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+
+  if (info.data_type == IMAGE_DATA_TYPE_CACHE) {
+    return kernel_tex_image_interp_cache(info, x, y, dx, dy);
+  }
+
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
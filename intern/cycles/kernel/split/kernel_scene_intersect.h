@@ -16,21 +16,14 @@
 
 CCL_NAMESPACE_BEGIN
 
-/* This kernel takes care of scene_intersect function.
- *
- * This kernel changes the ray_state of RAY_REGENERATED rays to RAY_ACTIVE.
- * This kernel processes rays of ray state RAY_ACTIVE
- * This kernel determines the rays that have hit the background and changes
- * their ray state to RAY_HIT_BACKGROUND.
- */
-ccl_device void kernel_scene_intersect(KernelGlobals *kg)
+/* Get the ray to intersect for the work item, and make regenerated rays active.
+ * Returns QUEUE_EMPTY_SLOT if there is no active ray. */
+ccl_device_inline int kernel_scene_intersect_ray_index(KernelGlobals *kg,
+                                                       int thread_index,
+                                                       char use_queues_flag)
 {
-  /* Fetch use_queues_flag */
-  char local_use_queues_flag = *kernel_split_params.use_queues_flag;
-  ccl_barrier(CCL_LOCAL_MEM_FENCE);
-
-  int ray_index = ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0);
-  if (local_use_queues_flag) {
+  int ray_index = thread_index;
+  if (use_queues_flag) {
     ray_index = get_ray_index(kg,
                               ray_index,
                               QUEUE_ACTIVE_AND_REGENERATED_RAYS,
@@ -39,7 +32,7 @@ ccl_device void kernel_scene_intersect(KernelGlobals *kg)
                               0);
 
     if (ray_index == QUEUE_EMPTY_SLOT) {
-      return;
+      return QUEUE_EMPTY_SLOT;
     }
   }
 
@@ -57,6 +50,105 @@ ccl_device void kernel_scene_intersect(KernelGlobals *kg)
   }
 
   if (!IS_STATE(kernel_split_state.ray_state, ray_index, RAY_ACTIVE)) {
+    return QUEUE_EMPTY_SLOT;
+  }
+
+  return ray_index;
+}
+
+#if defined(__EMBREE__) && defined(__KERNEL_CPU__)
+/* Intersect the rays of all work items at once with Embree stream queries, instead of one ray
+ * per work item. */
+ccl_device_noinline void kernel_scene_intersect_stream(KernelGlobals *kg, char use_queues_flag)
+{
+  PROFILING_INIT(kg, PROFILING_SCENE_INTERSECT);
+
+  const int num_threads = ccl_global_size(0) * ccl_global_size(1);
+  int thread_index = 0;
+
+  while (thread_index < num_threads) {
+    int ray_index[SCENE_INTERSECT_STREAM_SIZE];
+    Ray rays[SCENE_INTERSECT_STREAM_SIZE];
+    uint visibility[SCENE_INTERSECT_STREAM_SIZE];
+    Intersection isects[SCENE_INTERSECT_STREAM_SIZE];
+    bool hits[SCENE_INTERSECT_STREAM_SIZE];
+    int num_rays = 0;
+
+    /* Gather active rays, with the same visibility and AO distance as for a single ray. */
+    for (; thread_index < num_threads && num_rays < SCENE_INTERSECT_STREAM_SIZE; thread_index++) {
+      const int index = kernel_scene_intersect_ray_index(kg, thread_index, use_queues_flag);
+      if (index == QUEUE_EMPTY_SLOT) {
+        continue;
+      }
+
+      ccl_global PathState *state = &kernel_split_state.path_state[index];
+      rays[num_rays] = kernel_split_state.ray[index];
+      visibility[num_rays] = path_state_ray_visibility(kg, state);
+
+      if (path_state_ao_bounce(kg, state)) {
+        visibility[num_rays] = PATH_RAY_SHADOW;
+        rays[num_rays].t = kernel_data.background.ao_distance;
+      }
+
+      ray_index[num_rays++] = index;
+    }
+
+    if (num_rays == 0) {
+      continue;
+    }
+
+    scene_intersect_stream(kg, rays, visibility, isects, hits, num_rays);
+
+    for (int i = 0; i < num_rays; i++) {
+      const int index = ray_index[i];
+      kernel_split_state.isect[index] = isects[i];
+
+#  ifdef __KERNEL_DEBUG__
+      ccl_global PathState *state = &kernel_split_state.path_state[index];
+      PathRadiance *L = &kernel_split_state.path_radiance[index];
+      if (state->flag & PATH_RAY_CAMERA) {
+        L->debug_data.num_bvh_traversed_nodes += isects[i].num_traversed_nodes;
+        L->debug_data.num_bvh_traversed_instances += isects[i].num_traversed_instances;
+        L->debug_data.num_bvh_intersections += isects[i].num_intersections;
+      }
+      L->debug_data.num_ray_bounces++;
+#  endif /* __KERNEL_DEBUG__ */
+
+      if (!hits[i]) {
+        ASSIGN_RAY_STATE(kernel_split_state.ray_state, index, RAY_HIT_BACKGROUND);
+      }
+    }
+  }
+}
+#endif /* __EMBREE__ && __KERNEL_CPU__ */
+
+/* This kernel takes care of scene_intersect function.
+ *
+ * This kernel changes the ray_state of RAY_REGENERATED rays to RAY_ACTIVE.
+ * This kernel processes rays of ray state RAY_ACTIVE
+ * This kernel determines the rays that have hit the background and changes
+ * their ray state to RAY_HIT_BACKGROUND.
+ */
+ccl_device void kernel_scene_intersect(KernelGlobals *kg)
+{
+  /* Fetch use_queues_flag */
+  char local_use_queues_flag = *kernel_split_params.use_queues_flag;
+  ccl_barrier(CCL_LOCAL_MEM_FENCE);
+
+  int thread_index = ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0);
+
+#if defined(__EMBREE__) && defined(__KERNEL_CPU__)
+  /* The first work item intersects the rays of all work items. */
+  if (kernel_data.bvh.scene) {
+    if (thread_index == 0) {
+      kernel_scene_intersect_stream(kg, local_use_queues_flag);
+    }
+    return;
+  }
+#endif /* __EMBREE__ && __KERNEL_CPU__ */
+
+  int ray_index = kernel_scene_intersect_ray_index(kg, thread_index, local_use_queues_flag);
+  if (ray_index == QUEUE_EMPTY_SLOT) {
     return;
   }
 
@@ -54,7 +54,6 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
   }
   ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
-  /* skip sorting for cpu split kernel */
 #  ifdef __KERNEL_OPENCL__
 
   /* bitonic sort */
@@ -77,6 +76,39 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
       }
     }
   }
+#  else
+  /* Stable merge sort by a single work item on the CPU, only of the occupied part of the block.
+   * This way rays with the same shader are evaluated one after the other. */
+  const int num_values = min(SHADER_SORT_BLOCK_SIZE, (int)(qsize - offset));
+  ccl_local ushort *src = local_index;
+  ccl_local ushort *dst = &locals->local_index_temp[0];
+
+  for (int length = 1; length < num_values; length <<= 1) {
+    for (int start = 0; start < num_values; start += 2 * length) {
+      const int mid = min(start + length, num_values);
+      const int end = min(start + 2 * length, num_values);
+      int i = start, j = mid, k = start;
+      while (i < mid && j < end) {
+        dst[k++] = (local_value[src[j]] < local_value[src[i]]) ? src[j++] : src[i++];
+      }
+      while (i < mid) {
+        dst[k++] = src[i++];
+      }
+      while (j < end) {
+        dst[k++] = src[j++];
+      }
+    }
+
+    ccl_local ushort *temp = src;
+    src = dst;
+    dst = temp;
+  }
+
+  if (src != local_index) {
+    for (int i = 0; i < num_values; i++) {
+      local_index[i] = src[i];
+    }
+  }
 #  endif /* __KERNEL_OPENCL__ */
 
   /* copy to destination */
@@ -173,6 +173,10 @@ typedef struct BackgroundAOLocals {
 typedef struct ShaderSortLocals {
   uint local_value[SHADER_SORT_BLOCK_SIZE];
   ushort local_index[SHADER_SORT_BLOCK_SIZE];
+#ifdef __KERNEL_CPU__
+  /* Merge sort buffer. */
+  ushort local_index_temp[SHADER_SORT_BLOCK_SIZE];
+#endif
 } ShaderSortLocals;
 
 CCL_NAMESPACE_END
@@ -147,6 +147,7 @@ void RenderBuffers::reset(BufferParams &params_)
   params = params_;
 
   /* re-allocate buffer */
+  GuardedMemTag mem_tag(GuardedMemTag::RENDER);
   buffer.alloc(params.width * params.get_passes_size(), params.height);
   buffer.zero_to_device();
 }
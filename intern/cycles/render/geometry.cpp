@@ -37,6 +37,7 @@
 
 #include "kernel/osl/osl_globals.h"
 
+#include "util/util_atomic.h"
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
@@ -194,6 +195,8 @@ void Geometry::compute_bvh(
   if (progress->get_cancel())
     return;
 
+  GuardedMemTag mem_tag(GuardedMemTag::BVH);
+
   compute_bounds();
 
   const BVHLayout bvh_layout = BVHParams::best_bvh_layout(params->bvh_layout,
@@ -213,7 +216,13 @@ void Geometry::compute_bvh(
     vector<Object *> objects;
     objects.push_back(&object);
 
-    if (bvh && !need_update_rebuild) {
+    /* Rebuild refitted BVHs once their quality degraded too much. */
+    const bool refit_degraded = params->use_bvh_refit && bvh &&
+                                bvh_layout == BVH_LAYOUT_BVH2 &&
+                                static_cast<BVH2 *>(bvh)->refit_degradation() >
+                                    params->bvh_refit_max_degradation;
+
+    if (bvh && !need_update_rebuild && !refit_degraded) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->geometry = geometry;
@@ -229,6 +238,7 @@ void Geometry::compute_bvh(
       bparams.bvh_layout = bvh_layout;
       bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
                                     params->use_bvh_unaligned_nodes;
+      bparams.use_quantized_nodes = params->use_bvh_quantized_nodes;
       bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
@@ -1207,6 +1217,21 @@ void GeometryManager::device_update_mesh(
   }
 }
 
+/* Move the packed BVH arrays back from the device vectors, to refit the BVH in place. */
+static void device_take_packed_bvh(DeviceScene *dscene, PackedBVH &pack)
+{
+  dscene->bvh_nodes.give_data(pack.nodes);
+  dscene->bvh_leaf_nodes.give_data(pack.leaf_nodes);
+  dscene->object_node.give_data(pack.object_node);
+  dscene->prim_tri_index.give_data(pack.prim_tri_index);
+  dscene->prim_tri_verts.give_data(pack.prim_tri_verts);
+  dscene->prim_type.give_data(pack.prim_type);
+  dscene->prim_visibility.give_data(pack.prim_visibility);
+  dscene->prim_index.give_data(pack.prim_index);
+  dscene->prim_object.give_data(pack.prim_object);
+  dscene->prim_time.give_data(pack.prim_time);
+}
+
 void GeometryManager::device_update_bvh(Device *device,
                                         DeviceScene *dscene,
                                         Scene *scene,
@@ -1215,6 +1240,8 @@ void GeometryManager::device_update_bvh(Device *device,
   /* bvh build */
   progress.set_status("Updating Scene BVH", "Building");
 
+  GuardedMemTag mem_tag(GuardedMemTag::BVH);
+
   BVHParams bparams;
   bparams.top_level = true;
   bparams.bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
@@ -1222,6 +1249,7 @@ void GeometryManager::device_update_bvh(Device *device,
   bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
   bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
                                 scene->params.use_bvh_unaligned_nodes;
+  bparams.use_quantized_nodes = scene->params.use_bvh_quantized_nodes;
   bparams.num_motion_triangle_steps = scene->params.num_bvh_time_steps;
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
@@ -1229,14 +1257,34 @@ void GeometryManager::device_update_bvh(Device *device,
 
   VLOG(1) << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
 
-  const bool can_refit = scene->bvh != nullptr &&
-                         (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX);
+  const bool has_bvh2_layout = (bparams.bvh_layout == BVH_LAYOUT_BVH2);
+  bool can_refit = scene->bvh != nullptr && (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX);
   const bool pack_all = scene->bvh == nullptr;
 
   BVH *bvh = scene->bvh;
   if (!scene->bvh) {
     bvh = scene->bvh = BVH::create(bparams, scene->geometry, scene->objects, device);
   }
+  else if (has_bvh2_layout && scene->params.use_bvh_refit) {
+    /* Changed topology already freed the BVH, refit it as long as the objects are the same and
+     * the quality of the tree did not degrade too much. */
+    BVH2 *bvh2 = static_cast<BVH2 *>(bvh);
+    const float degradation = bvh2->refit_degradation();
+
+    if (bvh->objects != scene->objects || bvh->geometry != scene->geometry) {
+      bvh->objects = scene->objects;
+      bvh->geometry = scene->geometry;
+    }
+    else if (degradation > scene->params.bvh_refit_max_degradation) {
+      VLOG(1) << "Rebuilding scene BVH, SAH cost grew by " << degradation
+              << " since the last build.";
+    }
+    else {
+      progress.set_status("Updating Scene BVH", "Refitting");
+      device_take_packed_bvh(dscene, bvh2->pack);
+      can_refit = true;
+    }
+  }
 
   device->build_bvh(bvh, progress, can_refit);
 
@@ -1244,7 +1292,10 @@ void GeometryManager::device_update_bvh(Device *device,
     return;
   }
 
-  const bool has_bvh2_layout = (bparams.bvh_layout == BVH_LAYOUT_BVH2);
+  if (has_bvh2_layout && can_refit) {
+    VLOG(1) << "Refitted scene BVH, SAH cost grew by "
+            << static_cast<BVH2 *>(bvh)->refit_degradation() << " since the last build.";
+  }
 
   PackedBVH pack;
   if (has_bvh2_layout) {
@@ -1785,6 +1836,9 @@ void GeometryManager::device_update(Device *device,
 
         progress.set_status("Updating Mesh", msg);
 
+        /* Only the viewport and persistent data tessellate the same mesh again. */
+        mesh->set_use_subd_dice_cache(!scene->params.background ||
+                                      scene->params.persistent_data);
         mesh->subd_params->camera = dicing_camera;
         DiagSplit dsplit(*mesh->subd_params);
         mesh->tessellate(&dsplit);
@@ -2070,7 +2124,8 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene, bool forc
 
 void GeometryManager::tag_update(Scene *scene, uint32_t flag)
 {
-  update_flags |= flag;
+  /* Geometry is synchronized from multiple threads. */
+  atomic_fetch_and_or_uint32(&update_flags, flag);
 
   /* do not tag the object manager for an update if it is the one who tagged us */
   if ((flag & OBJECT_MANAGER) == 0) {
@@ -77,6 +77,8 @@ const char *name_from_type(ImageDataType type)
       return "nanovdb_float";
     case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
       return "nanovdb_float3";
+    case IMAGE_DATA_TYPE_CACHE:
+      return "cache";
     case IMAGE_DATA_NUM_TYPES:
       assert(!"System enumerator type, should never be used");
       return "";
@@ -296,7 +298,7 @@ bool ImageLoader::is_vdb_loader() const
 
 /* Image Manager */
 
-ImageManager::ImageManager(const DeviceInfo &info)
+ImageManager::ImageManager(const DeviceInfo &info, const ImageCacheParams &cache_params)
 {
   need_update_ = true;
   osl_texture_system = NULL;
@@ -304,6 +306,11 @@ ImageManager::ImageManager(const DeviceInfo &info)
 
   /* Set image limits */
   has_half_images = info.has_half_images;
+
+  /* Lookups call back into the cache on the host, CPU only. */
+  if (cache_params.use_cache && info.type == DEVICE_CPU) {
+    image_cache.reset(new ImageCache(cache_params));
+  }
 }
 
 ImageManager::~ImageManager()
@@ -317,6 +324,11 @@ void ImageManager::set_osl_texture_system(void *texture_system)
   osl_texture_system = texture_system;
 }
 
+bool ImageManager::use_texture_cache() const
+{
+  return image_cache != NULL;
+}
+
 bool ImageManager::set_animation_frame_update(int frame)
 {
   if (frame != animation_frame) {
@@ -448,6 +460,7 @@ int ImageManager::add_image_slot(ImageLoader *loader,
   img->builtin = builtin;
   img->users = 1;
   img->mem = NULL;
+  img->cache_texture = NULL;
 
   images[slot] = img;
 
@@ -661,23 +674,44 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   load_image_metadata(img);
   ImageDataType type = img->metadata.type;
 
-  /* Name for debugging. */
-  img->mem_name = string_printf("__tex_image_%s_%03d", name_from_type(type), slot);
-
   /* Free previous texture in slot. */
   if (img->mem) {
     thread_scoped_lock device_lock(device_mutex);
     delete img->mem;
     img->mem = NULL;
   }
+  if (img->cache_texture) {
+    image_cache->remove_image(img->cache_texture);
+    img->cache_texture = NULL;
+  }
 
-  img->mem = new device_texture(
-      device, img->mem_name.c_str(), slot, type, img->params.interpolation, img->params.extension);
+  /* Page in image files through the texture cache, unless they are to be scaled down. */
+  const ustring filepath = img->loader->osl_filepath();
+  if (image_cache && !filepath.empty() &&
+      !(texture_limit > 0 && max(img->metadata.width, img->metadata.height) > texture_limit)) {
+    img->cache_texture = image_cache->add_image(filepath.string(), img->params, img->metadata);
+  }
+  const ImageDataType mem_type = (img->cache_texture) ? IMAGE_DATA_TYPE_CACHE : type;
+
+  /* Name for debugging. */
+  img->mem_name = string_printf("__tex_image_%s_%03d", name_from_type(mem_type), slot);
+
+  img->mem = new device_texture(device,
+                                img->mem_name.c_str(),
+                                slot,
+                                mem_type,
+                                img->params.interpolation,
+                                img->params.extension);
   img->mem->info.use_transform_3d = img->metadata.use_transform_3d;
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (img->cache_texture) {
+    thread_scoped_lock device_lock(device_mutex);
+    ImageCacheTexture **texture = (ImageCacheTexture **)img->mem->alloc(1, 1);
+    *texture = img->cache_texture;
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -803,6 +837,10 @@ void ImageManager::device_free_image(Device *, int slot)
     delete img->mem;
   }
 
+  if (img->cache_texture) {
+    image_cache->remove_image(img->cache_texture);
+  }
+
   delete img->loader;
   delete img;
   images[slot] = NULL;
@@ -894,6 +932,10 @@ void ImageManager::collect_statistics(RenderStats *stats)
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
   }
+
+  if (image_cache) {
+    image_cache->collect_statistics(stats);
+  }
 }
 
 void ImageManager::tag_update()
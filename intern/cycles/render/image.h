@@ -20,6 +20,7 @@
 #include "device/device_memory.h"
 
 #include "render/colorspace.h"
+#include "render/image_cache.h"
 
 #include "util/util_string.h"
 #include "util/util_thread.h"
@@ -168,7 +169,7 @@ class ImageHandle {
  * texture images and 3D volume images. */
 class ImageManager {
  public:
-  explicit ImageManager(const DeviceInfo &info);
+  ImageManager(const DeviceInfo &info, const ImageCacheParams &cache_params);
   ~ImageManager();
 
   ImageHandle add_image(const string &filename, const ImageParams &params);
@@ -187,6 +188,9 @@ class ImageManager {
   void set_osl_texture_system(void *texture_system);
   bool set_animation_frame_update(int frame);
 
+  /* Image files are paged in on demand through the texture cache. */
+  bool use_texture_cache() const;
+
   void collect_statistics(RenderStats *stats);
 
   void tag_update();
@@ -205,6 +209,7 @@ class ImageManager {
 
     string mem_name;
     device_texture *mem;
+    ImageCacheTexture *cache_texture;
 
     int users;
     thread_mutex mutex;
@@ -220,6 +225,7 @@ class ImageManager {
 
   vector<Image *> images;
   void *osl_texture_system;
+  unique_ptr<ImageCache> image_cache;
 
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
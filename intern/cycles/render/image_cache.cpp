@@ -0,0 +1,279 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/image_cache.h"
+#include "render/colorspace.h"
+#include "render/image.h"
+#include "render/stats.h"
+
+#include "util/util_hash.h"
+#include "util/util_logging.h"
+#include "util/util_path.h"
+
+#include <OpenImageIO/imagebufalgo.h>
+#include <OpenImageIO/strutil.h>
+#include <OpenImageIO/texture.h>
+
+#include <cstdio>
+#include <sstream>
+
+CCL_NAMESPACE_BEGIN
+
+OIIO_NAMESPACE_USING
+
+/* Tile size of converted files, matching the auto tiling of other files. */
+static const int IMAGE_CACHE_TILE_SIZE = 64;
+
+/* Texture */
+
+class OIIOImageCacheTexture : public ImageCacheTexture {
+ public:
+  OIIOImageCacheTexture(TextureSystem *texture_system,
+                        TextureSystem::TextureHandle *handle,
+                        const ustring &filepath,
+                        const ImageParams &params,
+                        int channels)
+      : filepath(filepath),
+        texture_system(texture_system),
+        handle(handle),
+        channels(channels)
+  {
+    switch (params.interpolation) {
+      case INTERPOLATION_CLOSEST:
+        options.interpmode = TextureOpt::InterpClosest;
+        break;
+      case INTERPOLATION_CUBIC:
+      case INTERPOLATION_SMART:
+        options.interpmode = TextureOpt::InterpBicubic;
+        break;
+      default:
+        options.interpmode = TextureOpt::InterpBilinear;
+        break;
+    }
+
+    switch (params.extension) {
+      case EXTENSION_REPEAT:
+        options.swrap = options.twrap = TextureOpt::WrapPeriodic;
+        break;
+      case EXTENSION_EXTEND:
+        options.swrap = options.twrap = TextureOpt::WrapClamp;
+        break;
+      default:
+        options.swrap = options.twrap = TextureOpt::WrapBlack;
+        break;
+    }
+
+    options.fill = 0.0f;
+  }
+
+  float4 lookup(float x, float y, float2 dx, float2 dy) const override
+  {
+    TextureSystem::Perthread *thread_info = texture_system->get_perthread_info();
+    TextureOpt lookup_options = options;
+    float result[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    /* Images are stored top to bottom, texture coordinates go bottom to top. */
+    if (!texture_system->texture(handle,
+                                 thread_info,
+                                 lookup_options,
+                                 x,
+                                 1.0f - y,
+                                 dx.x,
+                                 -dx.y,
+                                 dy.x,
+                                 -dy.y,
+                                 min(channels, 4),
+                                 result)) {
+      return make_float4(
+          TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+    }
+
+    float4 r;
+    if (channels == 1) {
+      r = make_float4(result[0], result[0], result[0], 1.0f);
+    }
+    else if (channels == 2) {
+      r = make_float4(result[0], result[0], result[0], result[1]);
+    }
+    else if (channels == 3) {
+      r = make_float4(result[0], result[1], result[2], 1.0f);
+    }
+    else {
+      r = make_float4(result[0], result[1], result[2], result[3]);
+    }
+
+    /* Make sure we don't have buggy values, like loading of full images. */
+    if (!isfinite(r.x) || !isfinite(r.y) || !isfinite(r.z) || !isfinite(r.w)) {
+      return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    return r;
+  }
+
+  ustring filepath;
+
+ protected:
+  TextureSystem *texture_system;
+  TextureSystem::TextureHandle *handle;
+  TextureOpt options;
+  int channels;
+};
+
+/* Texture Cache */
+
+ImageCache::ImageCache(const ImageCacheParams &params) : params(params)
+{
+  TextureSystem *ts = TextureSystem::create(false);
+  ts->attribute("max_memory_MB", (float)max(params.cache_size, 1));
+  ts->attribute("autotile", IMAGE_CACHE_TILE_SIZE);
+  ts->attribute("automip", 1);
+  ts->attribute("accept_untiled", 1);
+  ts->attribute("accept_unmipped", 1);
+  texture_system = ts;
+
+  VLOG(1) << "Texture cache with " << params.cache_size << " MB of memory.";
+}
+
+ImageCache::~ImageCache()
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  VLOG(2) << ts->getstats();
+  ts->invalidate_all(true);
+  TextureSystem::destroy(ts);
+}
+
+bool ImageCache::image_supported(const ImageParams &params, const ImageMetaData &metadata)
+{
+  /* 2D images only. */
+  if (metadata.width == 0 || metadata.height == 0 || metadata.depth > 1 ||
+      metadata.channels <= 0) {
+    return false;
+  }
+
+  /* Color space conversion happens when loading full images, tiles are used as is. */
+  if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+    return false;
+  }
+
+  /* Tiles always have associated alpha. */
+  const bool has_alpha = (metadata.channels == 2 || metadata.channels >= 4);
+  const bool associate_alpha = !(ColorSpaceManager::colorspace_is_data(params.colorspace) ||
+                                 params.alpha_type == IMAGE_ALPHA_IGNORE ||
+                                 params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED);
+  if (has_alpha && !associate_alpha) {
+    return false;
+  }
+
+  return true;
+}
+
+string ImageCache::texture_filepath(const string &filepath)
+{
+  if (Strutil::iends_with(filepath, ".tx") || !params.auto_convert) {
+    return filepath;
+  }
+
+  const uint64_t modified_time = path_modified_time(filepath);
+
+  /* Converted file next to the image, as shipped with assets. */
+  const string filename = path_filename(filepath);
+  const string stem = filename.substr(0, filename.rfind('.'));
+  const string local_filepath = path_join(path_dirname(filepath), stem + ".tx");
+  if (path_exists(local_filepath) && path_modified_time(local_filepath) >= modified_time) {
+    return local_filepath;
+  }
+
+  /* Converted file in the cache directory, named by the full path of the image to avoid
+   * conflicts between images with the same name. */
+  const string cache_dir = params.cache_path.empty() ? path_cache_get("textures") :
+                                                       params.cache_path;
+  const string cache_filepath = path_join(
+      cache_dir, string_printf("%s_%08x.tx", stem.c_str(), hash_string(filepath.c_str())));
+
+  thread_scoped_lock lock(convert_mutex);
+
+  if (path_exists(cache_filepath) && path_modified_time(cache_filepath) >= modified_time) {
+    return cache_filepath;
+  }
+
+  VLOG(1) << "Converting image " << filepath << " to " << cache_filepath << ".";
+
+  path_create_directories(cache_filepath);
+
+  /* Write to a temporary file first, so other renders never read partially written files. */
+  const string temp_filepath = cache_filepath + string_printf(".%p.tmp", (void *)this);
+
+  ImageSpec config;
+  config.tile_width = IMAGE_CACHE_TILE_SIZE;
+  config.tile_height = IMAGE_CACHE_TILE_SIZE;
+  config.attribute("compression", "zip");
+  config.attribute("maketx:fileformatname", "tiff");
+  config.attribute("maketx:updatemode", 0);
+
+  std::stringstream errors;
+  if (!ImageBufAlgo::make_texture(
+          ImageBufAlgo::MakeTxTexture, filepath, temp_filepath, config, &errors) ||
+      std::rename(temp_filepath.c_str(), cache_filepath.c_str()) != 0) {
+    LOG(WARNING) << "Failed to convert image " << filepath << " for the texture cache: "
+                 << errors.str();
+    path_remove(temp_filepath);
+    return filepath;
+  }
+
+  return cache_filepath;
+}
+
+ImageCacheTexture *ImageCache::add_image(const string &filepath,
+                                         const ImageParams &params,
+                                         const ImageMetaData &metadata)
+{
+  if (!image_supported(params, metadata)) {
+    return NULL;
+  }
+
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  const ustring texture_filepath_u(texture_filepath(filepath));
+
+  TextureSystem::TextureHandle *handle = ts->get_texture_handle(texture_filepath_u);
+  int channels = 0;
+  if (handle == NULL || !ts->good(handle) ||
+      !ts->get_texture_info(
+          handle, NULL, 0, ustring("channels"), TypeDesc::INT, &channels) ||
+      channels <= 0) {
+    VLOG(1) << "Texture cache can't read " << texture_filepath_u << ", loading full image.";
+    return NULL;
+  }
+
+  return new OIIOImageCacheTexture(ts, handle, texture_filepath_u, params, channels);
+}
+
+void ImageCache::remove_image(ImageCacheTexture *texture)
+{
+  /* Reload tiles of modified files on the next render. */
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  ts->invalidate(((OIIOImageCacheTexture *)texture)->filepath);
+  delete texture;
+}
+
+void ImageCache::collect_statistics(RenderStats *stats)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  long long memory_used = 0;
+  ts->getattribute("stat:cache_memory_used", TypeDesc::INT64, &memory_used);
+  stats->image.textures.add_entry(NamedSizeEntry("Texture Cache", memory_used));
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IMAGE_CACHE_H__
+#define __IMAGE_CACHE_H__
+
+#include "util/util_string.h"
+#include "util/util_texture.h"
+#include "util/util_thread.h"
+
+CCL_NAMESPACE_BEGIN
+
+class ImageMetaData;
+class ImageParams;
+class RenderStats;
+
+/* Texture Cache Parameters */
+class ImageCacheParams {
+ public:
+  bool use_cache;
+  /* Memory budget for the tiles of all images, in megabytes. */
+  int cache_size;
+  /* Convert images to tiled and mipmapped .tx files on disk. */
+  bool auto_convert;
+  /* Directory for converted files, the user cache directory when empty. */
+  string cache_path;
+
+  ImageCacheParams() : use_cache(false), cache_size(4096), auto_convert(true)
+  {
+  }
+
+  bool operator==(const ImageCacheParams &other) const
+  {
+    return (use_cache == other.use_cache && cache_size == other.cache_size &&
+            auto_convert == other.auto_convert && cache_path == other.cache_path);
+  }
+};
+
+/* Texture Cache
+ *
+ * Pages in tiles of image files at the resolution needed for rendering, under a fixed memory
+ * budget, instead of loading full images into memory. Backed by the OpenImageIO texture system,
+ * which works best with tiled and mipmapped files. Other files are converted to .tx files once,
+ * and the converted files are reused for following renders.
+ *
+ * Only supported for CPU rendering, lookups call back into the cache from the kernel. */
+class ImageCache {
+ public:
+  explicit ImageCache(const ImageCacheParams &params);
+  ~ImageCache();
+
+  /* Returns a texture for lookups from the kernel, or NULL if the image can't be cached and
+   * must be loaded fully. Owned by the cache. */
+  ImageCacheTexture *add_image(const string &filepath,
+                               const ImageParams &params,
+                               const ImageMetaData &metadata);
+  void remove_image(ImageCacheTexture *texture);
+
+  void collect_statistics(RenderStats *stats);
+
+  /* Images that can be read through the cache without conversion of their pixels. */
+  static bool image_supported(const ImageParams &params, const ImageMetaData &metadata);
+
+ protected:
+  /* Find or create the .tx file for the image, returns the image itself if it can't be
+   * converted. */
+  string texture_filepath(const string &filepath);
+
+  ImageCacheParams params;
+  /* OpenImageIO texture system, private to this cache to keep its own memory budget. */
+  void *texture_system;
+
+  thread_mutex convert_mutex;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __IMAGE_CACHE_H__ */
@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/integrator.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -27,9 +28,11 @@
 #include "render/shader.h"
 #include "render/stats.h"
 
+#include "util/util_atomic.h"
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_logging.h"
+#include "util/util_map.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
 #include "util/util_task.h"
@@ -511,15 +514,24 @@ void LightManager::device_update_distribution(Device *,
 
     /* Map */
     kbackground->map_weight = background_mis ? 1.0f : 0.0f;
+
+    /* Light tree, after the distribution which it references. */
+    device_update_light_tree(dscene, scene, progress);
   }
   else {
     dscene->light_distribution.free();
+    dscene->light_tree_nodes.free();
+    dscene->light_tree_emitters.free();
+    dscene->light_tree_objects.free();
+    dscene->light_tree_triangles.free();
 
     kintegrator->num_distribution = 0;
     kintegrator->num_all_lights = 0;
     kintegrator->pdf_triangles = 0.0f;
     kintegrator->pdf_lights = 0.0f;
     kintegrator->use_lamp_mis = false;
+    kintegrator->use_light_tree = false;
+    kintegrator->num_distant_lights = 0;
 
     kbackground->num_portals = 0;
     kbackground->portal_offset = 0;
@@ -531,6 +543,231 @@ void LightManager::device_update_distribution(Device *,
   }
 }
 
+/* Estimate of the power emitted by a mesh light shader, per area. */
+static float light_tree_shader_energy(Shader *shader)
+{
+  float3 emission;
+  if (shader->is_constant_emission(&emission)) {
+    return M_PI_F * average(fabs(emission));
+  }
+  /* Unknown strength, assume the default emission of one. */
+  return M_PI_F;
+}
+
+static LightTreeEmitter light_tree_lamp_emitter(const Light *light)
+{
+  LightTreeEmitter emitter;
+  const float3 co = light->get_co();
+  const float3 dir = safe_normalize(light->get_dir());
+
+  if (light->get_light_type() == LIGHT_AREA) {
+    const float3 axisu = light->get_axisu() * (light->get_sizeu() * light->get_size());
+    const float3 axisv = light->get_axisv() * (light->get_sizev() * light->get_size());
+    emitter.bbox.grow(co - 0.5f * axisu - 0.5f * axisv);
+    emitter.bbox.grow(co + 0.5f * axisu - 0.5f * axisv);
+    emitter.bbox.grow(co - 0.5f * axisu + 0.5f * axisv);
+    emitter.bbox.grow(co + 0.5f * axisu + 0.5f * axisv);
+    /* One sided. */
+    emitter.bcone = OrientationBounds(dir, 0.0f, M_PI_2_F);
+  }
+  else {
+    emitter.bbox.grow(co, light->get_size());
+    if (light->get_light_type() == LIGHT_SPOT) {
+      emitter.bcone = OrientationBounds(dir, 0.0f, light->get_spot_angle() * 0.5f);
+    }
+    else {
+      emitter.bcone = OrientationBounds(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+    }
+  }
+
+  emitter.energy = average(fabs(light->get_strength()));
+  return emitter;
+}
+
+void LightManager::device_update_light_tree(DeviceScene *dscene, Scene *scene, Progress &progress)
+{
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+
+  /* Sampling all lights with the branched path integrator relies on the distribution. */
+  const Integrator *integrator = scene->integrator;
+  const bool sample_all_lights = integrator->get_method() == Integrator::BRANCHED_PATH &&
+                                 (integrator->get_sample_all_lights_direct() ||
+                                  integrator->get_sample_all_lights_indirect());
+  VLOG_IF(1, integrator->get_use_light_tree() && sample_all_lights)
+      << "Light tree is not used when sampling all lights.";
+
+  kintegrator->use_light_tree = false;
+  kintegrator->num_distant_lights = 0;
+
+  if (!integrator->get_use_light_tree() || sample_all_lights) {
+    dscene->light_tree_nodes.free();
+    dscene->light_tree_emitters.free();
+    dscene->light_tree_objects.free();
+    dscene->light_tree_triangles.free();
+    return;
+  }
+
+  progress.set_status("Updating Lights", "Building light tree");
+
+  vector<Light *> lights;
+  foreach (Light *light, scene->lights) {
+    if (light->is_enabled) {
+      lights.push_back(light);
+    }
+  }
+
+  /* Lookup of the mesh light triangles of each object, for the pdf of the emitters hit by
+   * rays. Objects without mesh lights reference no triangles. */
+  uint2 *tree_objects = dscene->light_tree_objects.alloc(scene->objects.size());
+  for (size_t i = 0; i < scene->objects.size(); i++) {
+    tree_objects[i] = make_uint2(LIGHT_TREE_NONE, 0);
+  }
+  size_t num_tree_triangles = 0;
+
+  vector<LightTreeEmitter> emitters;
+  vector<LightTreeEmitter> distant_emitters;
+  map<Shader *, float> shader_energy;
+
+  const KernelLightDistribution *distribution = dscene->light_distribution.data();
+  for (int i = 0; i < kintegrator->num_distribution; i++) {
+    if (distribution[i].prim < 0) {
+      const int lamp = ~distribution[i].prim;
+      const Light *light = lights[lamp];
+      if (light->get_light_type() == LIGHT_DISTANT ||
+          light->get_light_type() == LIGHT_BACKGROUND) {
+        LightTreeEmitter emitter;
+        emitter.distribution_index = i;
+        emitter.lamp = lamp;
+        distant_emitters.push_back(emitter);
+      }
+      else {
+        LightTreeEmitter emitter = light_tree_lamp_emitter(light);
+        emitter.distribution_index = i;
+        emitter.lamp = lamp;
+        emitters.push_back(emitter);
+      }
+      continue;
+    }
+
+    const int object_id = distribution[i].mesh_light.object_id;
+    Object *object = scene->objects[object_id];
+    Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+    const int triangle = distribution[i].prim - mesh->prim_offset;
+
+    if (tree_objects[object_id].x == LIGHT_TREE_NONE) {
+      tree_objects[object_id] = make_uint2(num_tree_triangles, mesh->prim_offset);
+      num_tree_triangles += mesh->num_triangles();
+    }
+
+    Mesh::Triangle t = mesh->get_triangle(triangle);
+    if (!t.valid(&mesh->get_verts()[0])) {
+      continue;
+    }
+    float3 p1 = mesh->get_verts()[t.v[0]];
+    float3 p2 = mesh->get_verts()[t.v[1]];
+    float3 p3 = mesh->get_verts()[t.v[2]];
+
+    if (!mesh->transform_applied) {
+      const Transform tfm = object->get_tfm();
+      p1 = transform_point(&tfm, p1);
+      p2 = transform_point(&tfm, p2);
+      p3 = transform_point(&tfm, p3);
+    }
+
+    const int shader_index = mesh->get_shader()[triangle];
+    Shader *shader = (shader_index < mesh->get_used_shaders().size()) ?
+                         static_cast<Shader *>(mesh->get_used_shaders()[shader_index]) :
+                         scene->default_surface;
+    if (shader_energy.find(shader) == shader_energy.end()) {
+      shader_energy[shader] = light_tree_shader_energy(shader);
+    }
+
+    LightTreeEmitter emitter;
+    emitter.bbox.grow(p1);
+    emitter.bbox.grow(p2);
+    emitter.bbox.grow(p3);
+    /* Mesh lights emit on both sides. */
+    emitter.bcone = OrientationBounds(
+        safe_normalize(cross(p2 - p1, p3 - p1)), M_PI_F, M_PI_2_F);
+    emitter.area = triangle_area(p1, p2, p3);
+    emitter.energy = emitter.area * shader_energy[shader];
+    emitter.distribution_index = i;
+    emitter.object = object_id;
+    emitter.prim = distribution[i].prim;
+    emitters.push_back(emitter);
+  }
+
+  if (emitters.empty() || progress.get_cancel()) {
+    /* Only distant lights, nothing to gain over the distribution. */
+    dscene->light_tree_nodes.free();
+    dscene->light_tree_emitters.free();
+    dscene->light_tree_objects.free();
+    dscene->light_tree_triangles.free();
+    return;
+  }
+
+  LightTree tree(emitters, 1);
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+
+  /* Distant lights first, followed by the emitters in the order of the tree. */
+  const int num_distant = distant_emitters.size();
+  const int num_emitters = num_distant + emitters.size();
+  KernelLightTreeEmitter *kemitters = dscene->light_tree_emitters.alloc(num_emitters);
+  KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(nodes.size());
+  uint *tree_triangles = dscene->light_tree_triangles.alloc(max((int)num_tree_triangles, 1));
+  KernelLight *klights = dscene->lights.data();
+
+  for (size_t i = 0; i < num_tree_triangles; i++) {
+    tree_triangles[i] = LIGHT_TREE_NONE;
+  }
+
+  for (int i = 0; i < num_emitters; i++) {
+    const LightTreeEmitter &emitter = (i < num_distant) ? distant_emitters[i] :
+                                                          emitters[i - num_distant];
+    KernelLightTreeEmitter &kemitter = kemitters[i];
+    LightTree::pack_bounds(&kemitter.bounds, emitter.bbox, emitter.bcone, emitter.energy);
+    kemitter.distribution_index = emitter.distribution_index;
+    kemitter.leaf = -1;
+    kemitter.area = emitter.area;
+    kemitter.pad = 0.0f;
+
+    if (emitter.lamp != -1) {
+      klights[emitter.lamp].tree_emitter = i;
+    }
+    else {
+      const uint2 offset = tree_objects[emitter.object];
+      tree_triangles[offset.x + emitter.prim - offset.y] = i;
+    }
+  }
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    knodes[i] = nodes[i];
+    if (knodes[i].num_emitters > 0) {
+      knodes[i].first_emitter += num_distant;
+      for (int j = 0; j < knodes[i].num_emitters; j++) {
+        kemitters[knodes[i].first_emitter + j].leaf = i;
+      }
+    }
+  }
+
+  /* Distant lights are selected with the same probability as the tree. */
+  if (num_distant > 0) {
+    kintegrator->pdf_lights = 0.5f / num_distant;
+  }
+  kintegrator->use_light_tree = true;
+  kintegrator->num_distant_lights = num_distant;
+
+  VLOG(1) << "Light tree with " << nodes.size() << " nodes, " << emitters.size()
+          << " emitters and " << num_distant << " distant lights.";
+
+  dscene->light_tree_nodes.copy_to_device();
+  dscene->light_tree_emitters.copy_to_device();
+  dscene->light_tree_objects.copy_to_device();
+  dscene->light_tree_triangles.copy_to_device();
+  /* Lamps reference their emitter. */
+  dscene->lights.copy_to_device();
+}
+
 static void background_cdf(
     int start, int end, int res_x, int res_y, const vector<float3> *pixels, float2 *cond_cdf)
 {
@@ -777,6 +1014,7 @@ void LightManager::device_update_points(Device *, DeviceScene *dscene, Scene *sc
     }
 
     klights[light_index].type = light->light_type;
+    klights[light_index].tree_emitter = LIGHT_TREE_NONE;
     klights[light_index].samples = light->samples;
     klights[light_index].strength[0] = light->strength.x;
     klights[light_index].strength[1] = light->strength.y;
@@ -946,6 +1184,7 @@ void LightManager::device_update_points(Device *, DeviceScene *dscene, Scene *sc
     klights[light_index].area.dir[0] = dir.x;
     klights[light_index].area.dir[1] = dir.y;
     klights[light_index].area.dir[2] = dir.z;
+    klights[light_index].tree_emitter = LIGHT_TREE_NONE;
     klights[light_index].tfm = light->tfm;
     klights[light_index].itfm = transform_inverse(light->tfm);
 
@@ -1009,6 +1248,10 @@ void LightManager::device_update(Device *device,
 void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_background)
 {
   dscene->light_distribution.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitters.free();
+  dscene->light_tree_objects.free();
+  dscene->light_tree_triangles.free();
   dscene->lights.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
@@ -1019,7 +1262,8 @@ void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_ba
 
 void LightManager::tag_update(Scene * /*scene*/, uint32_t flag)
 {
-  update_flags |= flag;
+  /* Geometry is synchronized from multiple threads. */
+  atomic_fetch_and_or_uint32(&update_flags, flag);
 }
 
 bool LightManager::need_update() const
@@ -0,0 +1,241 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of buckets to evaluate split candidates along each axis. */
+static const int LIGHT_TREE_NUM_BUCKETS = 12;
+
+/* Orientation Bounds */
+
+float OrientationBounds::calculate_measure() const
+{
+  const float theta_w = fminf(theta_o + theta_e, M_PI_F);
+  const float cos_theta_o = cosf(theta_o);
+  const float sin_theta_o = sinf(theta_o);
+
+  return M_2PI_F * (1.0f - cos_theta_o) +
+         M_PI_2_F * (2.0f * theta_w * sin_theta_o - cosf(theta_o - 2.0f * theta_w) -
+                     2.0f * theta_o * sin_theta_o + cos_theta_o);
+}
+
+OrientationBounds merge(const OrientationBounds &cone_a, const OrientationBounds &cone_b)
+{
+  if (cone_a.is_empty()) {
+    return cone_b;
+  }
+  if (cone_b.is_empty()) {
+    return cone_a;
+  }
+
+  /* Let a be the cone with the widest spread of normals. */
+  const bool a_is_widest = cone_a.theta_o >= cone_b.theta_o;
+  const OrientationBounds &a = a_is_widest ? cone_a : cone_b;
+  const OrientationBounds &b = a_is_widest ? cone_b : cone_a;
+
+  const float cos_theta_d = dot(a.axis, b.axis);
+  const float theta_d = safe_acosf(cos_theta_d);
+  const float theta_e = fmaxf(a.theta_e, b.theta_e);
+
+  /* The normals of b are within the cone of a. */
+  if (fminf(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    return OrientationBounds(a.axis, a.theta_o, theta_e);
+  }
+
+  const float theta_o = (a.theta_o + theta_d + b.theta_o) * 0.5f;
+  if (theta_o >= M_PI_F) {
+    return OrientationBounds(a.axis, M_PI_F, theta_e);
+  }
+
+  /* Rotate the axis of a towards b, by the angle the spread grows. */
+  const float3 ortho = b.axis - a.axis * cos_theta_d;
+  const float ortho_length = len(ortho);
+  if (ortho_length < 1e-6f) {
+    return OrientationBounds(a.axis, M_PI_F, theta_e);
+  }
+
+  const float theta_r = theta_o - a.theta_o;
+  const float3 axis = a.axis * cosf(theta_r) + ortho * (sinf(theta_r) / ortho_length);
+  return OrientationBounds(normalize(axis), theta_o, theta_e);
+}
+
+/* Light Tree */
+
+LightTree::LightTree(vector<LightTreeEmitter> &emitters, int max_emitters_in_leaf)
+    : emitters(emitters), max_emitters_in_leaf(max(max_emitters_in_leaf, 1))
+{
+  if (emitters.empty()) {
+    return;
+  }
+
+  nodes.reserve(2 * emitters.size());
+  recursive_build(-1, 0, emitters.size());
+}
+
+void LightTree::pack_bounds(KernelLightTreeBounds *kbounds,
+                            const BoundBox &bbox,
+                            const OrientationBounds &bcone,
+                            float energy)
+{
+  kbounds->bbox_min[0] = bbox.min.x;
+  kbounds->bbox_min[1] = bbox.min.y;
+  kbounds->bbox_min[2] = bbox.min.z;
+  kbounds->energy = energy;
+  kbounds->bbox_max[0] = bbox.max.x;
+  kbounds->bbox_max[1] = bbox.max.y;
+  kbounds->bbox_max[2] = bbox.max.z;
+  kbounds->theta_o = bcone.theta_o;
+  kbounds->axis[0] = bcone.axis.x;
+  kbounds->axis[1] = bcone.axis.y;
+  kbounds->axis[2] = bcone.axis.z;
+  kbounds->theta_e = bcone.theta_e;
+}
+
+int LightTree::recursive_build(int parent, int start, int end)
+{
+  BoundBox bbox = BoundBox::empty;
+  BoundBox centroid_bbox = BoundBox::empty;
+  OrientationBounds bcone = OrientationBounds::empty;
+  float energy = 0.0f;
+
+  for (int i = start; i < end; i++) {
+    const LightTreeEmitter &emitter = emitters[i];
+    bbox.grow(emitter.bbox);
+    centroid_bbox.grow(emitter.centroid());
+    bcone = merge(bcone, emitter.bcone);
+    energy += emitter.energy;
+  }
+
+  const int node_index = nodes.size();
+  nodes.push_back(KernelLightTreeNode());
+  pack_bounds(&nodes[node_index].bounds, bbox, bcone, energy);
+  nodes[node_index].parent = parent;
+
+  if (end - start <= max_emitters_in_leaf) {
+    nodes[node_index].child_index = -1;
+    nodes[node_index].first_emitter = start;
+    nodes[node_index].num_emitters = end - start;
+    return node_index;
+  }
+
+  const int split = find_split(start, end, centroid_bbox);
+
+  /* The first child directly follows its parent. */
+  recursive_build(node_index, start, split);
+  const int right_index = recursive_build(node_index, split, end);
+
+  nodes[node_index].child_index = right_index;
+  nodes[node_index].first_emitter = -1;
+  nodes[node_index].num_emitters = 0;
+  return node_index;
+}
+
+int LightTree::find_split(int start, int end, const BoundBox &centroid_bbox)
+{
+  struct Bucket {
+    BoundBox bbox = BoundBox::empty;
+    OrientationBounds bcone = OrientationBounds::empty;
+    float energy = 0.0f;
+    int count = 0;
+  };
+
+  const float3 extent = centroid_bbox.size();
+  const float max_extent = max3(extent);
+
+  float min_cost = FLT_MAX;
+  int min_axis = -1;
+  int min_bucket = 0;
+
+  /* Surface area orientation heuristic, comparing the energy weighted measure of spatial and
+   * directional bounds of both sides of each bucket boundary. */
+  for (int axis = 0; axis < 3; axis++) {
+    if (extent[axis] == 0.0f) {
+      continue;
+    }
+
+    const float inv_extent = 1.0f / extent[axis];
+    Bucket buckets[LIGHT_TREE_NUM_BUCKETS];
+    for (int i = start; i < end; i++) {
+      const LightTreeEmitter &emitter = emitters[i];
+      const int bucket_index = min(
+          (int)(LIGHT_TREE_NUM_BUCKETS * (emitter.centroid()[axis] - centroid_bbox.min[axis]) *
+                inv_extent),
+          LIGHT_TREE_NUM_BUCKETS - 1);
+      Bucket &bucket = buckets[bucket_index];
+      bucket.bbox.grow(emitter.bbox);
+      bucket.bcone = merge(bucket.bcone, emitter.bcone);
+      bucket.energy += emitter.energy;
+      bucket.count++;
+    }
+
+    /* Prefer splitting along the longest axis, for well shaped nodes. */
+    const float regularization = max_extent * inv_extent;
+
+    for (int split = 1; split < LIGHT_TREE_NUM_BUCKETS; split++) {
+      Bucket left, right;
+      for (int i = 0; i < LIGHT_TREE_NUM_BUCKETS; i++) {
+        Bucket &side = (i < split) ? left : right;
+        side.bbox.grow(buckets[i].bbox);
+        side.bcone = merge(side.bcone, buckets[i].bcone);
+        side.energy += buckets[i].energy;
+        side.count += buckets[i].count;
+      }
+      if (left.count == 0 || right.count == 0) {
+        continue;
+      }
+
+      const float cost = regularization *
+                         (left.energy * left.bbox.half_area() * left.bcone.calculate_measure() +
+                          right.energy * right.bbox.half_area() *
+                              right.bcone.calculate_measure());
+      if (cost < min_cost) {
+        min_cost = cost;
+        min_axis = axis;
+        min_bucket = split;
+      }
+    }
+  }
+
+  int split = (start + end) / 2;
+
+  if (min_axis != -1) {
+    const float inv_extent = 1.0f / extent[min_axis];
+    auto is_left = [&](const LightTreeEmitter &emitter) {
+      const int bucket_index = min((int)(LIGHT_TREE_NUM_BUCKETS *
+                                         (emitter.centroid()[min_axis] -
+                                          centroid_bbox.min[min_axis]) *
+                                         inv_extent),
+                                   LIGHT_TREE_NUM_BUCKETS - 1);
+      return bucket_index < min_bucket;
+    };
+    split = std::partition(emitters.begin() + start, emitters.begin() + end, is_left) -
+            emitters.begin();
+  }
+
+  /* All centroids coincide, split in the middle to keep the leaves small. */
+  if (split == start || split == end) {
+    split = (start + end) / 2;
+  }
+
+  return split;
+}
+
+CCL_NAMESPACE_END
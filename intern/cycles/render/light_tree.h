@@ -0,0 +1,122 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Bounds on the emission directions of a set of emitters: the normals are within theta_o of the
+ * axis, and light is emitted up to theta_e away from the normals. */
+struct OrientationBounds {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+
+  enum empty_t { empty = 0 };
+
+  OrientationBounds(empty_t) : axis(make_float3(0.0f, 0.0f, 0.0f)), theta_o(0.0f), theta_e(-1.0f)
+  {
+  }
+
+  OrientationBounds(const float3 &axis_, float theta_o_, float theta_e_)
+      : axis(axis_), theta_o(theta_o_), theta_e(theta_e_)
+  {
+  }
+
+  bool is_empty() const
+  {
+    return theta_e < 0.0f;
+  }
+
+  /* Measure of the solid angle of the emission directions, for the build cost. */
+  float calculate_measure() const;
+};
+
+OrientationBounds merge(const OrientationBounds &a, const OrientationBounds &b);
+
+/* Lamp or mesh light triangle to be sampled with the light tree. */
+struct LightTreeEmitter {
+  BoundBox bbox;
+  OrientationBounds bcone;
+  float energy;
+
+  /* Index in the light distribution. */
+  int distribution_index;
+
+  /* Lamp index, or -1 for triangles. */
+  int lamp;
+  /* Object index and triangle index including the mesh prim offset, for triangles. */
+  int object;
+  int prim;
+  float area;
+
+  LightTreeEmitter()
+      : bbox(BoundBox::empty),
+        bcone(OrientationBounds::empty),
+        energy(0.0f),
+        distribution_index(-1),
+        lamp(-1),
+        object(-1),
+        prim(-1),
+        area(0.0f)
+  {
+  }
+
+  float3 centroid() const
+  {
+    return bbox.center();
+  }
+};
+
+/* Hierarchy of emitter bounds, to select lights proportional to their estimated contribution
+ * to the shading point.
+ *
+ * The emitters are reordered so that every leaf references a contiguous range of them.
+ * Nodes are stored depth first, the first child of an inner node directly follows it. */
+class LightTree {
+ public:
+  LightTree(vector<LightTreeEmitter> &emitters, int max_emitters_in_leaf);
+
+  const vector<KernelLightTreeNode> &get_nodes() const
+  {
+    return nodes;
+  }
+
+  static void pack_bounds(KernelLightTreeBounds *kbounds,
+                          const BoundBox &bbox,
+                          const OrientationBounds &bcone,
+                          float energy);
+
+ protected:
+  int recursive_build(int parent, int start, int end);
+  /* Partition the emitters in two, returns the index of the first emitter of the second half. */
+  int find_split(int start, int end, const BoundBox &centroid_bbox);
+
+  vector<LightTreeEmitter> &emitters;
+  vector<KernelLightTreeNode> nodes;
+  int max_emitters_in_leaf;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
@@ -169,6 +169,8 @@ SubdParams *Mesh::get_subd_params()
     subd_params = new SubdParams(this);
   }
 
+  subd_params->cache = subd_dice_cache;
+
   subd_params->dicing_rate = subd_dicing_rate;
   subd_params->max_level = subd_max_level;
   subd_params->objecttoworld = subd_objecttoworld;
@@ -176,6 +178,21 @@ SubdParams *Mesh::get_subd_params()
   return subd_params;
 }
 
+void Mesh::set_use_subd_dice_cache(bool use)
+{
+  if (use && !subd_dice_cache) {
+    subd_dice_cache = new SubdDiceCache();
+  }
+  else if (!use && subd_dice_cache) {
+    delete subd_dice_cache;
+    subd_dice_cache = nullptr;
+  }
+
+  if (subd_params) {
+    subd_params->cache = subd_dice_cache;
+  }
+}
+
 bool Mesh::need_tesselation()
 {
   return get_subd_params() && (verts_is_modified() || subd_dicing_rate_is_modified() ||
@@ -210,6 +227,7 @@ Mesh::~Mesh()
 {
   delete patch_table;
   delete subd_params;
+  delete subd_dice_cache;
 }
 
 void Mesh::resize_mesh(int numverts, int numtris)
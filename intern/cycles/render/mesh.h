@@ -46,6 +46,7 @@ class Scene;
 class SceneParams;
 class AttributeRequest;
 struct SubdParams;
+class SubdDiceCache;
 class DiagSplit;
 struct PackedPatchTable;
 
@@ -193,6 +194,8 @@ class Mesh : public Geometry {
   friend class ObjectManager;
 
   SubdParams *subd_params = nullptr;
+  /* Diced vertices of the last tessellation. */
+  SubdDiceCache *subd_dice_cache = nullptr;
 
  public:
   /* Functions */
@@ -239,6 +242,9 @@ class Mesh : public Geometry {
   SubdFace get_subd_face(size_t index) const;
 
   SubdParams *get_subd_params();
+  /* Keep the diced vertices for the next tessellation, only worth the memory when the mesh is
+   * tessellated again. */
+  void set_use_subd_dice_cache(bool use);
 
   size_t get_num_subd_faces() const
   {
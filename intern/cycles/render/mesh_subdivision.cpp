@@ -165,7 +165,10 @@ class OsdData {
   Far::PatchMap *patch_map;
 
  public:
-  OsdData() : mesh(NULL), refiner(NULL), patch_table(NULL), patch_map(NULL)
+  /* Adaptive refinement level, which depends on the dicing camera. */
+  int max_isolation;
+
+  OsdData() : mesh(NULL), refiner(NULL), patch_table(NULL), patch_map(NULL), max_isolation(0)
   {
   }
 
@@ -191,7 +194,7 @@ class OsdData {
         *mesh, Far::TopologyRefinerFactory<Mesh>::Options(type, options));
 
     /* adaptive refinement */
-    int max_isolation = calculate_max_isolation();
+    max_isolation = calculate_max_isolation();
     refiner->RefineAdaptive(Far::TopologyRefiner::AdaptiveOptions(max_isolation));
 
     /* create patch table */
@@ -369,6 +372,45 @@ struct OsdPatch : Patch {
 
 #endif
 
+/* Hash of everything the evaluation of patches depends on, to detect when diced vertices from
+ * the last tessellation can no longer be used. */
+
+static uint64_t hash_data(uint64_t hash, const void *data, size_t size)
+{
+  /* FNV-1a */
+  const uchar *bytes = (const uchar *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+template<typename T> static uint64_t hash_array(uint64_t hash, const array<T> &data)
+{
+  return hash_data(hash, data.data(), data.size() * sizeof(T));
+}
+
+static uint64_t subd_mesh_hash(const Mesh *mesh, const Attribute *attr_vN, int max_isolation)
+{
+  const int subdivision_type = mesh->get_subdivision_type();
+
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  hash = hash_data(hash, &subdivision_type, sizeof(subdivision_type));
+  hash = hash_data(hash, &max_isolation, sizeof(max_isolation));
+  hash = hash_array(hash, mesh->get_verts());
+  hash = hash_array(hash, mesh->get_subd_start_corner());
+  hash = hash_array(hash, mesh->get_subd_num_corners());
+  hash = hash_array(hash, mesh->get_subd_smooth());
+  hash = hash_array(hash, mesh->get_subd_ptex_offset());
+  hash = hash_array(hash, mesh->get_subd_face_corners());
+  hash = hash_array(hash, mesh->get_subd_creases_edge());
+  hash = hash_array(hash, mesh->get_subd_creases_weight());
+  if (attr_vN) {
+    hash = hash_data(hash, attr_vN->buffer.data(), attr_vN->buffer.size());
+  }
+  return hash;
+}
+
 void Mesh::tessellate(DiagSplit *split)
 {
   /* reset the number of subdivision vertices, in case the Mesh was not cleared
@@ -403,6 +445,15 @@ void Mesh::tessellate(DiagSplit *split)
   Attribute *attr_vN = subd_attributes.find(ATTR_STD_VERTEX_NORMAL);
   float3 *vN = (attr_vN) ? attr_vN->data_float3() : NULL;
 
+  if (subd_dice_cache) {
+#ifdef WITH_OPENSUBDIV
+    const int max_isolation = osd_data.max_isolation;
+#else
+    const int max_isolation = 0;
+#endif
+    subd_dice_cache->update(subd_mesh_hash(this, attr_vN, max_isolation));
+  }
+
   /* count patches */
   int num_patches = 0;
   for (int f = 0; f < num_faces; f++) {
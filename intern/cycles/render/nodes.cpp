@@ -360,6 +360,27 @@ void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attribute
   ShaderNode::attributes(shader, attributes);
 }
 
+/* Texture coordinates are the default UV map, so the texture cache can use the UV derivatives
+ * to select the resolution of the image. */
+static bool image_texture_uses_default_uv(ShaderInput *vector_in)
+{
+  if (vector_in->link == NULL) {
+    return false;
+  }
+
+  ShaderNode *node = vector_in->link->parent;
+  if (node->type == UVMapNode::node_type) {
+    UVMapNode *uvmap = (UVMapNode *)node;
+    return uvmap->get_attribute().empty() && !uvmap->get_from_dupli();
+  }
+  else if (node->type == TextureCoordinateNode::node_type) {
+    TextureCoordinateNode *texco = (TextureCoordinateNode *)node;
+    return vector_in->link == node->output("UV") && !texco->get_from_dupli();
+  }
+
+  return false;
+}
+
 void ImageTextureNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *vector_in = input("Vector");
@@ -392,6 +413,10 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
       flags |= NODE_IMAGE_ALPHA_UNASSOCIATE;
     }
   }
+  if (projection == NODE_IMAGE_PROJ_FLAT && compiler.scene->image_manager->use_texture_cache() &&
+      tex_mapping.skip() && image_texture_uses_default_uv(vector_in)) {
+    flags |= NODE_IMAGE_UV_DERIVATIVES;
+  }
 
   if (projection != NODE_IMAGE_PROJ_BOX) {
     /* If there only is one image (a very common case), we encode it as a negative value. */
@@ -27,6 +27,7 @@
 #include "render/stats.h"
 #include "render/volume.h"
 
+#include "util/util_atomic.h"
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_map.h"
@@ -911,7 +912,8 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
 
 void ObjectManager::tag_update(Scene *scene, uint32_t flag)
 {
-  update_flags |= flag;
+  /* Geometry is synchronized from multiple threads. */
+  atomic_fetch_and_or_uint32(&update_flags, flag);
 
   /* avoid infinite loops if the geometry manager tagged us for an update */
   if ((flag & GEOMETRY_MANAGER) == 0) {
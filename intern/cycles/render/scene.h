@@ -116,6 +116,10 @@ class DeviceScene {
   device_vector<KernelLight> lights;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<KernelLightTreeEmitter> light_tree_emitters;
+  device_vector<uint2> light_tree_objects;
+  device_vector<uint> light_tree_triangles;
 
   /* particles */
   device_vector<KernelParticle> particles;
@@ -175,11 +179,17 @@ class SceneParams {
   BVHType bvh_type;
   bool use_bvh_spatial_split;
   bool use_bvh_unaligned_nodes;
+  bool use_bvh_quantized_nodes;
   int num_bvh_time_steps;
+  /* Refit the BVH of deforming geometry instead of rebuilding it when the topology did not
+   * change, until the SAH cost grew by the given factor since the last build. */
+  bool use_bvh_refit;
+  float bvh_refit_max_degradation;
   int hair_subdivisions;
   CurveShapeType hair_shape;
   bool persistent_data;
   int texture_limit;
+  ImageCacheParams texture_cache;
 
   bool background;
 
@@ -190,7 +200,10 @@ class SceneParams {
     bvh_type = BVH_DYNAMIC;
     use_bvh_spatial_split = false;
     use_bvh_unaligned_nodes = true;
+    use_bvh_quantized_nodes = false;
     num_bvh_time_steps = 0;
+    use_bvh_refit = false;
+    bvh_refit_max_degradation = 1.5f;
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     persistent_data = false;
@@ -204,9 +217,13 @@ class SceneParams {
              bvh_type == params.bvh_type &&
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
+             use_bvh_quantized_nodes == params.use_bvh_quantized_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
+             use_bvh_refit == params.use_bvh_refit &&
+             bvh_refit_max_degradation == params.bvh_refit_max_degradation &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             texture_cache == params.texture_cache);
   }
 
   int curve_subdivisions()
@@ -28,6 +28,7 @@
 #include "render/object.h"
 #include "render/scene.h"
 #include "render/session.h"
+#include "render/tile_spool.h"
 
 #include "util/util_foreach.h"
 #include "util/util_function.h"
@@ -77,6 +78,7 @@ Session::Session(const SessionParams &params_)
 
   buffers = NULL;
   display = NULL;
+  tile_spool = NULL;
 
   /* Validate denoising parameters. */
   set_denoising(params.denoising);
@@ -90,7 +92,11 @@ Session::Session(const SessionParams &params_)
   }
 
   /* Create buffers for interactive rendering. */
-  if (!(params.background && !params.write_render_cb)) {
+  if (params.background && !params.spool_filepath.empty() && !params.progressive_refine) {
+    /* Only buffers of tiles in progress are kept in memory, finished tiles go to the file. */
+    tile_spool = new TileSpool();
+  }
+  else if (!(params.background && !params.write_render_cb)) {
     buffers = new RenderBuffers(device);
     display = new DisplayBuffer(device, params.display_buffer_linear);
   }
@@ -117,6 +123,7 @@ Session::~Session()
   /* clean up */
   tile_manager.device_free();
 
+  delete tile_spool;
   delete buffers;
   delete display;
   delete scene;
@@ -619,6 +626,9 @@ void Session::release_tile(RenderTile &rtile, const bool need_denoise)
   progress.add_finished_tile(rtile.task == RenderTile::DENOISE);
 
   bool delete_tile;
+  RenderBuffers *delete_buffers = NULL;
+  bool spool = false;
+  vector<float> spool_pixels;
 
   if (tile_manager.finish_tile(rtile.tile_index, need_denoise, delete_tile)) {
     /* Finished tile pixels write. */
@@ -627,8 +637,14 @@ void Session::release_tile(RenderTile &rtile, const bool need_denoise)
     }
 
     if (delete_tile) {
-      delete rtile.buffers;
+      /* Nothing else uses the buffers anymore, spool and free them outside of the lock. */
+      delete_buffers = rtile.buffers;
       tile_manager.state.tiles[rtile.tile_index].buffers = NULL;
+      spool = (tile_spool != NULL);
+    }
+    else if (tile_spool) {
+      /* Buffers are still used to denoise neighbor tiles, only write outside of the lock. */
+      spool = read_spool_tile(rtile, spool_pixels);
     }
   }
   else {
@@ -642,6 +658,40 @@ void Session::release_tile(RenderTile &rtile, const bool need_denoise)
 
   /* Notify denoising thread that a tile was finished. */
   denoising_cond.notify_all();
+
+  tile_lock.unlock();
+
+  if (spool && delete_buffers) {
+    spool = read_spool_tile(rtile, spool_pixels);
+  }
+  if (spool) {
+    write_spool_tile(rtile, spool_pixels);
+  }
+
+  delete delete_buffers;
+}
+
+bool Session::read_spool_tile(RenderTile &rtile, vector<float> &pixels)
+{
+  /* Adjust absolute sample number to the range. */
+  int sample = rtile.sample;
+  if (tile_manager.range_start_sample != -1) {
+    sample -= tile_manager.range_start_sample;
+  }
+
+  if (!tile_spool->read_tile(rtile, scene->film->get_exposure(), sample, pixels)) {
+    progress.set_error(tile_spool->error_message());
+    return false;
+  }
+
+  return true;
+}
+
+void Session::write_spool_tile(const RenderTile &rtile, const vector<float> &pixels)
+{
+  if (!tile_spool->write_tile(rtile, pixels)) {
+    progress.set_error(tile_spool->error_message());
+  }
 }
 
 void Session::map_neighbor_tiles(RenderTileNeighbors &neighbors, Device *tile_device)
@@ -897,6 +947,10 @@ void Session::run()
 
   profiler.stop();
 
+  if (tile_spool && !tile_spool->close()) {
+    progress.set_error(tile_spool->error_message());
+  }
+
   /* progress update */
   if (progress.get_cancel())
     progress.set_status(progress.get_cancel_message());
@@ -924,6 +978,14 @@ void Session::reset_(BufferParams &buffer_params, int samples)
 
   tile_manager.reset(buffer_params, samples);
   stealable_tiles = 0;
+
+  if (tile_spool) {
+    tile_spool->close();
+    if (!tile_spool->open(
+            params.spool_filepath, "ViewLayer", tile_manager.params, params.tile_size)) {
+      progress.set_error(tile_spool->error_message());
+    }
+  }
   tile_stealing_state = NOT_STEALING;
   progress.reset_sample();
 
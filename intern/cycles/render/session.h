@@ -36,6 +36,7 @@ class DeviceScene;
 class DeviceRequestedFeatures;
 class DisplayBuffer;
 class Progress;
+class TileSpool;
 class RenderBuffers;
 class Scene;
 
@@ -71,6 +72,10 @@ class SessionParams {
 
   ShadingSystem shadingsystem;
 
+  /* Write finished tiles of background renders to this tiled multilayer EXR file, instead of
+   * keeping the full render in memory. Not supported with progressive refine. */
+  string spool_filepath;
+
   function<bool(const uchar *pixels, int width, int height, int channels)> write_render_cb;
 
   SessionParams()
@@ -117,6 +122,7 @@ class SessionParams {
              text_timeout == params.text_timeout &&
              progressive_update_timeout == params.progressive_update_timeout &&
              tile_order == params.tile_order && shadingsystem == params.shadingsystem &&
+             spool_filepath == params.spool_filepath &&
              denoising.type == params.denoising.type &&
              (denoising.use == params.denoising.use || (device.denoisers & denoising.type)));
   }
@@ -200,6 +206,8 @@ class Session {
   bool acquire_tile(RenderTile &tile, Device *tile_device, uint tile_types);
   void update_tile_sample(RenderTile &tile);
   void release_tile(RenderTile &tile, const bool need_denoise);
+  bool read_spool_tile(RenderTile &tile, vector<float> &pixels);
+  void write_spool_tile(const RenderTile &tile, const vector<float> &pixels);
 
   void map_neighbor_tiles(RenderTileNeighbors &neighbors, Device *tile_device);
   void unmap_neighbor_tiles(RenderTileNeighbors &neighbors, Device *tile_device);
@@ -239,6 +247,8 @@ class Session {
 
   /* progressive refine */
   bool update_progressive_refine(bool cancel);
+
+  TileSpool *tile_spool;
 };
 
 CCL_NAMESPACE_END
@@ -18,6 +18,7 @@
 
 #include "render/background.h"
 #include "render/graph.h"
+#include "render/image.h"
 #include "render/light.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
@@ -29,6 +30,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_set.h"
 #include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
@@ -45,24 +47,43 @@ SVMShaderManager::~SVMShaderManager()
 
 void SVMShaderManager::reset(Scene * /*scene*/)
 {
+  compiled_shaders.clear();
 }
 
 void SVMShaderManager::device_update_shader(Scene *scene,
                                             Shader *shader,
                                             Progress *progress,
-                                            array<int4> *svm_nodes)
+                                            CompiledShader *compiled)
 {
   if (progress->get_cancel()) {
     return;
   }
   assert(shader->graph);
 
-  svm_nodes->push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
+  const bool background = (shader == scene->background->get_shader(scene));
+  const bool use_texture_cache = scene->image_manager->use_texture_cache();
+
+  /* Reuse the nodes from the previous update if neither the shader nor its graph changed.
+   * Images and other resources stay referenced by the nodes of the graph, so their slots in
+   * the compiled nodes remain valid. */
+  if (!shader->is_modified() && shader->graph == compiled->graph && shader->graph->finalized &&
+      background == compiled->background && use_texture_cache == compiled->use_texture_cache &&
+      shader->graph->compute_hash() == compiled->graph_hash) {
+    return;
+  }
+
+  compiled->svm_nodes.clear();
+  compiled->svm_nodes.push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
 
   SVMCompiler::Summary summary;
   SVMCompiler compiler(scene);
-  compiler.background = (shader == scene->background->get_shader(scene));
-  compiler.compile(shader, *svm_nodes, 0, &summary);
+  compiler.background = background;
+  compiler.compile(shader, compiled->svm_nodes, 0, &summary);
+
+  compiled->graph = shader->graph;
+  compiled->graph_hash = shader->graph->compute_hash();
+  compiled->background = background;
+  compiled->use_texture_cache = use_texture_cache;
 
   VLOG(2) << "Compilation summary:\n"
           << "Shader name: " << shader->name << "\n"
@@ -92,16 +113,28 @@ void SVMShaderManager::device_update(Device *device,
   /* test if we need to update */
   device_free(device, dscene, scene);
 
-  /* Build all shaders. */
+  /* Forget shaders that were removed from the scene. */
+  set<Shader *> scene_shaders(scene->shaders.begin(), scene->shaders.end());
+  for (auto it = compiled_shaders.begin(); it != compiled_shaders.end();) {
+    if (scene_shaders.find(it->first) == scene_shaders.end()) {
+      it = compiled_shaders.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+
+  /* Build all shaders, entries are created here since the map is not thread safe. */
   TaskPool task_pool;
-  vector<array<int4>> shader_svm_nodes(num_shaders);
+  vector<CompiledShader *> shader_compiled(num_shaders);
   for (int i = 0; i < num_shaders; i++) {
+    shader_compiled[i] = &compiled_shaders[scene->shaders[i]];
     task_pool.push(function_bind(&SVMShaderManager::device_update_shader,
                                  this,
                                  scene,
                                  scene->shaders[i],
                                  &progress,
-                                 &shader_svm_nodes[i]));
+                                 shader_compiled[i]));
   }
   task_pool.wait_work();
 
@@ -114,7 +147,7 @@ void SVMShaderManager::device_update(Device *device,
   int svm_nodes_size = num_shaders;
   for (int i = 0; i < num_shaders; i++) {
     /* Since we're not copying the local jump node, the size ends up being one node lower. */
-    svm_nodes_size += shader_svm_nodes[i].size() - 1;
+    svm_nodes_size += shader_compiled[i]->svm_nodes.size() - 1;
   }
 
   int4 *svm_nodes = dscene->svm_nodes.alloc(svm_nodes_size);
@@ -132,22 +165,22 @@ void SVMShaderManager::device_update(Device *device,
      * Each compiled shader starts with a jump node that has offsets local
      * to the shader, so copy those and add the offset into the global node list. */
     int4 &global_jump_node = svm_nodes[shader->id];
-    int4 &local_jump_node = shader_svm_nodes[i][0];
+    int4 &local_jump_node = shader_compiled[i]->svm_nodes[0];
 
     global_jump_node.x = NODE_SHADER_JUMP;
     global_jump_node.y = local_jump_node.y - 1 + node_offset;
     global_jump_node.z = local_jump_node.z - 1 + node_offset;
     global_jump_node.w = local_jump_node.w - 1 + node_offset;
 
-    node_offset += shader_svm_nodes[i].size() - 1;
+    node_offset += shader_compiled[i]->svm_nodes.size() - 1;
   }
 
   /* Copy the nodes of each shader into the correct location. */
   svm_nodes += num_shaders;
   for (int i = 0; i < num_shaders; i++) {
-    int shader_size = shader_svm_nodes[i].size() - 1;
+    int shader_size = shader_compiled[i]->svm_nodes.size() - 1;
 
-    memcpy(svm_nodes, &shader_svm_nodes[i][1], sizeof(int4) * shader_size);
+    memcpy(svm_nodes, &shader_compiled[i]->svm_nodes[1], sizeof(int4) * shader_size);
     svm_nodes += shader_size;
   }
 
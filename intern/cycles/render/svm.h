@@ -22,6 +22,7 @@
 #include "render/shader.h"
 
 #include "util/util_array.h"
+#include "util/util_map.h"
 #include "util/util_set.h"
 #include "util/util_string.h"
 #include "util/util_thread.h"
@@ -50,10 +51,26 @@ class SVMShaderManager : public ShaderManager {
   void device_free(Device *device, DeviceScene *dscene, Scene *scene);
 
  protected:
+  /* Compiled nodes of a shader, kept across updates to skip compilation of shaders that did
+   * not change. The nodes start with a jump node with offsets local to the shader. */
+  struct CompiledShader {
+    CompiledShader() : graph(NULL), background(false), use_texture_cache(false)
+    {
+    }
+
+    ShaderGraph *graph;
+    string graph_hash;
+    bool background;
+    bool use_texture_cache;
+    array<int4> svm_nodes;
+  };
+
   void device_update_shader(Scene *scene,
                             Shader *shader,
                             Progress *progress,
-                            array<int4> *svm_nodes);
+                            CompiledShader *compiled);
+
+  map<Shader *, CompiledShader> compiled_shaders;
 };
 
 /* Graph Compiler */
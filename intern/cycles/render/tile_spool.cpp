@@ -0,0 +1,236 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/tile_spool.h"
+
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_math.h"
+#include "util/util_path.h"
+#include "util/util_unique_ptr.h"
+
+#include <OpenImageIO/imageio.h>
+
+CCL_NAMESPACE_BEGIN
+
+OIIO_NAMESPACE_USING
+
+/* Number of channels written for a pass, matching the passes of Blender render results. */
+static int spool_pass_components(const Pass &pass)
+{
+  if (pass.components == 1) {
+    return 1;
+  }
+  if (pass.type == PASS_COMBINED || pass.type == PASS_MOTION || pass.type == PASS_CRYPTOMATTE) {
+    return 4;
+  }
+  return 3;
+}
+
+static const char *spool_channel_names(const Pass &pass, int components)
+{
+  if (components == 1) {
+    return (pass.type == PASS_DEPTH || pass.type == PASS_MIST) ? "Z" : "X";
+  }
+  if (pass.type == PASS_NORMAL || pass.type == PASS_MOTION) {
+    return "XYZW";
+  }
+  if (pass.type == PASS_UV) {
+    return "UVA";
+  }
+  return "RGBA";
+}
+
+TileSpool::TileSpool() : tile_size(make_int2(0, 0)), num_channels(0), out(NULL)
+{
+}
+
+TileSpool::~TileSpool()
+{
+  close();
+}
+
+bool TileSpool::open(const string &filepath,
+                     const string &layer_name,
+                     const BufferParams &params_,
+                     int2 tile_size_)
+{
+  thread_scoped_lock lock(mutex);
+
+  assert(out == NULL);
+
+  params = params_;
+  tile_size = make_int2(min(tile_size_.x, params.width), min(tile_size_.y, params.height));
+  const int num_tiles_x = divide_up(params.width, tile_size.x);
+  const int num_tiles_y = divide_up(params.height, tile_size.y);
+
+  /* Passes with a name, others are only used internally by the kernel. Channels are named
+   * RenderLayer.Pass.Channel like Blender multilayer files. */
+  ImageSpec spec;
+  passes.clear();
+  num_channels = 0;
+  foreach (const Pass &pass, params.passes) {
+    if (pass.name.empty() || pass.components == 0) {
+      continue;
+    }
+
+    SpoolPass spool_pass;
+    spool_pass.name = pass.name.string();
+    spool_pass.components = spool_pass_components(pass);
+    spool_pass.channel_offset = num_channels;
+    passes.push_back(spool_pass);
+
+    const char *channel_names = spool_channel_names(pass, spool_pass.components);
+    for (int c = 0; c < spool_pass.components; c++) {
+      spec.channelnames.push_back(layer_name + "." + spool_pass.name + "." + channel_names[c]);
+    }
+    num_channels += spool_pass.components;
+  }
+
+  if (num_channels == 0) {
+    error = "No named render passes to write to " + filepath;
+    return false;
+  }
+
+  spec.nchannels = num_channels;
+  spec.format = TypeDesc::FLOAT;
+  spec.tile_width = tile_size.x;
+  spec.tile_height = tile_size.y;
+  spec.width = num_tiles_x * tile_size.x;
+  spec.height = num_tiles_y * tile_size.y;
+  spec.x = 0;
+  spec.y = params.height - spec.height;
+  spec.full_x = 0;
+  spec.full_y = 0;
+  spec.full_width = params.width;
+  spec.full_height = params.height;
+  spec.attribute("compression", "zip");
+  spec.attribute("openexr:lineOrder", "randomY");
+
+  path_create_directories(filepath);
+
+  unique_ptr<ImageOutput> image_output(ImageOutput::create(filepath));
+  if (!image_output || !image_output->supports("tiles") ||
+      !image_output->supports("random_access")) {
+    error = "Failed to open " + filepath + " for writing tiles";
+    return false;
+  }
+
+  if (!image_output->open(filepath, spec)) {
+    error = "Failed to open " + filepath + " for writing tiles: " + image_output->geterror();
+    return false;
+  }
+
+  out = image_output.release();
+
+  VLOG(1) << "Spooling " << params.width << "x" << params.height << " render with "
+          << num_channels << " channels to " << filepath << ".";
+
+  return true;
+}
+
+bool TileSpool::read_tile(RenderTile &rtile,
+                          float exposure,
+                          int sample,
+                          vector<float> &r_pixels)
+{
+  RenderBuffers *buffers = rtile.buffers;
+  const int x = rtile.x - params.full_x;
+  const int y = rtile.y - params.full_y;
+
+  if (x % tile_size.x != 0 || y % tile_size.y != 0 || rtile.w > tile_size.x ||
+      rtile.h > tile_size.y) {
+    thread_scoped_lock lock(mutex);
+    error = string_printf("Tile at %d, %d not aligned to the spooled tiles", x, y);
+    return false;
+  }
+
+  if (!buffers->copy_from_device()) {
+    thread_scoped_lock lock(mutex);
+    error = string_printf("Failed to copy tile at %d, %d from the device", x, y);
+    return false;
+  }
+
+  /* Convert passes and flip rows without the lock. */
+  r_pixels.clear();
+  r_pixels.resize(tile_size.x * tile_size.y * num_channels, 0.0f);
+  vector<float> pass_pixels(rtile.w * rtile.h * 4);
+
+  foreach (const SpoolPass &pass, passes) {
+    if (!buffers->get_pass_rect(pass.name, exposure, sample, pass.components, &pass_pixels[0])) {
+      continue;
+    }
+
+    /* Rows of partial tiles at the top of the image end up at the bottom of the file tile. */
+    for (int j = 0; j < rtile.h; j++) {
+      const float *in = &pass_pixels[j * rtile.w * pass.components];
+      float *out_row = &r_pixels[(tile_size.y - 1 - j) * tile_size.x * num_channels +
+                                 pass.channel_offset];
+      for (int i = 0; i < rtile.w; i++) {
+        for (int c = 0; c < pass.components; c++) {
+          out_row[i * num_channels + c] = in[i * pass.components + c];
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+bool TileSpool::write_tile(const RenderTile &rtile, const vector<float> &pixels)
+{
+  const int x = rtile.x - params.full_x;
+  const int y = rtile.y - params.full_y;
+
+  thread_scoped_lock lock(mutex);
+
+  ImageOutput *image_output = (ImageOutput *)out;
+  if (image_output == NULL) {
+    error = "Spooled file is not open";
+    return false;
+  }
+
+  /* Top row of the tile in the file, which is stored top to bottom. */
+  const int file_y = params.height - y - tile_size.y;
+  if (!image_output->write_tile(x, file_y, 0, TypeDesc::FLOAT, &pixels[0])) {
+    error = "Failed to write tile: " + image_output->geterror();
+    return false;
+  }
+
+  return true;
+}
+
+bool TileSpool::close()
+{
+  thread_scoped_lock lock(mutex);
+
+  ImageOutput *image_output = (ImageOutput *)out;
+  if (image_output == NULL) {
+    return true;
+  }
+
+  const bool success = image_output->close();
+  if (!success) {
+    error = "Failed to close spooled file: " + image_output->geterror();
+  }
+
+  delete image_output;
+  out = NULL;
+
+  return success;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TILE_SPOOL_H__
+#define __TILE_SPOOL_H__
+
+#include "render/buffers.h"
+
+#include "util/util_string.h"
+#include "util/util_thread.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Tile Spool
+ *
+ * Writes finished tiles of a background render straight into a tiled multilayer EXR file, so
+ * their buffers can be freed immediately and the full resolution result never has to fit in
+ * memory. Tiles may be written in any order, the file is complete once all tiles are written
+ * and it is closed.
+ *
+ * Tiles must be aligned to the tile size, as generated by the tile manager for background
+ * renders. Cycles buffers are stored bottom to top, so the data window of the file extends
+ * above the image to align the tiles of the file with the render tiles. */
+class TileSpool {
+ public:
+  TileSpool();
+  ~TileSpool();
+
+  bool open(const string &filepath,
+            const string &layer_name,
+            const BufferParams &params,
+            int2 tile_size);
+  /* Convert the passes of a finished tile to the pixels of a file tile. Tiles can be read and
+   * written from multiple threads, only writing to the file is serialized. */
+  bool read_tile(RenderTile &rtile, float exposure, int sample, vector<float> &r_pixels);
+  bool write_tile(const RenderTile &rtile, const vector<float> &pixels);
+  bool close();
+
+  bool is_open() const
+  {
+    return out != NULL;
+  }
+
+  string error_message()
+  {
+    thread_scoped_lock lock(mutex);
+    return error;
+  }
+
+ protected:
+  struct SpoolPass {
+    string name;
+    int components;
+    int channel_offset;
+  };
+
+  BufferParams params;
+  int2 tile_size;
+  int num_channels;
+  vector<SpoolPass> passes;
+
+  /* OpenImageIO output, opaque to keep it out of the header. */
+  void *out;
+  /* Protected by the mutex, tiles can fail from any thread. */
+  string error;
+
+  thread_mutex mutex;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __TILE_SPOOL_H__ */
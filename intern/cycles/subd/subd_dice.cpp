@@ -22,6 +22,53 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Dice Cache */
+
+bool SubdPatchCache::matches(const Subpatch *subpatches, int num_subpatches, int num_verts) const
+{
+  if (P.size() != (size_t)num_verts || corners.size() != (size_t)num_subpatches * 4) {
+    return false;
+  }
+
+  for (int i = 0; i < num_subpatches; i++) {
+    for (int j = 0; j < 4; j++) {
+      const float2 corner = corners[i * 4 + j];
+      if (corner.x != subpatches[i].corners[j].x || corner.y != subpatches[i].corners[j].y ||
+          edge_factors[i * 4 + j] != subpatches[i].edges[j].T) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void SubdPatchCache::reset(const Subpatch *subpatches, int num_subpatches, int num_verts)
+{
+  corners.resize(num_subpatches * 4);
+  edge_factors.resize(num_subpatches * 4);
+
+  for (int i = 0; i < num_subpatches; i++) {
+    for (int j = 0; j < 4; j++) {
+      corners[i * 4 + j] = subpatches[i].corners[j];
+      edge_factors[i * 4 + j] = subpatches[i].edges[j].T;
+    }
+  }
+
+  P.clear();
+  N.clear();
+  P.reserve(num_verts);
+  N.reserve(num_verts);
+}
+
+void SubdDiceCache::update(uint64_t mesh_hash_)
+{
+  if (mesh_hash != mesh_hash_) {
+    mesh_hash = mesh_hash_;
+    patches.clear();
+  }
+}
+
 /* EdgeDice Base */
 
 EdgeDice::EdgeDice(const SubdParams &params_) : params(params_)
@@ -45,8 +92,14 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   vert_offset = mesh->get_verts().size();
   tri_offset = mesh->num_triangles();
 
-  mesh->resize_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles());
-  mesh->reserve_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles() + num_triangles);
+  mesh->resize_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles() + num_triangles);
+
+  mesh->tag_verts_modified();
+  mesh->tag_triangles_modified();
+  mesh->tag_shader_modified();
+  mesh->tag_smooth_modified();
+  mesh->tag_triangle_patch_modified();
+  mesh->tag_vert_patch_uv_modified();
 
   Attribute *attr_vN = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -56,11 +109,23 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   params.mesh->num_subd_verts += num_verts;
 }
 
-void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
+void EdgeDice::set_vert(Patch *patch, int index, float2 uv, DiceVerts &verts)
 {
   float3 P, N;
 
-  patch->eval(&P, NULL, NULL, &N, uv.x, uv.y);
+  if (verts.from_cache) {
+    P = verts.cache->P[verts.next];
+    N = verts.cache->N[verts.next];
+    verts.next++;
+  }
+  else {
+    patch->eval(&P, NULL, NULL, &N, uv.x, uv.y);
+
+    if (verts.cache) {
+      verts.cache->P.push_back(P);
+      verts.cache->N.push_back(N);
+    }
+  }
 
   assert(index < params.mesh->verts.size());
 
@@ -69,17 +134,22 @@ void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
   params.mesh->vert_patch_uv[index + vert_offset] = make_float2(uv.x, uv.y);
 }
 
-void EdgeDice::add_triangle(Patch *patch, int v0, int v1, int v2)
+void EdgeDice::add_triangle(Patch *patch, int &triangle, int v0, int v1, int v2)
 {
   Mesh *mesh = params.mesh;
+  const size_t index = tri_offset + triangle;
 
-  mesh->add_triangle(v0 + vert_offset, v1 + vert_offset, v2 + vert_offset, patch->shader, true);
-  params.mesh->triangle_patch[params.mesh->num_triangles() - 1] = patch->patch_index;
+  mesh->triangles[index * 3 + 0] = v0 + vert_offset;
+  mesh->triangles[index * 3 + 1] = v1 + vert_offset;
+  mesh->triangles[index * 3 + 2] = v2 + vert_offset;
+  mesh->shader[index] = patch->shader;
+  mesh->smooth[index] = true;
+  mesh->triangle_patch[index] = patch->patch_index;
 
-  tri_offset++;
+  triangle++;
 }
 
-void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
+void EdgeDice::stitch_triangles(Subpatch &sub, int edge, int &triangle)
 {
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
   int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
@@ -122,7 +192,7 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
         v2 = sub.get_vert_along_grid_edge(edge, ++i);
     }
 
-    add_triangle(sub.patch, v1, v0, v2);
+    add_triangle(sub.patch, triangle, v1, v0, v2);
   }
 }
 
@@ -152,17 +222,23 @@ float3 QuadDice::eval_projected(Subpatch &sub, float u, float v)
   return P;
 }
 
-void QuadDice::set_vert(Subpatch &sub, int index, float u, float v)
+void QuadDice::set_vert(Subpatch &sub, int index, float u, float v, DiceVerts &verts)
 {
-  EdgeDice::set_vert(sub.patch, index, map_uv(sub, u, v));
+  EdgeDice::set_vert(sub.patch, index, map_uv(sub, u, v), verts);
 }
 
-void QuadDice::set_side(Subpatch &sub, int edge)
+void QuadDice::set_side(
+    Subpatch &sub, int edge, int owner, const vector<int> &vert_owner, DiceVerts &verts)
 {
   int t = sub.edges[edge].T;
 
   /* set verts on the edge of the patch */
   for (int i = 0; i < t; i++) {
+    const int index = sub.get_vert_along_edge(edge, i);
+    if (vert_owner[index] != owner) {
+      continue;
+    }
+
     float f = i / (float)t;
 
     float u, v;
@@ -186,7 +262,7 @@ void QuadDice::set_side(Subpatch &sub, int edge)
         break;
     }
 
-    set_vert(sub, sub.get_vert_along_edge(edge, i), u, v);
+    set_vert(sub, index, u, v, verts);
   }
 }
 
@@ -224,7 +300,23 @@ float QuadDice::scale_factor(Subpatch &sub, int Mu, int Mv)
   return S;
 }
 
-void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
+void QuadDice::grid_size(Subpatch &sub, int &Mu, int &Mv)
+{
+  /* compute inner grid size with scale factor */
+  Mu = max(sub.edge_u0.T, sub.edge_u1.T);
+  Mv = max(sub.edge_v0.T, sub.edge_v1.T);
+
+#if 0 /* Doesn't work very well, especially at grazing angles. */
+  float S = scale_factor(sub, ef, Mu, Mv);
+#else
+  float S = 1.0f;
+#endif
+
+  Mu = max((int)ceilf(S * Mu), 2);  // XXX handle 0 & 1?
+  Mv = max((int)ceilf(S * Mv), 2);  // XXX handle 0 & 1?
+}
+
+void QuadDice::set_grid_verts(Subpatch &sub, int Mu, int Mv, int offset, DiceVerts &verts)
 {
   /* create inner grid */
   float du = 1.0f / (float)Mu;
@@ -235,49 +327,57 @@ void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
       float u = i * du;
       float v = j * dv;
 
-      set_vert(sub, offset + (i - 1) + (j - 1) * (Mu - 1), u, v);
-
-      if (i < Mu - 1 && j < Mv - 1) {
-        int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
-        int i2 = offset + i + (j - 1) * (Mu - 1);
-        int i3 = offset + i + j * (Mu - 1);
-        int i4 = offset + (i - 1) + j * (Mu - 1);
+      set_vert(sub, offset + (i - 1) + (j - 1) * (Mu - 1), u, v, verts);
+    }
+  }
+}
 
-        add_triangle(sub.patch, i1, i2, i3);
-        add_triangle(sub.patch, i1, i3, i4);
-      }
+void QuadDice::add_grid_triangles(Subpatch &sub, int Mu, int Mv, int offset, int &triangle)
+{
+  for (int j = 1; j < Mv - 1; j++) {
+    for (int i = 1; i < Mu - 1; i++) {
+      int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
+      int i2 = offset + i + (j - 1) * (Mu - 1);
+      int i3 = offset + i + j * (Mu - 1);
+      int i4 = offset + (i - 1) + j * (Mu - 1);
+
+      add_triangle(sub.patch, triangle, i1, i2, i3);
+      add_triangle(sub.patch, triangle, i1, i3, i4);
     }
   }
 }
 
-void QuadDice::dice(Subpatch &sub)
+void QuadDice::dice_verts(Subpatch &sub,
+                          int owner,
+                          const vector<int> &vert_owner,
+                          DiceVerts &verts)
 {
-  /* compute inner grid size with scale factor */
-  int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
-  int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
+  int Mu, Mv;
+  grid_size(sub, Mu, Mv);
 
-#if 0 /* Doesn't work very well, especially at grazing angles. */
-  float S = scale_factor(sub, ef, Mu, Mv);
-#else
-  float S = 1.0f;
-#endif
+  /* inner grid */
+  set_grid_verts(sub, Mu, Mv, sub.inner_grid_vert_offset, verts);
 
-  Mu = max((int)ceilf(S * Mu), 2);  // XXX handle 0 & 1?
-  Mv = max((int)ceilf(S * Mv), 2);  // XXX handle 0 & 1?
+  /* sides */
+  set_side(sub, 0, owner, vert_owner, verts);
+  set_side(sub, 1, owner, vert_owner, verts);
+  set_side(sub, 2, owner, vert_owner, verts);
+  set_side(sub, 3, owner, vert_owner, verts);
+}
+
+void QuadDice::dice_triangles(Subpatch &sub, int triangle)
+{
+  int Mu, Mv;
+  grid_size(sub, Mu, Mv);
 
   /* inner grid */
-  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
+  add_grid_triangles(sub, Mu, Mv, sub.inner_grid_vert_offset, triangle);
 
   /* sides */
-  set_side(sub, 0);
-  set_side(sub, 1);
-  set_side(sub, 2);
-  set_side(sub, 3);
-
-  stitch_triangles(sub, 0);
-  stitch_triangles(sub, 1);
-  stitch_triangles(sub, 2);
-  stitch_triangles(sub, 3);
+  stitch_triangles(sub, 0, triangle);
+  stitch_triangles(sub, 1, triangle);
+  stitch_triangles(sub, 2, triangle);
+  stitch_triangles(sub, 3, triangle);
 }
 
 CCL_NAMESPACE_END
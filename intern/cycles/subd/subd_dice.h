@@ -33,6 +33,36 @@ class Camera;
 class Mesh;
 class Patch;
 
+/* Vertices of the subpatches of one patch, in the order they are diced, along with the corners
+ * and edge factors of the subpatches that determine them. */
+struct SubdPatchCache {
+  vector<float2> corners;
+  vector<int> edge_factors;
+
+  vector<float3> P;
+  vector<float3> N;
+
+  bool matches(const Subpatch *subpatches, int num_subpatches, int num_verts) const;
+  void reset(const Subpatch *subpatches, int num_subpatches, int num_verts);
+};
+
+/* Diced vertices of all patches of a mesh, kept between tessellations so patches with the same
+ * edge factors as before are not evaluated again, for example when only the dicing camera moved
+ * a little. Only valid as long as the control mesh does not change. */
+class SubdDiceCache {
+ public:
+  SubdDiceCache() : mesh_hash(0)
+  {
+  }
+
+  /* Invalidate all patches if the control mesh changed since the last tessellation. */
+  void update(uint64_t mesh_hash);
+
+  uint64_t mesh_hash;
+  /* Indexed by patch index. */
+  vector<SubdPatchCache> patches;
+};
+
 struct SubdParams {
   Mesh *mesh;
   bool ptex;
@@ -43,6 +73,7 @@ struct SubdParams {
   int max_level;
   Camera *camera;
   Transform objecttoworld;
+  SubdDiceCache *cache;
 
   SubdParams(Mesh *mesh_, bool ptex_ = false)
   {
@@ -54,6 +85,19 @@ struct SubdParams {
     dicing_rate = 1.0f;
     max_level = 12;
     camera = NULL;
+    cache = NULL;
+  }
+};
+
+/* Source of the vertices while dicing a patch, either evaluated from the patch and optionally
+ * stored in the cache, or read back from the cache. */
+struct DiceVerts {
+  SubdPatchCache *cache;
+  bool from_cache;
+  size_t next;
+
+  DiceVerts(SubdPatchCache *cache, bool from_cache) : cache(cache), from_cache(from_cache), next(0)
+  {
   }
 };
 
@@ -69,12 +113,14 @@ class EdgeDice {
 
   explicit EdgeDice(const SubdParams &params);
 
+  /* Allocate vertices and triangles, which are then set in place so patches can be diced in
+   * parallel. */
   void reserve(int num_verts, int num_triangles);
 
-  void set_vert(Patch *patch, int index, float2 uv);
-  void add_triangle(Patch *patch, int v0, int v1, int v2);
+  void set_vert(Patch *patch, int index, float2 uv, DiceVerts &verts);
+  void add_triangle(Patch *patch, int &triangle, int v0, int v1, int v2);
 
-  void stitch_triangles(Subpatch &sub, int edge);
+  void stitch_triangles(Subpatch &sub, int edge, int &triangle);
 };
 
 /* Quad EdgeDice */
@@ -86,16 +132,24 @@ class QuadDice : public EdgeDice {
   float3 eval_projected(Subpatch &sub, float u, float v);
 
   float2 map_uv(Subpatch &sub, float u, float v);
-  void set_vert(Subpatch &sub, int index, float u, float v);
+  void set_vert(Subpatch &sub, int index, float u, float v, DiceVerts &verts);
 
-  void add_grid(Subpatch &sub, int Mu, int Mv, int offset);
+  void grid_size(Subpatch &sub, int &Mu, int &Mv);
+  void set_grid_verts(Subpatch &sub, int Mu, int Mv, int offset, DiceVerts &verts);
+  void add_grid_triangles(Subpatch &sub, int Mu, int Mv, int offset, int &triangle);
 
-  void set_side(Subpatch &sub, int edge);
+  /* Vertices on the sides are shared with neighboring subpatches, and only set by the
+   * subpatch owning them. */
+  void set_side(
+      Subpatch &sub, int edge, int owner, const vector<int> &vert_owner, DiceVerts &verts);
 
   float quad_area(const float3 &a, const float3 &b, const float3 &c, const float3 &d);
   float scale_factor(Subpatch &sub, int Mu, int Mv);
 
-  void dice(Subpatch &sub);
+  /* Dicing happens in two passes, the triangles along the sides depend on the vertices set by
+   * neighboring subpatches. */
+  void dice_verts(Subpatch &sub, int owner, const vector<int> &vert_owner, DiceVerts &verts);
+  void dice_triangles(Subpatch &sub, int triangle);
 };
 
 CCL_NAMESPACE_END
@@ -25,6 +25,7 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_math.h"
+#include "util/util_tbb.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -601,6 +602,41 @@ void DiagSplit::split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t pa
   }
 }
 
+void DiagSplit::dice_patch_verts(QuadDice &dice, int start, int end, const vector<int> &vert_owner)
+{
+  SubdPatchCache *cache = NULL;
+  bool from_cache = false;
+
+  if (params.cache) {
+    int num_verts = 0;
+
+    for (int i = start; i < end; i++) {
+      Subpatch &sub = subpatches[i];
+      num_verts += sub.calc_num_inner_verts();
+
+      for (int edge = 0; edge < 4; edge++) {
+        for (int j = 0; j < sub.edges[edge].T; j++) {
+          num_verts += (vert_owner[sub.get_vert_along_edge(edge, j)] == i) ? 1 : 0;
+        }
+      }
+    }
+
+    /* Reuse the vertices of the last tessellation if the patch is diced the same way. */
+    cache = &params.cache->patches[subpatches[start].patch->patch_index];
+    from_cache = cache->matches(&subpatches[start], end - start, num_verts);
+
+    if (!from_cache) {
+      cache->reset(&subpatches[start], end - start, num_verts);
+    }
+  }
+
+  DiceVerts verts(cache, from_cache);
+
+  for (int i = start; i < end; i++) {
+    dice.dice_verts(subpatches[i], i, vert_owner, verts);
+  }
+}
+
 void DiagSplit::post_split()
 {
   int num_stitch_verts = 0;
@@ -720,14 +756,11 @@ void DiagSplit::post_split()
 
   int num_verts = num_alloced_verts;
   int num_triangles = 0;
+  int num_patches = 0;
 
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    subpatches[i].inner_grid_vert_offset = num_verts;
-    num_verts += subpatches[i].calc_num_inner_verts();
-    num_triangles += subpatches[i].calc_num_triangles();
-  }
-
-  dice.reserve(num_verts, num_triangles);
+  /* Subpatches of a patch are contiguous, dice each patch as one task. */
+  vector<int> patch_starts;
+  vector<int> triangle_offsets(subpatches.size());
 
   for (size_t i = 0; i < subpatches.size(); i++) {
     Subpatch &sub = subpatches[i];
@@ -737,9 +770,53 @@ void DiagSplit::post_split()
     sub.edge_v0.T = max(sub.edge_v0.T, 1);
     sub.edge_v1.T = max(sub.edge_v1.T, 1);
 
-    dice.dice(sub);
+    sub.inner_grid_vert_offset = num_verts;
+    triangle_offsets[i] = num_triangles;
+    num_verts += sub.calc_num_inner_verts();
+    num_triangles += sub.calc_num_triangles();
+
+    if (i == 0 || sub.patch != subpatches[i - 1].patch) {
+      patch_starts.push_back(i);
+    }
+    num_patches = max(num_patches, sub.patch->patch_index + 1);
+  }
+  patch_starts.push_back(subpatches.size());
+
+  dice.reserve(num_verts, num_triangles);
+
+  /* Vertices along edges are shared by the subpatches on both sides. Let the last subpatch
+   * set them, so the result does not depend on the order patches are diced in. */
+  vector<int> vert_owner(num_alloced_verts, -1);
+
+  for (size_t i = 0; i < subpatches.size(); i++) {
+    Subpatch &sub = subpatches[i];
+
+    for (int edge = 0; edge < 4; edge++) {
+      for (int j = 0; j < sub.edges[edge].T; j++) {
+        vert_owner[sub.get_vert_along_edge(edge, j)] = i;
+      }
+    }
   }
 
+  if (params.cache) {
+    params.cache->patches.resize(num_patches);
+  }
+
+  /* Set all vertices first, stitching triangles along the sides uses the vertices set by
+   * neighboring subpatches. */
+  parallel_for(blocked_range<size_t>(0, patch_starts.size() - 1),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   dice_patch_verts(dice, patch_starts[i], patch_starts[i + 1], vert_owner);
+                 }
+               });
+
+  parallel_for(blocked_range<size_t>(0, subpatches.size()), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); i++) {
+      dice.dice_triangles(subpatches[i], triangle_offsets[i]);
+    }
+  });
+
   /* Cleanup */
   subpatches.clear();
   edges.clear();
@@ -54,6 +54,8 @@ class DiagSplit {
 
   void split(Subpatch &sub, int depth = 0);
 
+  void dice_patch_verts(QuadDice &dice, int start, int end, const vector<int> &vert_owner);
+
   int num_alloced_verts = 0;
   int alloc_verts(int n); /* Returns start index of new verts. */
 
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "bvh/bvh2.h"
+
+#include "util/util_math.h"
+
+#include <cfloat>
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Same reconstruction as bvh_quantized_node_dequantize() in the kernel. */
+static float dequantize(float origin, int exponent, int q)
+{
+  const float scale = __uint_as_float((uint)(exponent + 127) << 23);
+  return origin + (float)q * scale;
+}
+
+/* Quantize the bounds of two children on one axis, and check that the dequantized bounds
+ * contain the original bounds. */
+static void expect_quantized_bounds_contain(float min0, float max0, float min1, float max1)
+{
+  const float origin = min(min0, min1);
+  const float upper = max(max0, max1);
+
+  const int exponent = bvh_quantize_exponent(origin, upper);
+  EXPECT_GE(exponent, -126);
+  EXPECT_LE(exponent, 127);
+  const float scale = ldexpf(1.0f, exponent);
+
+  const int qmin0 = bvh_quantize_lower(origin, scale, min0);
+  const int qmin1 = bvh_quantize_lower(origin, scale, min1);
+  const int qmax0 = bvh_quantize_upper(origin, scale, max0);
+  const int qmax1 = bvh_quantize_upper(origin, scale, max1);
+
+  for (const int q : {qmin0, qmin1, qmax0, qmax1}) {
+    EXPECT_GE(q, 0);
+    EXPECT_LE(q, 255);
+  }
+
+  EXPECT_LE(dequantize(origin, exponent, qmin0), min0);
+  EXPECT_LE(dequantize(origin, exponent, qmin1), min1);
+  EXPECT_GE(dequantize(origin, exponent, qmax0), max0);
+  EXPECT_GE(dequantize(origin, exponent, qmax1), max1);
+}
+
+}  // namespace
+
+TEST(bvh_quantize, contains_bounds)
+{
+  expect_quantized_bounds_contain(0.0f, 1.0f, 0.5f, 2.0f);
+  expect_quantized_bounds_contain(-3.7f, -1.2f, 0.1f, 5.3f);
+  expect_quantized_bounds_contain(1000.1f, 1000.2f, 1000.15f, 1000.3f);
+  expect_quantized_bounds_contain(-1e-3f, 1e-3f, 0.0f, 2e-3f);
+}
+
+TEST(bvh_quantize, contains_degenerate_bounds)
+{
+  /* Zero extent children and nodes. */
+  expect_quantized_bounds_contain(1.0f, 1.0f, 1.0f, 1.0f);
+  expect_quantized_bounds_contain(0.0f, 0.0f, 0.0f, 0.0f);
+  expect_quantized_bounds_contain(-5.0f, -5.0f, 3.0f, 3.0f);
+  expect_quantized_bounds_contain(2.0f, 4.0f, 3.0f, 3.0f);
+
+  /* Extents close to the float precision of the origin. */
+  expect_quantized_bounds_contain(1e6f, nextafterf(1e6f, FLT_MAX), 1e6f, 1e6f);
+  expect_quantized_bounds_contain(FLT_MIN, 2.0f * FLT_MIN, 0.0f, FLT_MIN);
+}
+
+TEST(bvh_quantize, contains_large_bounds)
+{
+  expect_quantized_bounds_contain(-1e30f, 1e30f, 0.0f, 1.0f);
+  expect_quantized_bounds_contain(0.0f, 1e38f, 1e37f, 3e38f);
+  expect_quantized_bounds_contain(-FLT_MAX, 0.0f, 0.0f, FLT_MAX);
+  expect_quantized_bounds_contain(-FLT_MAX, FLT_MAX, -FLT_MAX, FLT_MAX);
+}
+
+TEST(bvh_quantize, contains_random_bounds)
+{
+  /* Deterministic pseudo random bounds over a wide range of magnitudes. */
+  uint state = 12345;
+  auto random_float = [&state]() {
+    state = state * 1664525u + 1013904223u;
+    return (float)(state >> 8) / (float)(1 << 24);
+  };
+
+  for (int i = 0; i < 10000; i++) {
+    const float magnitude = ldexpf(1.0f, (int)(random_float() * 80.0f) - 40);
+    const float center = (random_float() - 0.5f) * magnitude * 100.0f;
+    float bounds[4];
+    for (float &bound : bounds) {
+      bound = center + (random_float() - 0.5f) * magnitude;
+    }
+    expect_quantized_bounds_contain(min(bounds[0], bounds[1]),
+                                    max(bounds[0], bounds[1]),
+                                    min(bounds[2], bounds[3]),
+                                    max(bounds[2], bounds[3]));
+  }
+}
+
+CCL_NAMESPACE_END
@@ -1541,4 +1541,33 @@ TEST_F(RenderGraph, constant_fold_convert_color_float_color)
   graph.finalize(scene);
 }
 
+/*
+ * Tests:
+ *  - graph hash used to reuse compiled shaders changes with socket values and links.
+ */
+TEST_F(RenderGraph, compute_hash)
+{
+  EXPECT_ANY_MESSAGE(log);
+
+  builder.add_attribute("Attribute")
+      .add_node(ShaderNodeBuilder<MathNode>(graph, "MathAdd")
+                    .set_param("math_type", NODE_MATH_ADD)
+                    .set("Value2", 1.0f))
+      .add_connection("Attribute::Fac", "MathAdd::Value1")
+      .output_value("MathAdd::Value");
+
+  const string hash = graph.compute_hash();
+  EXPECT_EQ(graph.compute_hash(), hash);
+
+  ShaderNode *math = builder.find_node("MathAdd");
+  math->input("Value2")->set(2.0f);
+  EXPECT_NE(graph.compute_hash(), hash);
+
+  math->input("Value2")->set(1.0f);
+  EXPECT_EQ(graph.compute_hash(), hash);
+
+  graph.disconnect(math->input("Value1"));
+  EXPECT_NE(graph.compute_hash(), hash);
+}
+
 CCL_NAMESPACE_END
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/light_tree.h"
+
+#include "util/util_hash.h"
+#include "util/util_math.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Minimal kernel globals to run the light tree traversal on the host. */
+struct KernelGlobals {
+  vector<KernelLightTreeNode> __light_tree_nodes;
+  vector<KernelLightTreeEmitter> __light_tree_emitters;
+  vector<uint2> __light_tree_objects;
+  vector<uint> __light_tree_triangles;
+  KernelData __data;
+};
+
+CCL_NAMESPACE_END
+
+#define kernel_tex_fetch(tex, index) (kg->tex[index])
+#define kernel_data (kg->__data)
+
+#include "kernel/kernel_light_tree.h"
+
+#undef kernel_tex_fetch
+#undef kernel_data
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+static const int NUM_LIGHTS = 256;
+
+/* Isotropic point lights spread over a plane, with varying intensity. */
+static vector<LightTreeEmitter> point_light_emitters()
+{
+  vector<LightTreeEmitter> emitters;
+  for (int i = 0; i < NUM_LIGHTS; i++) {
+    const float3 co = make_float3(hash_uint2_to_float(i, 0) * 100.0f,
+                                  hash_uint2_to_float(i, 1) * 100.0f,
+                                  hash_uint2_to_float(i, 2));
+    LightTreeEmitter emitter;
+    emitter.bbox.grow(co, 0.1f);
+    emitter.bcone = OrientationBounds(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+    emitter.energy = 1.0f + 9.0f * hash_uint2_to_float(i, 3);
+    emitter.distribution_index = i;
+    emitter.lamp = i;
+    emitters.push_back(emitter);
+  }
+  return emitters;
+}
+
+static void pack_light_tree(KernelGlobals *kg, vector<LightTreeEmitter> &emitters)
+{
+  LightTree tree(emitters, 1);
+  kg->__light_tree_nodes = tree.get_nodes();
+  kg->__light_tree_emitters.resize(emitters.size());
+
+  for (size_t i = 0; i < emitters.size(); i++) {
+    KernelLightTreeEmitter &kemitter = kg->__light_tree_emitters[i];
+    LightTree::pack_bounds(
+        &kemitter.bounds, emitters[i].bbox, emitters[i].bcone, emitters[i].energy);
+    kemitter.distribution_index = emitters[i].distribution_index;
+    kemitter.area = 0.0f;
+  }
+  for (size_t i = 0; i < kg->__light_tree_nodes.size(); i++) {
+    const KernelLightTreeNode &knode = kg->__light_tree_nodes[i];
+    for (int j = 0; j < knode.num_emitters; j++) {
+      kg->__light_tree_emitters[knode.first_emitter + j].leaf = i;
+    }
+  }
+
+  kg->__data.integrator.use_light_tree = true;
+  kg->__data.integrator.num_distant_lights = 0;
+  kg->__data.integrator.pdf_lights = 0.0f;
+}
+
+static float3 shading_point(int i)
+{
+  return make_float3(
+      hash_uint2_to_float(i, 10) * 100.0f, hash_uint2_to_float(i, 11) * 100.0f, -1.0f);
+}
+
+}  // namespace
+
+TEST(render_light_tree, build)
+{
+  vector<LightTreeEmitter> emitters = point_light_emitters();
+  LightTree tree(emitters, 1);
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+
+  ASSERT_EQ(nodes.size(), (size_t)(2 * NUM_LIGHTS - 1));
+  EXPECT_EQ(nodes[0].parent, -1);
+
+  /* Every emitter is in exactly one leaf, and inner nodes bound their children. */
+  vector<int> leaf_of_emitter(NUM_LIGHTS, -1);
+  for (int i = 0; i < (int)nodes.size(); i++) {
+    const KernelLightTreeNode &node = nodes[i];
+    if (node.num_emitters > 0) {
+      for (int j = 0; j < node.num_emitters; j++) {
+        EXPECT_EQ(leaf_of_emitter[node.first_emitter + j], -1);
+        leaf_of_emitter[node.first_emitter + j] = i;
+      }
+      continue;
+    }
+
+    const KernelLightTreeNode &left = nodes[i + 1];
+    const KernelLightTreeNode &right = nodes[node.child_index];
+    EXPECT_EQ(left.parent, i);
+    EXPECT_EQ(right.parent, i);
+    EXPECT_NEAR(
+        node.bounds.energy, left.bounds.energy + right.bounds.energy, 1e-4f * node.bounds.energy);
+    for (int axis = 0; axis < 3; axis++) {
+      EXPECT_LE(node.bounds.bbox_min[axis], left.bounds.bbox_min[axis]);
+      EXPECT_LE(node.bounds.bbox_min[axis], right.bounds.bbox_min[axis]);
+      EXPECT_GE(node.bounds.bbox_max[axis], left.bounds.bbox_max[axis]);
+      EXPECT_GE(node.bounds.bbox_max[axis], right.bounds.bbox_max[axis]);
+    }
+  }
+  for (int i = 0; i < NUM_LIGHTS; i++) {
+    EXPECT_NE(leaf_of_emitter[i], -1);
+  }
+}
+
+TEST(render_light_tree, merge_orientation_bounds)
+{
+  const OrientationBounds a(make_float3(0.0f, 0.0f, 1.0f), 0.0f, M_PI_2_F);
+  const OrientationBounds b(make_float3(1.0f, 0.0f, 0.0f), 0.0f, M_PI_4_F);
+
+  const OrientationBounds ab = merge(a, b);
+  EXPECT_NEAR(ab.theta_o, M_PI_4_F, 1e-5f);
+  EXPECT_NEAR(ab.theta_e, M_PI_2_F, 1e-5f);
+  EXPECT_NEAR(dot(ab.axis, normalize(make_float3(1.0f, 0.0f, 1.0f))), 1.0f, 1e-5f);
+
+  const OrientationBounds opposite = merge(a, OrientationBounds(-a.axis, 0.0f, M_PI_2_F));
+  EXPECT_EQ(opposite.theta_o, M_PI_F);
+
+  EXPECT_EQ(merge(OrientationBounds::empty, b).theta_e, b.theta_e);
+}
+
+/* The probabilities of sampling each emitter sum to one, and match the probability used for
+ * multiple importance sampling of emitters hit by rays. */
+TEST(render_light_tree, pdf)
+{
+  KernelGlobals kg_data;
+  KernelGlobals *kg = &kg_data;
+  vector<LightTreeEmitter> emitters = point_light_emitters();
+  pack_light_tree(kg, emitters);
+
+  for (int p = 0; p < 8; p++) {
+    const float3 P = shading_point(p);
+
+    float pdf_sum = 0.0f;
+    for (int i = 0; i < NUM_LIGHTS; i++) {
+      pdf_sum += light_tree_pdf(kg, P, i);
+    }
+    EXPECT_NEAR(pdf_sum, 1.0f, 1e-4f);
+
+    for (int s = 0; s < 64; s++) {
+      float randu = hash_uint2_to_float(p, s + 100);
+      float pdf;
+      const int index = light_tree_sample(kg, P, &randu, &pdf);
+      ASSERT_GE(index, 0);
+      EXPECT_GE(randu, 0.0f);
+      EXPECT_LE(randu, 1.0f);
+      EXPECT_NEAR(pdf, light_tree_pdf(kg, P, index), 1e-5f * pdf);
+    }
+  }
+}
+
+/* Estimate the irradiance from all lights, selecting a single light per sample with the light
+ * tree and with the uniform light distribution. Both converge to the exact sum, the light tree
+ * with less variance. */
+TEST(render_light_tree, convergence)
+{
+  KernelGlobals kg_data;
+  KernelGlobals *kg = &kg_data;
+  vector<LightTreeEmitter> emitters = point_light_emitters();
+  pack_light_tree(kg, emitters);
+
+  const int num_samples = 1 << 16;
+
+  for (int p = 0; p < 4; p++) {
+    const float3 P = shading_point(p);
+
+    auto irradiance = [&](int i) {
+      return emitters[i].energy / len_squared(emitters[i].centroid() - P);
+    };
+
+    double exact = 0.0;
+    for (int i = 0; i < NUM_LIGHTS; i++) {
+      exact += irradiance(i);
+    }
+
+    double tree_sum = 0.0, tree_sum_squared = 0.0;
+    double distribution_sum = 0.0, distribution_sum_squared = 0.0;
+    for (int s = 0; s < num_samples; s++) {
+      const float randu = (s + hash_uint2_to_float(p, s)) / num_samples;
+
+      float tree_randu = randu;
+      float pdf;
+      const int index = light_tree_sample(kg, P, &tree_randu, &pdf);
+      ASSERT_GE(index, 0);
+      const double tree_estimate = irradiance(index) / pdf;
+      tree_sum += tree_estimate;
+      tree_sum_squared += tree_estimate * tree_estimate;
+
+      const int light = min((int)(randu * NUM_LIGHTS), NUM_LIGHTS - 1);
+      const double distribution_estimate = irradiance(light) * NUM_LIGHTS;
+      distribution_sum += distribution_estimate;
+      distribution_sum_squared += distribution_estimate * distribution_estimate;
+    }
+
+    const double tree_mean = tree_sum / num_samples;
+    const double distribution_mean = distribution_sum / num_samples;
+    EXPECT_NEAR(tree_mean, exact, 0.01 * exact);
+    EXPECT_NEAR(distribution_mean, exact, 0.01 * exact);
+
+    const double tree_variance = tree_sum_squared / num_samples - tree_mean * tree_mean;
+    const double distribution_variance = distribution_sum_squared / num_samples -
+                                         distribution_mean * distribution_mean;
+    EXPECT_LT(tree_variance, distribution_variance);
+  }
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/mesh.h"
+
+#include "subd/subd_dice.h"
+#include "subd/subd_split.h"
+
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+static const int GRID_SIZE = 4;
+
+/* Grid of quads with a bump in the middle, and a triangle next to it. */
+static void create_cage(Mesh *mesh, float height, float dicing_rate)
+{
+  mesh->clear(true);
+  mesh->set_subdivision_type(Mesh::SUBDIVISION_LINEAR);
+
+  array<float3> verts;
+  for (int j = 0; j <= GRID_SIZE; j++) {
+    for (int i = 0; i <= GRID_SIZE; i++) {
+      const bool center = (i > 0 && i < GRID_SIZE && j > 0 && j < GRID_SIZE);
+      verts.push_back_slow(make_float3((float)i, (float)j, center ? height : 0.0f));
+    }
+  }
+  verts.push_back_slow(make_float3(GRID_SIZE + 1.0f, 0.0f, 0.0f));
+  mesh->set_verts(verts);
+
+  const int num_quads = GRID_SIZE * GRID_SIZE;
+  mesh->reserve_subd_faces(num_quads + 1, 1, num_quads * 4 + 3);
+
+  for (int j = 0; j < GRID_SIZE; j++) {
+    for (int i = 0; i < GRID_SIZE; i++) {
+      const int v = j * (GRID_SIZE + 1) + i;
+      int corners[4] = {v, v + 1, v + GRID_SIZE + 2, v + GRID_SIZE + 1};
+      mesh->add_subd_face(corners, 4, 0, true);
+    }
+  }
+
+  int corners[3] = {GRID_SIZE - 1, (int)verts.size() - 1, GRID_SIZE};
+  mesh->add_subd_face(corners, 3, 0, true);
+
+  mesh->set_subd_dicing_rate(dicing_rate);
+  mesh->add_face_normals();
+  mesh->add_vertex_normals();
+}
+
+static void tessellate(Mesh *mesh)
+{
+  DiagSplit split(*mesh->get_subd_params());
+  mesh->tessellate(&split);
+}
+
+static void expect_same_tessellation(Mesh *a, Mesh *b)
+{
+  ASSERT_EQ(a->get_verts().size(), b->get_verts().size());
+  ASSERT_EQ(a->get_triangles().size(), b->get_triangles().size());
+
+  for (size_t i = 0; i < a->get_verts().size(); i++) {
+    EXPECT_EQ(a->get_verts()[i], b->get_verts()[i]);
+  }
+  for (size_t i = 0; i < a->get_triangles().size(); i++) {
+    EXPECT_EQ(a->get_triangles()[i], b->get_triangles()[i]);
+  }
+}
+
+}  // namespace
+
+TEST(subd_dice, triangles)
+{
+  Mesh mesh;
+  create_cage(&mesh, 1.0f, 0.25f);
+  const size_t num_cage_verts = mesh.get_verts().size();
+  tessellate(&mesh);
+
+  ASSERT_GT(mesh.num_triangles(), 0u);
+  EXPECT_GT(mesh.get_verts().size(), num_cage_verts);
+
+  /* All triangles are set and reference diced vertices. */
+  for (size_t i = 0; i < mesh.num_triangles(); i++) {
+    Mesh::Triangle triangle = mesh.get_triangle(i);
+    for (int j = 0; j < 3; j++) {
+      EXPECT_GE(triangle.v[j], (int)num_cage_verts);
+      EXPECT_LT(triangle.v[j], (int)mesh.get_verts().size());
+    }
+    EXPECT_NE(triangle.v[0], triangle.v[1]);
+    EXPECT_NE(triangle.v[1], triangle.v[2]);
+    EXPECT_NE(triangle.v[2], triangle.v[0]);
+    EXPECT_GE(mesh.get_triangle_patch()[i], 0);
+  }
+
+  /* Diced vertices are only cached on request. */
+  EXPECT_EQ(mesh.get_subd_params()->cache, nullptr);
+}
+
+/* Tessellating again reads vertices from the cache, with the same result as without cache. */
+TEST(subd_dice, cache)
+{
+  Mesh mesh;
+  mesh.set_use_subd_dice_cache(true);
+  create_cage(&mesh, 1.0f, 0.25f);
+  tessellate(&mesh);
+  create_cage(&mesh, 1.0f, 0.25f);
+  tessellate(&mesh);
+
+  Mesh reference;
+  create_cage(&reference, 1.0f, 0.25f);
+  tessellate(&reference);
+
+  expect_same_tessellation(&mesh, &reference);
+
+  /* Vertices of unchanged patches come from the cache. */
+  SubdDiceCache *cache = mesh.get_subd_params()->cache;
+  ASSERT_NE(cache, nullptr);
+  ASSERT_FALSE(cache->patches.empty());
+  ASSERT_FALSE(cache->patches[0].P.empty());
+
+  const float3 marker = make_float3(-100.0f, -100.0f, -100.0f);
+  cache->patches[0].P[0] = marker;
+
+  create_cage(&mesh, 1.0f, 0.25f);
+  tessellate(&mesh);
+
+  bool found_marker = false;
+  for (size_t i = 0; i < mesh.get_verts().size(); i++) {
+    found_marker |= (mesh.get_verts()[i] == marker);
+  }
+  EXPECT_TRUE(found_marker);
+}
+
+/* Changes to the control mesh or the dicing rate are not hidden by the cache. */
+TEST(subd_dice, cache_invalidate)
+{
+  Mesh mesh;
+  mesh.set_use_subd_dice_cache(true);
+  create_cage(&mesh, 1.0f, 0.25f);
+  tessellate(&mesh);
+
+  create_cage(&mesh, 2.0f, 0.25f);
+  tessellate(&mesh);
+
+  Mesh reference;
+  create_cage(&reference, 2.0f, 0.25f);
+  tessellate(&reference);
+
+  expect_same_tessellation(&mesh, &reference);
+
+  create_cage(&mesh, 2.0f, 0.5f);
+  tessellate(&mesh);
+  create_cage(&reference, 2.0f, 0.5f);
+  tessellate(&reference);
+
+  expect_same_tessellation(&mesh, &reference);
+}
+
+CCL_NAMESPACE_END
@@ -45,4 +45,33 @@ size_t util_guarded_get_mem_peak()
   return global_stats.mem_peak;
 }
 
+GuardedMemTag::GuardedMemTag(Type type)
+{
+#ifdef WITH_BLENDER_GUARDEDALLOC
+  eMEM_Tag tag = MEM_TAG_NONE;
+  switch (type) {
+    case BVH:
+      tag = MEM_TAG_BVH;
+      break;
+    case IMAGE:
+      tag = MEM_TAG_IMAGE;
+      break;
+    case RENDER:
+      tag = MEM_TAG_RENDER;
+      break;
+  }
+  prev_tag = MEM_tag_set(tag);
+#else
+  (void)type;
+  prev_tag = 0;
+#endif
+}
+
+GuardedMemTag::~GuardedMemTag()
+{
+#ifdef WITH_BLENDER_GUARDEDALLOC
+  MEM_tag_set((eMEM_Tag)prev_tag);
+#endif
+}
+
 CCL_NAMESPACE_END
@@ -160,6 +160,27 @@ template<typename T> class GuardedAllocator {
 size_t util_guarded_get_mem_used();
 size_t util_guarded_get_mem_peak();
 
+/* Tag the memory allocated by the current thread in the memory statistics of Blender while in
+ * scope, does nothing without Blender's allocator. Allocations on other threads, like worker
+ * threads of the BVH build, are not tagged. */
+class GuardedMemTag {
+ public:
+  enum Type {
+    BVH,
+    IMAGE,
+    RENDER,
+  };
+
+  explicit GuardedMemTag(Type type);
+  ~GuardedMemTag();
+
+  GuardedMemTag(const GuardedMemTag &) = delete;
+  GuardedMemTag &operator=(const GuardedMemTag &) = delete;
+
+ private:
+  int prev_tag;
+};
+
 /* Call given function and keep track if it runs out of memory.
  *
  * If it does run out f memory, stop execution and set progress
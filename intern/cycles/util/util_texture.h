@@ -59,6 +59,7 @@ typedef enum ImageDataType {
   IMAGE_DATA_TYPE_USHORT = 7,
   IMAGE_DATA_TYPE_NANOVDB_FLOAT = 8,
   IMAGE_DATA_TYPE_NANOVDB_FLOAT3 = 9,
+  IMAGE_DATA_TYPE_CACHE = 10,
 
   IMAGE_DATA_NUM_TYPES
 } ImageDataType;
@@ -108,6 +109,21 @@ typedef struct TextureInfo {
   Transform transform_3d;
 } TextureInfo;
 
+#ifndef __KERNEL_GPU__
+/* Image that is paged in on demand by the texture cache on the host, instead of being stored
+ * in memory. The texture data of IMAGE_DATA_TYPE_CACHE is a pointer to it, CPU only. */
+class ImageCacheTexture {
+ public:
+  virtual ~ImageCacheTexture()
+  {
+  }
+
+  /* Filtered lookup, with the derivatives of the texture coordinates to select the resolution.
+   * Zero derivatives select the highest resolution. */
+  virtual float4 lookup(float x, float y, float2 dx, float2 dy) const = 0;
+};
+#endif
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_TEXTURE_H__ */
@@ -244,6 +244,30 @@ void MEM_use_lockfree_allocator(void);
  * NOTE: The switch between allocator types can only happen before any allocation did happen. */
 void MEM_use_guarded_allocator(void);
 
+/* Memory tags, to see which subsystem memory is used by.
+ *
+ * Blocks get the tag which is active in the allocating thread, reallocated and duplicated blocks
+ * keep the tag of the original block. Only tracked by the lock-free allocator, untagged memory
+ * and the guarded allocator count as MEM_TAG_NONE. */
+typedef enum eMEM_Tag {
+  MEM_TAG_NONE = 0,
+  MEM_TAG_MESH,
+  MEM_TAG_BVH,
+  MEM_TAG_IMAGE,
+  MEM_TAG_RENDER,
+  MEM_TAG_UNDO,
+} eMEM_Tag;
+
+#define MEM_TAG_LEN (MEM_TAG_UNDO + 1)
+
+/* Set the tag of new blocks allocated by the calling thread, returning the previous tag which
+ * should be restored after the tagged allocations. */
+eMEM_Tag MEM_tag_set(eMEM_Tag tag);
+const char *MEM_tag_name(eMEM_Tag tag);
+size_t MEM_tag_get_memory_in_use(eMEM_Tag tag);
+/* Peak memory is not tracked for MEM_TAG_NONE. */
+size_t MEM_tag_get_peak_memory(eMEM_Tag tag);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
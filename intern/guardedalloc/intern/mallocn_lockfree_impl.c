@@ -47,6 +47,20 @@ static unsigned int totblock = 0;
 static size_t mem_in_use = 0, peak_mem = 0;
 static bool malloc_debug_memset = false;
 
+/* Memory in use and peak per tag, MEM_TAG_NONE is not counted. */
+static size_t tag_mem_in_use[MEM_TAG_LEN] = {0};
+static size_t tag_peak_mem[MEM_TAG_LEN] = {0};
+static MEM_THREAD_LOCAL eMEM_Tag tag_current = MEM_TAG_NONE;
+
+static const char *tag_names[MEM_TAG_LEN] = {
+    [MEM_TAG_NONE] = "Other",
+    [MEM_TAG_MESH] = "Mesh",
+    [MEM_TAG_BVH] = "BVH",
+    [MEM_TAG_IMAGE] = "Image",
+    [MEM_TAG_RENDER] = "Render",
+    [MEM_TAG_UNDO] = "Undo",
+};
+
 static void (*error_callback)(const char *) = NULL;
 
 enum {
@@ -58,6 +72,19 @@ enum {
 #define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
 #define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
 
+/* The tag is stored in the highest bits of the length, only when those are unused. */
+#if defined(__LP64__) || defined(_WIN64)
+#  define USE_MEMHEAD_TAG
+#  define MEMHEAD_TAG_SHIFT 56
+#  define MEMHEAD_TAG_BITS ((size_t)0xff << MEMHEAD_TAG_SHIFT)
+#  define MEMHEAD_TAG(memhead) ((eMEM_Tag)((memhead)->len >> MEMHEAD_TAG_SHIFT))
+#  define MEMHEAD_TAG_CURRENT_BITS() ((size_t)tag_current << MEMHEAD_TAG_SHIFT)
+#else
+#  define MEMHEAD_TAG_BITS ((size_t)0)
+#  define MEMHEAD_TAG(memhead) MEM_TAG_NONE
+#  define MEMHEAD_TAG_CURRENT_BITS() ((size_t)0)
+#endif
+
 /* Uncomment this to have proper peak counter. */
 #define USE_ATOMIC_MAX
 
@@ -89,10 +116,26 @@ print_error(const char *str, ...)
   }
 }
 
+MEM_INLINE void tag_count_alloc(size_t len)
+{
+  const eMEM_Tag tag = tag_current;
+  if (tag != MEM_TAG_NONE) {
+    update_maximum(&tag_peak_mem[tag], atomic_add_and_fetch_z(&tag_mem_in_use[tag], len));
+  }
+}
+
+MEM_INLINE void tag_count_free(eMEM_Tag tag, size_t len)
+{
+  if (tag != MEM_TAG_NONE) {
+    atomic_sub_and_fetch_z(&tag_mem_in_use[tag], len);
+  }
+}
+
 size_t MEM_lockfree_allocN_len(const void *vmemh)
 {
   if (vmemh) {
-    return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t)(MEMHEAD_ALIGN_FLAG));
+    return MEMHEAD_FROM_PTR(vmemh)->len &
+           ~((size_t)MEMHEAD_ALIGN_FLAG | MEMHEAD_TAG_BITS);
   }
 
   return 0;
@@ -117,6 +160,7 @@ void MEM_lockfree_freeN(void *vmemh)
 
   atomic_sub_and_fetch_u(&totblock, 1);
   atomic_sub_and_fetch_z(&mem_in_use, len);
+  tag_count_free(MEMHEAD_TAG(memh), len);
 
   if (UNLIKELY(malloc_debug_memset && len)) {
     memset(memh + 1, 255, len);
@@ -136,6 +180,7 @@ void *MEM_lockfree_dupallocN(const void *vmemh)
   if (vmemh) {
     MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
     const size_t prev_size = MEM_lockfree_allocN_len(vmemh);
+    const eMEM_Tag tag_prev = MEM_tag_set(MEMHEAD_TAG(memh));
     if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
       MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
       newp = MEM_lockfree_mallocN_aligned(
@@ -144,6 +189,7 @@ void *MEM_lockfree_dupallocN(const void *vmemh)
     else {
       newp = MEM_lockfree_mallocN(prev_size, "dupli_malloc");
     }
+    MEM_tag_set(tag_prev);
     memcpy(newp, vmemh, prev_size);
   }
   return newp;
@@ -156,6 +202,7 @@ void *MEM_lockfree_reallocN_id(void *vmemh, size_t len, const char *str)
   if (vmemh) {
     MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
     size_t old_len = MEM_lockfree_allocN_len(vmemh);
+    const eMEM_Tag tag_prev = MEM_tag_set(MEMHEAD_TAG(memh));
 
     if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
       newp = MEM_lockfree_mallocN(len, "realloc");
@@ -164,6 +211,7 @@ void *MEM_lockfree_reallocN_id(void *vmemh, size_t len, const char *str)
       MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
       newp = MEM_lockfree_mallocN_aligned(len, (size_t)memh_aligned->alignment, "realloc");
     }
+    MEM_tag_set(tag_prev);
 
     if (newp) {
       if (len < old_len) {
@@ -192,6 +240,7 @@ void *MEM_lockfree_recallocN_id(void *vmemh, size_t len, const char *str)
   if (vmemh) {
     MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
     size_t old_len = MEM_lockfree_allocN_len(vmemh);
+    const eMEM_Tag tag_prev = MEM_tag_set(MEMHEAD_TAG(memh));
 
     if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
       newp = MEM_lockfree_mallocN(len, "recalloc");
@@ -200,6 +249,7 @@ void *MEM_lockfree_recallocN_id(void *vmemh, size_t len, const char *str)
       MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
       newp = MEM_lockfree_mallocN_aligned(len, (size_t)memh_aligned->alignment, "recalloc");
     }
+    MEM_tag_set(tag_prev);
 
     if (newp) {
       if (len < old_len) {
@@ -235,10 +285,11 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
   memh = (MemHead *)calloc(1, len + sizeof(MemHead));
 
   if (LIKELY(memh)) {
-    memh->len = len;
+    memh->len = len | MEMHEAD_TAG_CURRENT_BITS();
     atomic_add_and_fetch_u(&totblock, 1);
     atomic_add_and_fetch_z(&mem_in_use, len);
     update_maximum(&peak_mem, mem_in_use);
+    tag_count_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
@@ -280,10 +331,11 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
       memset(memh + 1, 255, len);
     }
 
-    memh->len = len;
+    memh->len = len | MEMHEAD_TAG_CURRENT_BITS();
     atomic_add_and_fetch_u(&totblock, 1);
     atomic_add_and_fetch_z(&mem_in_use, len);
     update_maximum(&peak_mem, mem_in_use);
+    tag_count_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
@@ -350,11 +402,12 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
       memset(memh + 1, 255, len);
     }
 
-    memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG;
+    memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG | MEMHEAD_TAG_CURRENT_BITS();
     memh->alignment = (short)alignment;
     atomic_add_and_fetch_u(&totblock, 1);
     atomic_add_and_fetch_z(&mem_in_use, len);
     update_maximum(&peak_mem, mem_in_use);
+    tag_count_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
@@ -383,6 +436,15 @@ void MEM_lockfree_printmemlist_stats(void)
 {
   printf("\ntotal memory len: %.3f MB\n", (double)mem_in_use / (double)(1024 * 1024));
   printf("peak memory len: %.3f MB\n", (double)peak_mem / (double)(1024 * 1024));
+  for (int tag = 0; tag < MEM_TAG_LEN; tag++) {
+    printf("%s memory len: %.3f MB",
+           MEM_tag_name((eMEM_Tag)tag),
+           (double)MEM_tag_get_memory_in_use((eMEM_Tag)tag) / (double)(1024 * 1024));
+    if (tag != MEM_TAG_NONE) {
+      printf(", peak %.3f MB", (double)tag_peak_mem[tag] / (double)(1024 * 1024));
+    }
+    printf("\n");
+  }
   printf(
       "\nFor more detailed per-block statistics run Blender with memory debugging command line "
       "argument.\n");
@@ -422,6 +484,9 @@ unsigned int MEM_lockfree_get_memory_blocks_in_use(void)
 void MEM_lockfree_reset_peak_memory(void)
 {
   peak_mem = mem_in_use;
+  for (int tag = 0; tag < MEM_TAG_LEN; tag++) {
+    tag_peak_mem[tag] = tag_mem_in_use[tag];
+  }
 }
 
 size_t MEM_lockfree_get_peak_memory(void)
@@ -429,6 +494,44 @@ size_t MEM_lockfree_get_peak_memory(void)
   return peak_mem;
 }
 
+/* -------------------------------------------------------------------- */
+/* Memory tags. */
+
+eMEM_Tag MEM_tag_set(eMEM_Tag tag)
+{
+  const eMEM_Tag tag_prev = tag_current;
+#ifdef USE_MEMHEAD_TAG
+  tag_current = tag;
+#else
+  (void)tag;
+#endif
+  return tag_prev;
+}
+
+const char *MEM_tag_name(eMEM_Tag tag)
+{
+  return tag_names[tag];
+}
+
+size_t MEM_tag_get_memory_in_use(eMEM_Tag tag)
+{
+  if (tag != MEM_TAG_NONE) {
+    return tag_mem_in_use[tag];
+  }
+
+  size_t mem_tagged = 0;
+  for (int i = MEM_TAG_NONE + 1; i < MEM_TAG_LEN; i++) {
+    mem_tagged += tag_mem_in_use[i];
+  }
+  const size_t mem_total = MEM_get_memory_in_use();
+  return (mem_total > mem_tagged) ? mem_total - mem_tagged : 0;
+}
+
+size_t MEM_tag_get_peak_memory(eMEM_Tag tag)
+{
+  return tag_peak_mem[tag];
+}
+
 #ifndef NDEBUG
 const char *MEM_lockfree_name_ptr(void *vmemh)
 {
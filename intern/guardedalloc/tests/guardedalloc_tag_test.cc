@@ -0,0 +1,92 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <thread>
+
+#include "BLI_utildefines.h"
+
+#include "MEM_guardedalloc.h"
+#include "guardedalloc_test_base.h"
+
+namespace {
+
+void DoBasicTagChecks()
+{
+  const size_t mem_in_use = MEM_tag_get_memory_in_use(MEM_TAG_BVH);
+  const size_t mem_in_use_none = MEM_tag_get_memory_in_use(MEM_TAG_NONE);
+
+  const eMEM_Tag tag_prev = MEM_tag_set(MEM_TAG_BVH);
+  void *foo = MEM_mallocN(100, "test");
+  void *bar = MEM_callocN(2000, "test");
+  void *baz = MEM_mallocN_aligned(200, 64, "test");
+  EXPECT_EQ(MEM_tag_set(tag_prev), MEM_TAG_BVH);
+
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_BVH), mem_in_use + 2300);
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_NONE), mem_in_use_none);
+  EXPECT_GE(MEM_tag_get_peak_memory(MEM_TAG_BVH), mem_in_use + 2300);
+
+  /* Reallocated and duplicated blocks keep their tag. */
+  foo = MEM_reallocN(foo, 400);
+  bar = MEM_recallocN(bar, 1000);
+  void *qux = MEM_dupallocN(baz);
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_BVH), mem_in_use + 1800);
+
+  /* Untagged blocks. */
+  void *untagged = MEM_mallocN(500, "test");
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_BVH), mem_in_use + 1800);
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_NONE), mem_in_use_none + 500);
+  EXPECT_EQ(MEM_allocN_len(foo), 400u);
+  EXPECT_EQ(MEM_allocN_len(baz), 200u);
+
+  MEM_freeN(foo);
+  MEM_freeN(bar);
+  MEM_freeN(baz);
+  MEM_freeN(qux);
+  MEM_freeN(untagged);
+
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_BVH), mem_in_use);
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_NONE), mem_in_use_none);
+}
+
+}  // namespace
+
+TEST_F(LockFreeAllocatorTest, MEM_tag)
+{
+  DoBasicTagChecks();
+}
+
+/* The tag is set per thread. */
+TEST_F(LockFreeAllocatorTest, MEM_tag_threads)
+{
+  const size_t mem_in_use = MEM_tag_get_memory_in_use(MEM_TAG_IMAGE);
+
+  const eMEM_Tag tag_prev = MEM_tag_set(MEM_TAG_IMAGE);
+  void *foo = MEM_mallocN(100, "test");
+  void *bar = nullptr;
+  std::thread thread([&bar]() { bar = MEM_mallocN(1000, "test"); });
+  thread.join();
+  MEM_tag_set(tag_prev);
+
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_IMAGE), mem_in_use + 100);
+
+  /* Blocks can be freed by any thread. */
+  std::thread free_thread([&foo]() { MEM_freeN(foo); });
+  free_thread.join();
+  MEM_freeN(bar);
+
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_IMAGE), mem_in_use);
+}
+
+/* The guarded allocator doesn't track tags, all memory counts as untagged. */
+TEST_F(GuardedAllocatorTest, MEM_tag)
+{
+  const eMEM_Tag tag_prev = MEM_tag_set(MEM_TAG_MESH);
+  void *foo = MEM_mallocN(100, "test");
+  MEM_tag_set(tag_prev);
+
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_MESH), 0u);
+  EXPECT_EQ(MEM_tag_get_memory_in_use(MEM_TAG_NONE), MEM_get_memory_in_use());
+
+  MEM_freeN(foo);
+}
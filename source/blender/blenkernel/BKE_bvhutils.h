@@ -258,6 +258,8 @@ float bvhtree_sphereray_tri_intersection(const BVHTreeRay *ray,
 bool bvhcache_has_tree(const struct BVHCache *bvh_cache, const BVHTree *tree);
 struct BVHCache *bvhcache_init(void);
 void bvhcache_free(struct BVHCache *bvh_cache);
+void bvhcache_shared_clear_unused(void);
+void bvhcache_shared_exit(void);
 
 #ifdef __cplusplus
 }
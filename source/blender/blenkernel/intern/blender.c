@@ -42,6 +42,7 @@
 #include "BKE_blender_version.h" /* own include */
 #include "BKE_blendfile.h"
 #include "BKE_brush.h"
+#include "BKE_bvhutils.h"
 #include "BKE_cachefile.h"
 #include "BKE_callbacks.h"
 #include "BKE_global.h"
@@ -91,6 +92,7 @@ void BKE_blender_free(void)
   IMB_exit();
   BKE_cachefiles_exit();
   BKE_images_exit();
+  bvhcache_shared_exit();
   DEG_free_node_types();
 
   BKE_brush_system_exit();
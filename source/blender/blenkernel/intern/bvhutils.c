@@ -28,7 +28,10 @@
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
+#include "BLI_ghash.h"
+#include "BLI_hash_stripe.h"
 #include "BLI_linklist.h"
+#include "BLI_listbase.h"
 #include "BLI_math.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
@@ -47,6 +50,8 @@
 typedef struct BVHCacheItem {
   bool is_filled;
   BVHTree *tree;
+  /** Set when the tree is shared with other meshes, see #BVHSharedTree. */
+  struct BVHSharedTree *shared;
 } BVHCacheItem;
 
 typedef struct BVHCache {
@@ -145,6 +150,8 @@ static void bvhcache_insert(BVHCache *bvh_cache, BVHTree *tree, BVHCacheType typ
   item->is_filled = true;
 }
 
+static void bvhcache_shared_release(struct BVHSharedTree *shared);
+
 /**
  * frees a bvhcache
  */
@@ -152,13 +159,260 @@ void bvhcache_free(BVHCache *bvh_cache)
 {
   for (BVHCacheType index = 0; index < BVHTREE_MAX_ITEM; index++) {
     BVHCacheItem *item = &bvh_cache->items[index];
-    BLI_bvhtree_free(item->tree);
+    if (item->shared) {
+      bvhcache_shared_release(item->shared);
+      item->shared = NULL;
+    }
+    else {
+      BLI_bvhtree_free(item->tree);
+    }
     item->tree = NULL;
   }
   BLI_mutex_end(&bvh_cache->mutex);
   MEM_freeN(bvh_cache);
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Shared BVHCache Trees
+ *
+ * Trees built by #BKE_bvhtree_from_mesh_get are also stored by a hash of the mesh data they are
+ * built from, so meshes with the same geometry use a single tree. This avoids rebuilding trees
+ * for copies made by the depsgraph, for re-evaluations that don't change the geometry and for
+ * different objects using the same mesh, e.g. shrink-wrap targets.
+ *
+ * Trees are reference counted by the #BVHCache of the meshes using them. Recently used trees
+ * without users are kept up to a memory limit, as evaluated meshes are freed before they are
+ * evaluated again. They are freed when loading a file.
+ * \{ */
+
+/* Memory of the trees without users kept for later evaluations. */
+#define BVHCACHE_SHARED_UNUSED_MAX_SIZE (64 * 1024 * 1024)
+
+typedef struct BVHSharedKey {
+  /* 64 bit hash of the mesh data, making collisions negligible. */
+  uint64_t hash;
+  BVHCacheType type;
+  int tree_type;
+} BVHSharedKey;
+
+typedef struct BVHSharedTree {
+  struct BVHSharedTree *next, *prev;
+  BVHSharedKey key;
+  BVHTree *tree;
+  size_t size;
+  int users;
+} BVHSharedTree;
+
+static struct {
+  /** #BVHSharedKey -> #BVHSharedTree. */
+  GHash *trees;
+  /** Trees without users, least recently used first. */
+  ListBase unused;
+  size_t unused_size;
+  ThreadMutex mutex;
+} bvhcache_shared = {NULL, {NULL, NULL}, 0, BLI_MUTEX_INITIALIZER};
+
+static uint bvhcache_shared_key_hash(const void *key_v)
+{
+  const BVHSharedKey *key = key_v;
+  return (uint)(key->hash ^ (key->hash >> 32));
+}
+
+static bool bvhcache_shared_key_cmp(const void *key_a_v, const void *key_b_v)
+{
+  return memcmp(key_a_v, key_b_v, sizeof(BVHSharedKey)) != 0;
+}
+
+static void bvhcache_shared_hash_array(BLI_HashStripe *state,
+                                       const void *data,
+                                       const size_t elem_size,
+                                       const int len)
+{
+  /* The length separates the arrays, so data can't move from one array to the next. */
+  BLI_hash_stripe_add(state, &len, sizeof(len));
+  BLI_hash_stripe_add(state, data, elem_size * (size_t)len);
+}
+
+/**
+ * Hash the mesh data that the tree of the given type is built from, in a single pass.
+ */
+static void bvhcache_shared_key_from_mesh(const Mesh *mesh,
+                                          const BVHCacheType type,
+                                          const int tree_type,
+                                          BVHSharedKey *r_key)
+{
+  memset(r_key, 0, sizeof(*r_key));
+  r_key->type = type;
+  r_key->tree_type = tree_type;
+
+  BLI_HashStripe state;
+  BLI_hash_stripe_init(&state, 0);
+
+  bvhcache_shared_hash_array(&state, mesh->mvert, sizeof(*mesh->mvert), mesh->totvert);
+
+  switch (type) {
+    case BVHTREE_FROM_VERTS:
+      break;
+    case BVHTREE_FROM_LOOSEVERTS:
+    case BVHTREE_FROM_EDGES:
+    case BVHTREE_FROM_LOOSEEDGES:
+      bvhcache_shared_hash_array(&state, mesh->medge, sizeof(*mesh->medge), mesh->totedge);
+      break;
+    case BVHTREE_FROM_FACES:
+      bvhcache_shared_hash_array(&state, mesh->mface, sizeof(*mesh->mface), mesh->totface);
+      break;
+    case BVHTREE_FROM_LOOPTRI:
+    case BVHTREE_FROM_LOOPTRI_NO_HIDDEN:
+      /* Polygons define the triangulation and hidden state of the loop triangles. */
+      bvhcache_shared_hash_array(&state, mesh->mloop, sizeof(*mesh->mloop), mesh->totloop);
+      bvhcache_shared_hash_array(&state, mesh->mpoly, sizeof(*mesh->mpoly), mesh->totpoly);
+      break;
+    case BVHTREE_FROM_EM_VERTS:
+    case BVHTREE_FROM_EM_EDGES:
+    case BVHTREE_FROM_EM_LOOPTRI:
+    case BVHTREE_MAX_ITEM:
+      BLI_assert(false);
+      break;
+  }
+
+  r_key->hash = BLI_hash_stripe_end(&state);
+}
+
+static BVHSharedTree *bvhcache_shared_acquire(const BVHSharedKey *key)
+{
+  BLI_mutex_lock(&bvhcache_shared.mutex);
+  BVHSharedTree *shared = NULL;
+  if (bvhcache_shared.trees) {
+    shared = BLI_ghash_lookup(bvhcache_shared.trees, key);
+  }
+  if (shared && shared->users++ == 0) {
+    BLI_remlink(&bvhcache_shared.unused, shared);
+    bvhcache_shared.unused_size -= shared->size;
+  }
+  BLI_mutex_unlock(&bvhcache_shared.mutex);
+  return shared;
+}
+
+static void bvhcache_shared_tree_free(void *shared_v)
+{
+  BVHSharedTree *shared = shared_v;
+  BLI_bvhtree_free(shared->tree);
+  MEM_freeN(shared);
+}
+
+static void bvhcache_shared_release(BVHSharedTree *shared)
+{
+  BLI_mutex_lock(&bvhcache_shared.mutex);
+  BLI_assert(shared->users > 0);
+  if (--shared->users == 0) {
+    BLI_addtail(&bvhcache_shared.unused, shared);
+    bvhcache_shared.unused_size += shared->size;
+
+    /* Free the least recently used trees, possibly including this one if it is too large. */
+    while (bvhcache_shared.unused_size > BVHCACHE_SHARED_UNUSED_MAX_SIZE) {
+      BVHSharedTree *oldest = bvhcache_shared.unused.first;
+      BLI_remlink(&bvhcache_shared.unused, oldest);
+      bvhcache_shared.unused_size -= oldest->size;
+      BLI_ghash_remove(bvhcache_shared.trees, &oldest->key, NULL, bvhcache_shared_tree_free);
+    }
+  }
+  BLI_mutex_unlock(&bvhcache_shared.mutex);
+}
+
+/**
+ * Fill the cache of a mesh with a shared tree built for the same geometry.
+ */
+static bool bvhcache_find_shared(BVHCache **bvh_cache_p,
+                                 const BVHCacheType type,
+                                 const BVHSharedKey *key,
+                                 BVHTree **r_tree,
+                                 ThreadMutex *mesh_eval_mutex)
+{
+  BVHSharedTree *shared = bvhcache_shared_acquire(key);
+  if (shared == NULL) {
+    return false;
+  }
+
+  bool lock_started = false;
+  if (bvhcache_find(bvh_cache_p, type, r_tree, &lock_started, mesh_eval_mutex)) {
+    /* Cached by another thread in the meantime. */
+    bvhcache_shared_release(shared);
+    return true;
+  }
+
+  BVHCache *bvh_cache = *bvh_cache_p;
+  bvh_cache->items[type].shared = shared;
+  bvhcache_insert(bvh_cache, shared->tree, type);
+  *r_tree = shared->tree;
+  bvhcache_unlock(bvh_cache, lock_started);
+  return true;
+}
+
+/**
+ * Share the cached tree of a mesh with other meshes,
+ * unless a tree for the same geometry is shared already.
+ */
+static void bvhcache_insert_shared(BVHCache *bvh_cache,
+                                   const BVHCacheType type,
+                                   const BVHSharedKey *key)
+{
+  BLI_mutex_lock(&bvh_cache->mutex);
+  BVHCacheItem *item = &bvh_cache->items[type];
+
+  if (item->is_filled && item->tree && item->shared == NULL) {
+    BLI_mutex_lock(&bvhcache_shared.mutex);
+    if (bvhcache_shared.trees == NULL) {
+      bvhcache_shared.trees = BLI_ghash_new(
+          bvhcache_shared_key_hash, bvhcache_shared_key_cmp, __func__);
+    }
+    if (BLI_ghash_lookup(bvhcache_shared.trees, key) == NULL) {
+      BVHSharedTree *shared = MEM_callocN(sizeof(*shared), __func__);
+      shared->key = *key;
+      shared->tree = item->tree;
+      shared->size = BLI_bvhtree_get_memory_size(item->tree);
+      shared->users = 1;
+      BLI_ghash_insert(bvhcache_shared.trees, &shared->key, shared);
+      item->shared = shared;
+    }
+    BLI_mutex_unlock(&bvhcache_shared.mutex);
+  }
+
+  BLI_mutex_unlock(&bvh_cache->mutex);
+}
+
+/**
+ * Free the shared trees without users, e.g. after loading a file, since they are unlikely to be
+ * used for the meshes of a different file.
+ */
+void bvhcache_shared_clear_unused(void)
+{
+  BLI_mutex_lock(&bvhcache_shared.mutex);
+  LISTBASE_FOREACH_MUTABLE (BVHSharedTree *, shared, &bvhcache_shared.unused) {
+    BLI_ghash_remove(bvhcache_shared.trees, &shared->key, NULL, bvhcache_shared_tree_free);
+  }
+  BLI_listbase_clear(&bvhcache_shared.unused);
+  bvhcache_shared.unused_size = 0;
+  BLI_mutex_unlock(&bvhcache_shared.mutex);
+}
+
+/**
+ * Free the shared trees, only to be called on exit, once all meshes are freed.
+ */
+void bvhcache_shared_exit(void)
+{
+  bvhcache_shared_clear_unused();
+
+  BLI_mutex_lock(&bvhcache_shared.mutex);
+  if (bvhcache_shared.trees) {
+    BLI_assert(BLI_ghash_len(bvhcache_shared.trees) == 0);
+    BLI_ghash_free(bvhcache_shared.trees, NULL, bvhcache_shared_tree_free);
+    bvhcache_shared.trees = NULL;
+  }
+  BLI_mutex_unlock(&bvhcache_shared.mutex);
+}
+
 /** \} */
 /* -------------------------------------------------------------------- */
 /** \name Local Callbacks
@@ -1420,6 +1674,15 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
 
   bool is_cached = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, NULL, NULL);
 
+  /* Use the tree of a mesh with the same geometry, or share the one built here. */
+  BVHSharedKey shared_key;
+  const bool use_shared = !is_cached;
+  if (use_shared) {
+    bvhcache_shared_key_from_mesh(mesh, bvh_cache_type, tree_type, &shared_key);
+    is_cached = bvhcache_find_shared(
+        bvh_cache_p, bvh_cache_type, &shared_key, &tree, mesh_eval_mutex);
+  }
+
   if (is_cached && tree == NULL) {
     memset(data, 0, sizeof(*data));
     return tree;
@@ -1579,6 +1842,10 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
     }
 #endif
     BLI_assert(data->cached);
+
+    if (use_shared && !is_cached) {
+      bvhcache_insert_shared(*bvh_cache_p, bvh_cache_type, &shared_key);
+    }
   }
   else {
     free_bvhtree_from_mesh(data);
@@ -2518,12 +2518,14 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
     newlayerdata = layerdata;
   }
   else if (totelem > 0 && typeInfo->size > 0) {
+    const eMEM_Tag tag_prev = MEM_tag_set(MEM_TAG_MESH);
     if (alloctype == CD_DUPLICATE && layerdata) {
       newlayerdata = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, layerType_getName(type));
     }
     else {
       newlayerdata = MEM_calloc_arrayN((size_t)totelem, typeInfo->size, layerType_getName(type));
     }
+    MEM_tag_set(tag_prev);
 
     if (!newlayerdata) {
       return NULL;
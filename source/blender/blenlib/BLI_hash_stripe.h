@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Fast 64 and 128 bit non-cryptographic hash for large buffers, to fingerprint the content of
+ * arrays, images or undo data. Data can be added in pieces, the result only depends on the
+ * concatenated data and the seed.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLI_HASH_STRIPE_ACC_LEN 8
+#define BLI_HASH_STRIPE_SECRET_LEN 24
+#define BLI_HASH_STRIPE_LEN 64
+
+typedef struct BLI_HashStripe {
+  uint64_t acc[BLI_HASH_STRIPE_ACC_LEN];
+  /** Keys mixed into the data, derived from the seed. */
+  uint64_t secret[BLI_HASH_STRIPE_SECRET_LEN];
+  /** Data that doesn't fill a complete stripe yet. */
+  unsigned char buffer[BLI_HASH_STRIPE_LEN];
+  uint64_t total_len;
+  uint32_t buffer_len;
+  /** Number of stripes accumulated in the current block. */
+  uint32_t stripe_index;
+} BLI_HashStripe;
+
+void BLI_hash_stripe_init(BLI_HashStripe *state, uint64_t seed);
+
+void BLI_hash_stripe_add(BLI_HashStripe *state, const void *data, size_t len);
+
+/* The state is not modified, more data can still be added afterwards. */
+uint64_t BLI_hash_stripe_end(const BLI_HashStripe *state);
+
+void BLI_hash_stripe_end_128(const BLI_HashStripe *state, uint64_t r_hash[2]);
+
+uint64_t BLI_hash_stripe(const void *data, size_t len, uint64_t seed);
+
+void BLI_hash_stripe_128(const void *data, size_t len, uint64_t seed, uint64_t r_hash[2]);
+
+#ifdef __cplusplus
+}
+#endif
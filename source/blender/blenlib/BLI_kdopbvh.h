@@ -177,6 +177,7 @@ int *BLI_bvhtree_intersect_plane(BVHTree *tree, float plane[4], uint *r_intersec
 
 int BLI_bvhtree_get_len(const BVHTree *tree);
 int BLI_bvhtree_get_tree_type(const BVHTree *tree);
+size_t BLI_bvhtree_get_memory_size(const BVHTree *tree);
 float BLI_bvhtree_get_epsilon(const BVHTree *tree);
 void BLI_bvhtree_get_bounding_box(BVHTree *tree, float r_bb_min[3], float r_bb_max[3]);
 
@@ -194,6 +195,12 @@ int BLI_bvhtree_find_nearest(BVHTree *tree,
                              BVHTreeNearest *nearest,
                              BVHTree_NearestPointCallback callback,
                              void *userdata);
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    int co_len,
+                                    BVHTreeNearest *nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata);
 
 int BLI_bvhtree_find_nearest_first(BVHTree *tree,
                                    const float co[3],
@@ -232,6 +239,15 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
                               float hit_dist,
                               BVHTree_RayCastCallback callback,
                               void *userdata);
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*co)[3],
+                                const float (*dir)[3],
+                                int rays_len,
+                                float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag);
 
 float BLI_bvhtree_bb_raycast(const float bv[6],
                              const float light_start[3],
@@ -25,6 +25,10 @@
 
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* glibc 2.8+ */
 #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 8))
 #  define BLI_qsort_r qsort_r
@@ -33,8 +37,34 @@
 /* Quick sort re-entrant */
 typedef int (*BLI_sort_cmp_t)(const void *a, const void *b, void *ctx);
 
+/* C++ always gets the glibc declaration from `stdlib.h`. */
+#if !(defined(__cplusplus) && defined(BLI_qsort_r))
 void BLI_qsort_r(void *a, size_t n, size_t es, BLI_sort_cmp_t cmp, void *thunk)
-#ifdef __GNUC__
+#  ifdef __GNUC__
     __attribute__((nonnull(1, 5)))
+#  endif
+    ;
+#endif
+
+/* Parallel Sorting
+ *
+ * These sorts are stable, and use multiple threads for large arrays. They allocate a buffer of
+ * the size of the array. */
+
+/* Stable merge sort, the comparison function may be called from multiple threads at once. */
+void BLI_sort_merge_r(void *a, size_t n, size_t es, BLI_sort_cmp_t cmp, void *thunk)
+#ifdef __GNUC__
+    __attribute__((nonnull(1, 4)))
 #endif
     ;
+
+/* Radix sort, filling r_order with the indices of the keys in ascending order. Keys that are
+ * equal keep their original order. NaN floats sort outside of the infinities, on the side of
+ * their sign. */
+void BLI_sort_radix_order_uint(const unsigned int *keys, unsigned int len, unsigned int *r_order);
+void BLI_sort_radix_order_int(const int *keys, unsigned int len, unsigned int *r_order);
+void BLI_sort_radix_order_float(const float *keys, unsigned int len, unsigned int *r_order);
+
+#ifdef __cplusplus
+}
+#endif
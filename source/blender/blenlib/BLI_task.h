@@ -116,6 +116,26 @@ void *BLI_task_pool_user_data(TaskPool *pool);
 /* optional mutex to use from run function */
 ThreadMutex *BLI_task_pool_user_mutex(TaskPool *pool);
 
+/* Run func on the calling thread with the given priority. Task pools, task graphs and parallel
+ * loops used by func get at most this priority, so that background jobs don't take worker
+ * threads away from interactive work. */
+void BLI_task_scheduler_run_with_priority(TaskPriority priority,
+                                          void (*func)(void *userdata),
+                                          void *userdata);
+
+/* Task Profiling
+ *
+ * Optional callback that is called for every task of a task pool or task graph, with the times
+ * the task started and finished in seconds. It is called from the thread that ran the task, so
+ * it must be thread-safe. Only change it while no tasks are running. */
+
+typedef void (*TaskProfileFunction)(void *userdata,
+                                    TaskPriority priority,
+                                    double start_time,
+                                    double end_time);
+
+void BLI_task_scheduler_profile_set(TaskProfileFunction func, void *userdata);
+
 /* Parallel for routines */
 
 /* Per-thread specific data passed to the callback. */
@@ -252,7 +272,7 @@ int BLI_task_parallel_thread_id(const TaskParallelTLS *tls);
  *             v                  v
  *          [node_3]           [node_4]
  *
- *    TaskGraph *task_graph = BLI_task_graph_create();
+ *    TaskGraph *task_graph = BLI_task_graph_create(TASK_PRIORITY_HIGH);
  *    TaskNode *root = BLI_task_graph_node_create(task_graph, root_exec, NULL, NULL);
  *    TaskNode *node_1 = BLI_task_graph_node_create(task_graph, node_exec, NULL, NULL);
  *    TaskNode *node_2 = BLI_task_graph_node_create(task_graph, node_exec, NULL, NULL);
@@ -286,6 +306,9 @@ int BLI_task_parallel_thread_id(const TaskParallelTLS *tls);
  * Work can enter a tree on any node. Normally this would be the root_node.
  * A `task_graph` can be reused, but the caller needs to make sure the task_data is reset.
  *
+ * The priority of the graph applies to all its nodes. Use `TASK_PRIORITY_HIGH` for interactive
+ * work and `TASK_PRIORITY_LOW` for work that should not delay it.
+ *
  * ** Task-Data **
  *
  * Typically you want give a task data to work on.
@@ -306,7 +329,7 @@ struct TaskNode;
 typedef void (*TaskGraphNodeRunFunction)(void *__restrict task_data);
 typedef void (*TaskGraphNodeFreeFunction)(void *task_data);
 
-struct TaskGraph *BLI_task_graph_create(void);
+struct TaskGraph *BLI_task_graph_create(TaskPriority priority);
 void BLI_task_graph_work_and_wait(struct TaskGraph *task_graph);
 void BLI_task_graph_free(struct TaskGraph *task_graph);
 struct TaskNode *BLI_task_graph_node_create(struct TaskGraph *task_graph,
@@ -41,6 +41,8 @@
 #  endif
 #endif
 
+#include <utility>
+
 #include "BLI_index_range.hh"
 #include "BLI_utildefines.h"
 
@@ -75,4 +77,17 @@ void parallel_for(IndexRange range, int64_t grain_size, const Function &function
 #endif
 }
 
+/**
+ * Execute all of the given functions, which may run in parallel. Returns when all of them are
+ * done.
+ */
+template<typename... Functions> void parallel_invoke(Functions &&... functions)
+{
+#ifdef WITH_TBB
+  tbb::parallel_invoke(std::forward<Functions>(functions)...);
+#else
+  (functions(), ...);
+#endif
+}
+
 }  // namespace blender
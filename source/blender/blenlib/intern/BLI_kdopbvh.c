@@ -40,10 +40,13 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_alloca.h"
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -59,11 +62,19 @@
 /* Check tree is valid. */
 // #define USE_VERIFY_TREE
 
+/* Build trees with the surface area heuristic instead of the balanced implicit tree.
+ * Building is slower, but queries on unevenly distributed geometry are faster,
+ * disable to get the faster build back. */
+#define USE_SAH_BUILD
+
 #define MAX_TREETYPE 32
 
 /* Setting zero so we can catch bugs in BLI_task/KDOPBVH.
  * TODO(sergey): Deduplicate the limits with PBVH from BKE.
  */
+/* Number of rays or points traversed together by the batched queries. */
+#define BVH_PACKET_SIZE 4
+
 #ifdef DEBUG
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 0
 #else
@@ -863,6 +874,371 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Binned SAH Build
+ *
+ * Top-down build splitting the leafs of each branch with the surface area heuristic, evaluated
+ * over a fixed number of bins of the leaf centroids. Unlike the implicit tree the result isn't
+ * balanced: dense regions get deeper sub-trees and queries can skip empty space sooner.
+ *
+ * Sub-trees are built in parallel, branches are numbered breadth first afterwards so children
+ * still have a greater index than their parent, as #BLI_bvhtree_update_tree relies on.
+ * \{ */
+
+#ifdef USE_SAH_BUILD
+
+#  define BVH_SAH_BINS 16
+/* Depth after which leafs are split at the median, bounding the depth of degenerate trees. */
+#  define BVH_SAH_MAX_DEPTH 32
+
+typedef struct BVHSAHBranch {
+  int children_offset;
+  char totnode;
+  char main_axis;
+} BVHSAHBranch;
+
+typedef struct BVHSAHBuildData {
+  const BVHTree *tree;
+  BVHNode **leafs_array;
+  BVHSAHBranch *branches;
+  /* Children of all branches: a branch index, or `-(leaf position + 1)` for leafs. */
+  int *children;
+  uint branches_len;
+  uint children_len;
+  TaskPool *task_pool;
+} BVHSAHBuildData;
+
+typedef struct BVHSAHBuildTask {
+  int branch;
+  int begin, end;
+  int depth;
+} BVHSAHBuildTask;
+
+typedef struct BVHSAHBin {
+  float bv[6];
+  int count;
+} BVHSAHBin;
+
+static void sah_bounds_init(float bv[6])
+{
+  bv[0] = bv[2] = bv[4] = FLT_MAX;
+  bv[1] = bv[3] = bv[5] = -FLT_MAX;
+}
+
+static void sah_bounds_join(float bv[6], const float other[6])
+{
+  for (int i = 0; i < 6; i += 2) {
+    bv[i] = min_ff(bv[i], other[i]);
+    bv[i + 1] = max_ff(bv[i + 1], other[i + 1]);
+  }
+}
+
+/* Half the surface area, the factor doesn't matter when comparing costs. */
+static float sah_bounds_area(const float bv[6])
+{
+  const float x = bv[1] - bv[0];
+  const float y = bv[3] - bv[2];
+  const float z = bv[5] - bv[4];
+  return (x < 0.0f) ? 0.0f : (x * y + y * z + z * x);
+}
+
+BLI_INLINE float sah_centroid(const BVHNode *node, const int axis)
+{
+  return (node->bv[2 * axis] + node->bv[2 * axis + 1]) * 0.5f;
+}
+
+BLI_INLINE int sah_bin_index(const BVHNode *node,
+                             const int axis,
+                             const float centroid_min[3],
+                             const float bin_scale[3])
+{
+  const int bin = (int)((sah_centroid(node, axis) - centroid_min[axis]) * bin_scale[axis]);
+  return min_ii(bin, BVH_SAH_BINS - 1);
+}
+
+/**
+ * Split the leafs in the range [begin, end) in two, returning the first leaf of the second part.
+ * Leafs of the first part have the smaller centroids along \a r_axis.
+ */
+static int sah_split(
+    BVHNode **leafs_array, const int begin, const int end, const int depth, int *r_axis)
+{
+  float centroid_min[3], centroid_max[3];
+  INIT_MINMAX(centroid_min, centroid_max);
+  for (int i = begin; i < end; i++) {
+    const float centroid[3] = {sah_centroid(leafs_array[i], 0),
+                               sah_centroid(leafs_array[i], 1),
+                               sah_centroid(leafs_array[i], 2)};
+    minmax_v3v3_v3(centroid_min, centroid_max, centroid);
+  }
+
+  float extent[3], bin_scale[3];
+  bool use_axis[3];
+  int largest_axis = 0;
+  for (int axis = 0; axis < 3; axis++) {
+    extent[axis] = centroid_max[axis] - centroid_min[axis];
+    bin_scale[axis] = (extent[axis] > 0.0f) ? (float)BVH_SAH_BINS / extent[axis] : 0.0f;
+    use_axis[axis] = (depth < BVH_SAH_MAX_DEPTH) && (bin_scale[axis] > 0.0f) &&
+                     (bin_scale[axis] < FLT_MAX);
+    if (extent[axis] > extent[largest_axis]) {
+      largest_axis = axis;
+    }
+  }
+
+  if (use_axis[0] || use_axis[1] || use_axis[2]) {
+    BVHSAHBin bins[3][BVH_SAH_BINS];
+    for (int axis = 0; axis < 3; axis++) {
+      for (int b = 0; b < BVH_SAH_BINS; b++) {
+        sah_bounds_init(bins[axis][b].bv);
+        bins[axis][b].count = 0;
+      }
+    }
+
+    for (int i = begin; i < end; i++) {
+      for (int axis = 0; axis < 3; axis++) {
+        if (use_axis[axis]) {
+          const int b = sah_bin_index(leafs_array[i], axis, centroid_min, bin_scale);
+          sah_bounds_join(bins[axis][b].bv, leafs_array[i]->bv);
+          bins[axis][b].count++;
+        }
+      }
+    }
+
+    /* Sweep the bins from both sides, the split goes before `best_bin`. */
+    float best_cost = FLT_MAX;
+    int best_axis = -1, best_bin = 0;
+    for (int axis = 0; axis < 3; axis++) {
+      if (!use_axis[axis]) {
+        continue;
+      }
+
+      float right_area[BVH_SAH_BINS];
+      int right_count[BVH_SAH_BINS];
+      float bv[6];
+      int count = 0;
+      sah_bounds_init(bv);
+      for (int b = BVH_SAH_BINS - 1; b > 0; b--) {
+        sah_bounds_join(bv, bins[axis][b].bv);
+        count += bins[axis][b].count;
+        right_area[b] = sah_bounds_area(bv);
+        right_count[b] = count;
+      }
+
+      count = 0;
+      sah_bounds_init(bv);
+      for (int b = 1; b < BVH_SAH_BINS; b++) {
+        sah_bounds_join(bv, bins[axis][b - 1].bv);
+        count += bins[axis][b - 1].count;
+        if (count == 0 || right_count[b] == 0) {
+          continue;
+        }
+
+        const float cost = sah_bounds_area(bv) * (float)count +
+                           right_area[b] * (float)right_count[b];
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_axis = axis;
+          best_bin = b;
+        }
+      }
+    }
+
+    if (best_axis != -1) {
+      int mid = begin;
+      for (int i = begin; i < end; i++) {
+        if (sah_bin_index(leafs_array[i], best_axis, centroid_min, bin_scale) < best_bin) {
+          SWAP(BVHNode *, leafs_array[i], leafs_array[mid]);
+          mid++;
+        }
+      }
+      *r_axis = best_axis;
+      return mid;
+    }
+  }
+
+  /* Coincident centroids or too deep, split at the median. */
+  const int mid = (begin + end) / 2;
+  partition_nth_element(leafs_array, begin, end, mid, largest_axis * 2 + 1);
+  *r_axis = largest_axis;
+  return mid;
+}
+
+static void sah_build_task(TaskPool *__restrict pool, void *taskdata);
+
+static void sah_build_branch(
+    BVHSAHBuildData *data, const int branch, const int begin, const int end, const int depth)
+{
+  const int tree_type = data->tree->tree_type;
+  BVHSAHBranch *node = &data->branches[branch];
+
+  /* Keep splitting the largest part until there is one for each child. Part P is the range
+   * [nth[P], nth[P + 1]), splitting preserves the order of the parts along the split axis. */
+  int nth[MAX_TREETYPE + 1];
+  int parts_len = 1;
+  nth[0] = begin;
+  nth[1] = end;
+  node->main_axis = 0;
+
+  while (parts_len < tree_type) {
+    int split_part = -1, split_part_len = 1;
+    for (int p = 0; p < parts_len; p++) {
+      if (nth[p + 1] - nth[p] > split_part_len) {
+        split_part = p;
+        split_part_len = nth[p + 1] - nth[p];
+      }
+    }
+    if (split_part == -1) {
+      break;
+    }
+
+    int axis;
+    const int mid = sah_split(
+        data->leafs_array, nth[split_part], nth[split_part + 1], depth, &axis);
+    if (parts_len == 1) {
+      node->main_axis = (char)axis;
+    }
+
+    memmove(&nth[split_part + 2],
+            &nth[split_part + 1],
+            sizeof(*nth) * (size_t)(parts_len - split_part));
+    nth[split_part + 1] = mid;
+    parts_len++;
+  }
+
+  node->totnode = (char)parts_len;
+  node->children_offset = (int)atomic_fetch_and_add_uint32(&data->children_len, (uint)parts_len);
+
+  for (int p = 0; p < parts_len; p++) {
+    int *child = &data->children[node->children_offset + p];
+    if (nth[p + 1] - nth[p] == 1) {
+      *child = -(nth[p] + 1);
+      continue;
+    }
+
+    *child = (int)atomic_fetch_and_add_uint32(&data->branches_len, 1);
+    if (data->task_pool && (nth[p + 1] - nth[p] > KDOPBVH_THREAD_LEAF_THRESHOLD)) {
+      BVHSAHBuildTask *task = MEM_mallocN(sizeof(*task), __func__);
+      task->branch = *child;
+      task->begin = nth[p];
+      task->end = nth[p + 1];
+      task->depth = depth + 1;
+      BLI_task_pool_push(data->task_pool, sah_build_task, task, true, NULL);
+    }
+    else {
+      sah_build_branch(data, *child, nth[p], nth[p + 1], depth + 1);
+    }
+  }
+}
+
+static void sah_build_task(TaskPool *__restrict pool, void *taskdata)
+{
+  BVHSAHBuildData *data = BLI_task_pool_user_data(pool);
+  const BVHSAHBuildTask *task = taskdata;
+  sah_build_branch(data, task->branch, task->begin, task->end, task->depth);
+}
+
+/**
+ * Unbalanced trees can have more branches than the implicit tree the arrays are sized for.
+ */
+static void bvhtree_ensure_branch_capacity(BVHTree *tree, const int totbranch)
+{
+  const int numnodes = (int)(MEM_allocN_len(tree->nodearray) / sizeof(*tree->nodearray));
+  const int numnodes_needed = tree->totleaf + totbranch;
+  if (numnodes_needed <= numnodes) {
+    return;
+  }
+
+  /* Leafs are in the nodes array in balanced order, keep them as indices while reallocating. */
+  int *leaf_indices = MEM_mallocN(sizeof(int) * (size_t)tree->totleaf, __func__);
+  for (int i = 0; i < tree->totleaf; i++) {
+    leaf_indices[i] = (int)(tree->nodes[i] - tree->nodearray);
+  }
+
+  tree->nodes = MEM_recallocN(tree->nodes, sizeof(BVHNode *) * (size_t)numnodes_needed);
+  tree->nodebv = MEM_recallocN(tree->nodebv,
+                               sizeof(float) * (size_t)(tree->axis * numnodes_needed));
+  tree->nodechild = MEM_recallocN(tree->nodechild,
+                                  sizeof(BVHNode *) * (size_t)(tree->tree_type * numnodes_needed));
+  tree->nodearray = MEM_recallocN(tree->nodearray, sizeof(BVHNode) * (size_t)numnodes_needed);
+
+  for (int i = 0; i < numnodes_needed; i++) {
+    tree->nodearray[i].bv = &tree->nodebv[i * tree->axis];
+    tree->nodearray[i].children = &tree->nodechild[i * tree->tree_type];
+  }
+  for (int i = 0; i < tree->totleaf; i++) {
+    tree->nodes[i] = &tree->nodearray[leaf_indices[i]];
+  }
+
+  MEM_freeN(leaf_indices);
+}
+
+static void bvhtree_build_sah(BVHTree *tree)
+{
+  const int totleaf = tree->totleaf;
+
+  /* Every branch has at least two children, so there are less branches than leafs. */
+  BVHSAHBuildData data = {
+      .tree = tree,
+      .leafs_array = tree->nodes,
+      .branches = MEM_mallocN(sizeof(BVHSAHBranch) * (size_t)totleaf, __func__),
+      .children = MEM_mallocN(sizeof(int) * (size_t)(2 * totleaf), __func__),
+      .branches_len = 1,
+      .children_len = 0,
+      .task_pool = NULL,
+  };
+
+  if (totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+    data.task_pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+    sah_build_branch(&data, 0, 0, totleaf, 0);
+    BLI_task_pool_work_and_wait(data.task_pool);
+    BLI_task_pool_free(data.task_pool);
+  }
+  else {
+    sah_build_branch(&data, 0, 0, totleaf, 0);
+  }
+
+  const int totbranch = (int)data.branches_len;
+  bvhtree_ensure_branch_capacity(tree, totbranch);
+
+  /* Number the branches breadth first and link them, `order` maps to build branches. */
+  int *order = MEM_mallocN(sizeof(int) * (size_t)totbranch, __func__);
+  int order_len = 1;
+  order[0] = 0;
+  for (int i = 0; i < order_len; i++) {
+    const BVHSAHBranch *branch = &data.branches[order[i]];
+    BVHNode *node = &tree->nodearray[totleaf + i];
+    tree->nodes[totleaf + i] = node;
+    node->totnode = branch->totnode;
+    node->main_axis = branch->main_axis;
+
+    for (int k = 0; k < branch->totnode; k++) {
+      const int child = data.children[branch->children_offset + k];
+      if (child >= 0) {
+        order[order_len] = child;
+        node->children[k] = &tree->nodearray[totleaf + order_len];
+        order_len++;
+      }
+      else {
+        node->children[k] = tree->nodes[-child - 1];
+      }
+      node->children[k]->parent = node;
+    }
+  }
+  BLI_assert(order_len == totbranch);
+
+  tree->nodes[totleaf]->parent = NULL;
+  tree->totbranch = totbranch;
+  BLI_bvhtree_update_tree(tree);
+
+  MEM_freeN(order);
+  MEM_freeN(data.branches);
+  MEM_freeN(data.children);
+}
+
+#endif /* USE_SAH_BUILD */
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -920,10 +1296,12 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
     /* Allocate arrays */
     numnodes = maxsize + implicit_needed_branches(tree_type, maxsize) + tree_type;
 
+    const eMEM_Tag tag_prev = MEM_tag_set(MEM_TAG_BVH);
     tree->nodes = MEM_callocN(sizeof(BVHNode *) * (size_t)numnodes, "BVHNodes");
     tree->nodebv = MEM_callocN(sizeof(float) * (size_t)(axis * numnodes), "BVHNodeBV");
     tree->nodechild = MEM_callocN(sizeof(BVHNode *) * (size_t)(tree_type * numnodes), "BVHNodeBV");
     tree->nodearray = MEM_callocN(sizeof(BVHNode) * (size_t)numnodes, "BVHNodeArray");
+    MEM_tag_set(tag_prev);
 
     if (UNLIKELY((!tree->nodes) || (!tree->nodebv) || (!tree->nodechild) || (!tree->nodearray))) {
       goto fail;
@@ -961,15 +1339,24 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->totbranch == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+#ifdef USE_SAH_BUILD
+  /* The SAH only uses the X, Y and Z slabs, small trees are a single branch anyway. */
+  if (tree->start_axis == 0 && tree->totleaf > tree->tree_type) {
+    bvhtree_build_sah(tree);
+  }
+  else
+#endif
+  {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
 
-  /* current code expects the branches to be linked to the nodes array
-   * we perform that linkage here */
-  tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
-  for (int i = 0; i < tree->totbranch; i++) {
-    tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
+    /* current code expects the branches to be linked to the nodes array
+     * we perform that linkage here */
+    tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
+    for (int i = 0; i < tree->totbranch; i++) {
+      tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
+    }
   }
 
 #ifdef USE_SKIP_LINKS
@@ -1071,6 +1458,15 @@ int BLI_bvhtree_get_tree_type(const BVHTree *tree)
   return tree->tree_type;
 }
 
+/**
+ * Memory allocated for the tree, in bytes.
+ */
+size_t BLI_bvhtree_get_memory_size(const BVHTree *tree)
+{
+  return sizeof(BVHTree) + MEM_allocN_len(tree->nodes) + MEM_allocN_len(tree->nodearray) +
+         MEM_allocN_len(tree->nodechild) + MEM_allocN_len(tree->nodebv);
+}
+
 float BLI_bvhtree_get_epsilon(const BVHTree *tree)
 {
   return tree->epsilon;
@@ -1660,6 +2056,164 @@ int BLI_bvhtree_find_nearest(BVHTree *tree,
   return BLI_bvhtree_find_nearest_ex(tree, co, nearest, callback, userdata, 0);
 }
 
+/**
+ * Points of #BLI_bvhtree_find_nearest_batch traversed together,
+ * with a copy of the coordinates laid out for testing a node against all of them at once.
+ */
+/* Packets only test the X, Y and Z slabs of the nodes. */
+static bool bvhtree_use_packets(const BVHTree *tree)
+{
+  return tree->start_axis == 0 && tree->stop_axis == 3;
+}
+
+typedef struct BVHNearestPacket {
+  BVHNearestData points[BVH_PACKET_SIZE];
+  float co[3][BVH_PACKET_SIZE];
+  float dist_sq[BVH_PACKET_SIZE];
+} BVHNearestPacket;
+
+/* Returns the points of \a mask that can have a nearer point inside the node bounds. */
+static int nearest_packet_node_test(const BVHNearestPacket *packet, const BVHNode *node, int mask)
+{
+  const float *bv = node->bv;
+  float dist_sq[BVH_PACKET_SIZE] = {0.0f};
+
+  for (int axis = 0; axis < 3; axis++) {
+    for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+      const float val = min_ff(max_ff(packet->co[axis][l], bv[2 * axis]), bv[2 * axis + 1]);
+      const float delta = packet->co[axis][l] - val;
+      dist_sq[l] += delta * delta;
+    }
+  }
+
+  int hit_mask = 0;
+  for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+    if (dist_sq[l] < packet->dist_sq[l]) {
+      hit_mask |= 1 << l;
+    }
+  }
+  return hit_mask & mask;
+}
+
+static void dfs_find_nearest_packet(BVHNearestPacket *packet, const BVHNode *node, int mask)
+{
+  mask = nearest_packet_node_test(packet, node, mask);
+  if (mask == 0) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+      if (mask & (1 << l)) {
+        BVHNearestData *data = &packet->points[l];
+        if (data->callback) {
+          data->callback(data->userdata, node->index, data->co, &data->nearest);
+        }
+        else {
+          data->nearest.index = node->index;
+          data->nearest.dist_sq = calc_nearest_point_squared(
+              data->proj, (BVHNode *)node, data->nearest.co);
+        }
+        packet->dist_sq[l] = data->nearest.dist_sq;
+      }
+    }
+  }
+  else {
+    /* Same heuristic as #dfs_find_nearest_dfs for each point, so every point visits the children
+     * in the same order as a single query, and picks the same element on distance ties. */
+    const int axis = (int)node->main_axis;
+    const float split = node->children[0]->bv[axis * 2 + 1];
+    int forward_mask = 0;
+    for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+      if ((mask & (1 << l)) && packet->points[l].proj[axis] <= split) {
+        forward_mask |= 1 << l;
+      }
+    }
+    const int backward_mask = mask & ~forward_mask;
+
+    if (forward_mask) {
+      for (int i = 0; i != node->totnode; i++) {
+        dfs_find_nearest_packet(packet, node->children[i], forward_mask);
+      }
+    }
+    if (backward_mask) {
+      for (int i = node->totnode - 1; i >= 0; i--) {
+        dfs_find_nearest_packet(packet, node->children[i], backward_mask);
+      }
+    }
+  }
+}
+
+/**
+ * Find the nearest element for each of \a co_len points, like calling
+ * #BLI_bvhtree_find_nearest for each point with \a nearest initialized the same way.
+ *
+ * The points are traversed in groups of #BVH_PACKET_SIZE, sharing the node fetches and testing
+ * the node bounds for all points of a group together. Best used for points that are close to
+ * each other in the array, e.g. the vertices of a mesh.
+ *
+ * Packets only test the X, Y and Z slabs of the nodes, so trees with other axes use single
+ * queries.
+ */
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    int co_len,
+                                    BVHTreeNearest *nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata)
+{
+  BVHNode *root = tree->nodes[tree->totleaf];
+  if (root == NULL) {
+    return;
+  }
+
+  if (!bvhtree_use_packets(tree)) {
+    for (int i = 0; i < co_len; i++) {
+      BLI_bvhtree_find_nearest(tree, co[i], &nearest[i], callback, userdata);
+    }
+    return;
+  }
+
+  for (int start = 0; start < co_len; start += BVH_PACKET_SIZE) {
+    const int packet_len = min_ii(co_len - start, BVH_PACKET_SIZE);
+    BVHNearestPacket packet;
+    int mask = 0;
+
+    for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+      if (l < packet_len) {
+        BVHNearestData *data = &packet.points[l];
+        data->tree = tree;
+        data->co = co[start + l];
+        data->callback = callback;
+        data->userdata = userdata;
+        for (axis_t axis_iter = tree->start_axis; axis_iter != tree->stop_axis; axis_iter++) {
+          data->proj[axis_iter] = dot_v3v3(data->co, bvhtree_kdop_axes[axis_iter]);
+        }
+        memcpy(&data->nearest, &nearest[start + l], sizeof(*nearest));
+
+        for (int axis = 0; axis < 3; axis++) {
+          packet.co[axis][l] = data->co[axis];
+        }
+        packet.dist_sq[l] = data->nearest.dist_sq;
+        mask |= 1 << l;
+      }
+      else {
+        /* Unused points, masked out. */
+        for (int axis = 0; axis < 3; axis++) {
+          packet.co[axis][l] = 0.0f;
+        }
+        packet.dist_sq[l] = 0.0f;
+      }
+    }
+
+    dfs_find_nearest_packet(&packet, root, mask);
+
+    for (int l = 0; l < packet_len; l++) {
+      memcpy(&nearest[start + l], &packet.points[l].nearest, sizeof(*nearest));
+    }
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -2075,6 +2629,198 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
       tree, co, dir, radius, hit_dist, callback, userdata, BVH_RAYCAST_DEFAULT);
 }
 
+/**
+ * Rays of #BLI_bvhtree_ray_cast_batch traversed together,
+ * with a copy of the rays laid out for testing a node against all of them at once.
+ */
+typedef struct BVHRayCastPacket {
+  BVHRayCastData rays[BVH_PACKET_SIZE];
+  float origin[3][BVH_PACKET_SIZE];
+  float idot_axis[3][BVH_PACKET_SIZE];
+  float dist[BVH_PACKET_SIZE];
+  bool use_radius;
+} BVHRayCastPacket;
+
+/**
+ * Returns the rays of \a mask that hit the node bounds before their current hit,
+ * with the distance to the bounds in \a r_dist. Gives the same result as #fast_ray_nearest_hit
+ * and #ray_nearest_hit for each ray.
+ */
+static int ray_packet_node_test(const BVHRayCastPacket *packet,
+                                const BVHNode *node,
+                                int mask,
+                                float r_dist[BVH_PACKET_SIZE])
+{
+  const float *bv = node->bv;
+  int hit_mask = 0;
+
+  if (packet->use_radius) {
+    for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+      if (mask & (1 << l)) {
+        r_dist[l] = ray_nearest_hit(&packet->rays[l], bv);
+        if (r_dist[l] < packet->dist[l]) {
+          hit_mask |= 1 << l;
+        }
+      }
+    }
+    return hit_mask;
+  }
+
+  /* Slab test without branches, so the lanes can be computed in parallel. */
+  float t_near[BVH_PACKET_SIZE], t_far[BVH_PACKET_SIZE];
+  for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+    t_near[l] = -FLT_MAX;
+    t_far[l] = FLT_MAX;
+  }
+
+  for (int axis = 0; axis < 3; axis++) {
+    for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+      const float t_min = (bv[2 * axis] - packet->origin[axis][l]) * packet->idot_axis[axis][l];
+      const float t_max = (bv[2 * axis + 1] - packet->origin[axis][l]) *
+                          packet->idot_axis[axis][l];
+      t_near[l] = max_ff(t_near[l], min_ff(t_min, t_max));
+      t_far[l] = min_ff(t_far[l], max_ff(t_min, t_max));
+    }
+  }
+
+  for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+    r_dist[l] = t_near[l];
+    if (t_near[l] <= t_far[l] && t_far[l] >= 0.0f && t_near[l] < packet->dist[l]) {
+      hit_mask |= 1 << l;
+    }
+  }
+  return hit_mask & mask;
+}
+
+static void dfs_raycast_packet(BVHRayCastPacket *packet, const BVHNode *node, int mask)
+{
+  float dist[BVH_PACKET_SIZE];
+  mask = ray_packet_node_test(packet, node, mask, dist);
+  if (mask == 0) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+      if (mask & (1 << l)) {
+        BVHRayCastData *data = &packet->rays[l];
+        if (data->callback) {
+          data->callback(data->userdata, node->index, &data->ray, &data->hit);
+        }
+        else {
+          data->hit.index = node->index;
+          data->hit.dist = dist[l];
+          madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist[l]);
+        }
+        packet->dist[l] = data->hit.dist;
+      }
+    }
+  }
+  else {
+    /* Same loop direction as #dfs_raycast for each ray, so every ray visits the children in the
+     * same order as a single query, and picks the same element on distance ties. */
+    const int axis = (int)node->main_axis;
+    int forward_mask = 0;
+    for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+      if ((mask & (1 << l)) && packet->rays[l].ray_dot_axis[axis] > 0.0f) {
+        forward_mask |= 1 << l;
+      }
+    }
+    const int backward_mask = mask & ~forward_mask;
+
+    if (forward_mask) {
+      for (int i = 0; i != node->totnode; i++) {
+        dfs_raycast_packet(packet, node->children[i], forward_mask);
+      }
+    }
+    if (backward_mask) {
+      for (int i = node->totnode - 1; i >= 0; i--) {
+        dfs_raycast_packet(packet, node->children[i], backward_mask);
+      }
+    }
+  }
+}
+
+/**
+ * Cast \a rays_len rays, like calling #BLI_bvhtree_ray_cast_ex for each ray
+ * with \a hits initialized the same way.
+ *
+ * The rays are traversed in groups of #BVH_PACKET_SIZE, sharing the node fetches and testing
+ * the node bounds for all rays of a group together. Best used for coherent rays,
+ * e.g. casting from neighboring vertices of a mesh along similar directions.
+ *
+ * Packets only test the X, Y and Z slabs of the nodes, so trees with other axes use single
+ * queries.
+ */
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*co)[3],
+                                const float (*dir)[3],
+                                int rays_len,
+                                float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag)
+{
+  BVHNode *root = tree->nodes[tree->totleaf];
+  if (root == NULL) {
+    return;
+  }
+
+  if (!bvhtree_use_packets(tree)) {
+    for (int i = 0; i < rays_len; i++) {
+      BLI_bvhtree_ray_cast_ex(
+          tree, co[i], dir[i], radius, &hits[i], callback, userdata, flag);
+    }
+    return;
+  }
+
+  for (int start = 0; start < rays_len; start += BVH_PACKET_SIZE) {
+    const int packet_len = min_ii(rays_len - start, BVH_PACKET_SIZE);
+    BVHRayCastPacket packet;
+    int mask = 0;
+
+    packet.use_radius = (radius != 0.0f);
+
+    for (int l = 0; l < BVH_PACKET_SIZE; l++) {
+      if (l < packet_len) {
+        BVHRayCastData *data = &packet.rays[l];
+        BLI_ASSERT_UNIT_V3(dir[start + l]);
+
+        data->tree = tree;
+        data->callback = callback;
+        data->userdata = userdata;
+        copy_v3_v3(data->ray.origin, co[start + l]);
+        copy_v3_v3(data->ray.direction, dir[start + l]);
+        data->ray.radius = radius;
+        bvhtree_ray_cast_data_precalc(data, flag);
+        memcpy(&data->hit, &hits[start + l], sizeof(*hits));
+
+        for (int axis = 0; axis < 3; axis++) {
+          packet.origin[axis][l] = data->ray.origin[axis];
+          packet.idot_axis[axis][l] = data->idot_axis[axis];
+        }
+        packet.dist[l] = data->hit.dist;
+        mask |= 1 << l;
+      }
+      else {
+        /* Unused rays, masked out. */
+        for (int axis = 0; axis < 3; axis++) {
+          packet.origin[axis][l] = 0.0f;
+          packet.idot_axis[axis][l] = 1.0f;
+        }
+        packet.dist[l] = 0.0f;
+      }
+    }
+
+    dfs_raycast_packet(&packet, root, mask);
+
+    for (int l = 0; l < packet_len; l++) {
+      memcpy(&hits[start + l], &packet.rays[l].hit, sizeof(*hits));
+    }
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -29,6 +29,7 @@
 #include "BLI_math_boolean.hh"
 #include "BLI_math_mpq.hh"
 #include "BLI_mpq2.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "BLI_delaunay_2d.h"
@@ -304,6 +305,12 @@ template<typename Arith_t> struct CDTArrangement {
    */
   void delete_edge(SymEdge<Arith_t> *se);
 
+  /**
+   * Move the edges and faces of \a other to the end of the arrangement, leaving \a other empty.
+   * Both arrangements must share the same outer face, and \a other must not own any vertices.
+   */
+  void append_edges_and_faces(CDTArrangement<Arith_t> &other);
+
   /**
    * If the vertex with index i in the vert array has not been merge, return it.
    * Else return the one that it has merged to.
@@ -1137,6 +1144,15 @@ template<typename T> void CDTArrangement<T>::delete_edge(SymEdge<T> *se)
   }
 }
 
+template<typename T> void CDTArrangement<T>::append_edges_and_faces(CDTArrangement<T> &other)
+{
+  BLI_assert(other.verts.is_empty() && other.outer_face == this->outer_face);
+  this->edges.extend(other.edges.as_span());
+  this->faces.extend(other.faces.as_span());
+  other.edges.clear();
+  other.faces.clear();
+}
+
 template<typename T> class SiteInfo {
  public:
   CDTVert<T> *v;
@@ -1217,6 +1233,8 @@ void dc_tri(CDTArrangement<T> *cdt,
             SymEdge<T> **r_re)
 {
   constexpr int dbg_level = 0;
+  /* Below this many sites, triangulating the halves in parallel costs more than it saves. */
+  constexpr int parallel_min_sites = 4096;
   if (dbg_level > 0) {
     std::cout << "DC_TRI start=" << start << " end=" << end << "\n";
   }
@@ -1268,8 +1286,26 @@ void dc_tri(CDTArrangement<T> *cdt,
   SymEdge<T> *ldi;
   SymEdge<T> *rdi;
   SymEdge<T> *rdo;
-  dc_tri(cdt, sites, start, start + n2, &ldo, &ldi);
-  dc_tri(cdt, sites, start + n2, end, &rdi, &rdo);
+  if (n >= parallel_min_sites) {
+    /* The halves don't share any vertices, only the outer face. Build them in separate
+     * arrangements so they don't append to the same vectors, then append their elements in the
+     * order the serial recursion would have created them. */
+    CDTArrangement<T> cdt_left;
+    CDTArrangement<T> cdt_right;
+    cdt_left.outer_face = cdt_right.outer_face = cdt->outer_face;
+    cdt_left.edges.reserve(3 * n2);
+    cdt_left.faces.reserve(2 * n2);
+    cdt_right.edges.reserve(3 * (n - n2));
+    cdt_right.faces.reserve(2 * (n - n2));
+    parallel_invoke([&]() { dc_tri(&cdt_left, sites, start, start + n2, &ldo, &ldi); },
+                    [&]() { dc_tri(&cdt_right, sites, start + n2, end, &rdi, &rdo); });
+    cdt->append_edges_and_faces(cdt_left);
+    cdt->append_edges_and_faces(cdt_right);
+  }
+  else {
+    dc_tri(cdt, sites, start, start + n2, &ldo, &ldi);
+    dc_tri(cdt, sites, start + n2, end, &rdi, &rdo);
+  }
   if (dbg_level > 0) {
     std::cout << "\nDC_TRI merge step for start=" << start << ", end=" << end << "\n";
     std::cout << "ldo " << ldo << "\n"
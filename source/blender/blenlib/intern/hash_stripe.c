@@ -0,0 +1,296 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * Stripe hash, a 64 and 128 bit hash for large buffers.
+ *
+ * The main loop follows the long input loop of XXH3: data is read in stripes of 64 bytes, which
+ * are mixed into 8 independent 64 bit accumulators with a multiply of the 32 bit halves of every
+ * data word after combining it with a key. This maps directly to SSE2, which processes two
+ * accumulators per instruction. After a block of 16 stripes the accumulators are scrambled, and
+ * at the end they are merged into the hash with full 64 bit multiplies.
+ *
+ * It is not compatible with XXH3, short inputs are zero padded to a full stripe instead of using
+ * separate code paths. For small keys, #BLI_hash_mm2 is faster.
+ *
+ * Data is read as little endian, so the hash is the same on all platforms.
+ */
+
+#include <string.h>
+
+#include "BLI_endian_switch.h"
+#include "BLI_utildefines.h"
+
+#include "BLI_hash_stripe.h" /* own include */
+
+#include "BLI_strict_flags.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#define STRIPES_PER_BLOCK 16
+
+#define PRIME32_1 0x9E3779B1U
+#define PRIME32_2 0x85EBCA77U
+#define PRIME32_3 0xC2B2AE3DU
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+/* Stripe i of a block uses the keys starting at i, the scramble at the end of a block uses the
+ * last 8 keys. */
+BLI_STATIC_ASSERT(STRIPES_PER_BLOCK + BLI_HASH_STRIPE_ACC_LEN == BLI_HASH_STRIPE_SECRET_LEN,
+                  "Secret does not match block size");
+
+static const uint64_t hash_stripe_secret[BLI_HASH_STRIPE_SECRET_LEN] = {
+    0x27c2045da81b201fULL, 0x9878873c4951bffdULL, 0xd7feca012b34fac4ULL,
+    0x9f4e0143f22a1a86ULL, 0x6b0c1171760cd50bULL, 0x7a2422c9815c0a8bULL,
+    0x1dcc107a41baca07ULL, 0x64f763cad16ba00bULL, 0xae4e95a5b29877fbULL,
+    0x9107f0ce2a41ba67ULL, 0xef75cd8728141c91ULL, 0x7d96e2a0d1e24734ULL,
+    0x7d58dd4f8d06f307ULL, 0xaff7f28c8c42fbe0ULL, 0x16b5e95ba84e1a78ULL,
+    0x28fb3ec6b9216732ULL, 0xbf671d1cc8a29e9fULL, 0x340e14aea9012a7fULL,
+    0x231442281548b26bULL, 0xf96f114a5a8a4858ULL, 0x50a6dc2affe8e062ULL,
+    0x9d1a376ab9fe7d82ULL, 0x51bf07a0c70c00e9ULL, 0x59af1d7647d4c524ULL,
+};
+
+BLI_INLINE uint64_t hash_stripe_read_u64(const unsigned char *data)
+{
+  uint64_t value;
+  memcpy(&value, data, sizeof(value));
+#ifdef __BIG_ENDIAN__
+  BLI_endian_switch_uint64(&value);
+#endif
+  return value;
+}
+
+/* Multiply to 128 bits, and fold the upper half into the lower half. */
+BLI_INLINE uint64_t hash_stripe_mul128_fold64(const uint64_t a, const uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+  const __uint128_t product = (__uint128_t)a * b;
+  return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+  const uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+  const uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+  const uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+  const uint64_t hi_hi = (a >> 32) * (b >> 32);
+  const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  const uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  const uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+  return lower ^ upper;
+#endif
+}
+
+BLI_INLINE uint64_t hash_stripe_avalanche(uint64_t h)
+{
+  h ^= h >> 37;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+/* Accumulate consecutive stripes of a block, starting at stripe_index. */
+static void hash_stripe_accumulate(uint64_t acc[BLI_HASH_STRIPE_ACC_LEN],
+                                   const uint64_t *secret,
+                                   const unsigned char *data,
+                                   const uint32_t stripe_index,
+                                   const uint32_t stripes_len)
+{
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+  __m128i acc_vec[BLI_HASH_STRIPE_ACC_LEN / 2];
+  for (int i = 0; i < BLI_HASH_STRIPE_ACC_LEN / 2; i++) {
+    acc_vec[i] = _mm_loadu_si128((const __m128i *)(acc + 2 * i));
+  }
+
+  for (uint32_t stripe = 0; stripe < stripes_len; stripe++) {
+    const unsigned char *stripe_data = data + stripe * BLI_HASH_STRIPE_LEN;
+    const uint64_t *key = secret + stripe_index + stripe;
+
+    for (int i = 0; i < BLI_HASH_STRIPE_ACC_LEN / 2; i++) {
+      const __m128i data_vec = _mm_loadu_si128((const __m128i *)(stripe_data + 16 * i));
+      const __m128i key_vec = _mm_loadu_si128((const __m128i *)(key + 2 * i));
+      const __m128i data_key = _mm_xor_si128(data_vec, key_vec);
+      /* Multiply the lower by the upper 32 bits of every 64 bit word. */
+      const __m128i data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+      const __m128i product = _mm_mul_epu32(data_key, data_key_hi);
+      /* Add the data to the neighboring accumulator, so it is not lost when the product is 0. */
+      const __m128i data_swap = _mm_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+      acc_vec[i] = _mm_add_epi64(acc_vec[i], _mm_add_epi64(product, data_swap));
+    }
+  }
+
+  for (int i = 0; i < BLI_HASH_STRIPE_ACC_LEN / 2; i++) {
+    _mm_storeu_si128((__m128i *)(acc + 2 * i), acc_vec[i]);
+  }
+#else
+  for (uint32_t stripe = 0; stripe < stripes_len; stripe++) {
+    const unsigned char *stripe_data = data + stripe * BLI_HASH_STRIPE_LEN;
+    const uint64_t *key = secret + stripe_index + stripe;
+
+    for (int i = 0; i < BLI_HASH_STRIPE_ACC_LEN; i++) {
+      const uint64_t data_val = hash_stripe_read_u64(stripe_data + 8 * i);
+      const uint64_t data_key = data_val ^ key[i];
+      acc[i ^ 1] += data_val;
+      acc[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+    }
+  }
+#endif
+}
+
+static void hash_stripe_scramble(uint64_t acc[BLI_HASH_STRIPE_ACC_LEN], const uint64_t *secret)
+{
+  const uint64_t *key = secret + STRIPES_PER_BLOCK;
+  for (int i = 0; i < BLI_HASH_STRIPE_ACC_LEN; i++) {
+    uint64_t a = acc[i];
+    a ^= a >> 47;
+    a ^= key[i];
+    a *= PRIME32_1;
+    acc[i] = a;
+  }
+}
+
+/* Accumulate whole stripes, scrambling the accumulators after every block. */
+static void hash_stripe_consume(BLI_HashStripe *state,
+                                const unsigned char *data,
+                                size_t stripes_len)
+{
+  while (stripes_len > 0) {
+    const uint32_t len = (uint32_t)MIN2((size_t)(STRIPES_PER_BLOCK - state->stripe_index),
+                                        stripes_len);
+    hash_stripe_accumulate(state->acc, state->secret, data, state->stripe_index, len);
+    data += len * BLI_HASH_STRIPE_LEN;
+    stripes_len -= len;
+    state->stripe_index += len;
+
+    if (state->stripe_index == STRIPES_PER_BLOCK) {
+      hash_stripe_scramble(state->acc, state->secret);
+      state->stripe_index = 0;
+    }
+  }
+}
+
+static uint64_t hash_stripe_merge(const uint64_t acc[BLI_HASH_STRIPE_ACC_LEN],
+                                  const uint64_t *key,
+                                  uint64_t h)
+{
+  for (int i = 0; i < BLI_HASH_STRIPE_ACC_LEN; i += 2) {
+    h += hash_stripe_mul128_fold64(acc[i] ^ key[i], acc[i + 1] ^ key[i + 1]);
+  }
+  return hash_stripe_avalanche(h);
+}
+
+/* Accumulators including the buffered data, which is zero padded to a full stripe. */
+static void hash_stripe_final_acc(const BLI_HashStripe *state,
+                                  uint64_t r_acc[BLI_HASH_STRIPE_ACC_LEN])
+{
+  memcpy(r_acc, state->acc, sizeof(state->acc));
+
+  if (state->buffer_len > 0) {
+    unsigned char stripe[BLI_HASH_STRIPE_LEN] = {0};
+    memcpy(stripe, state->buffer, state->buffer_len);
+    hash_stripe_accumulate(r_acc, state->secret, stripe, state->stripe_index, 1);
+  }
+}
+
+void BLI_hash_stripe_init(BLI_HashStripe *state, uint64_t seed)
+{
+  state->acc[0] = PRIME32_3;
+  state->acc[1] = PRIME64_1;
+  state->acc[2] = PRIME64_2;
+  state->acc[3] = PRIME64_3;
+  state->acc[4] = PRIME64_4;
+  state->acc[5] = PRIME32_2;
+  state->acc[6] = PRIME64_5;
+  state->acc[7] = PRIME32_1;
+
+  for (int i = 0; i < BLI_HASH_STRIPE_SECRET_LEN; i += 2) {
+    state->secret[i] = hash_stripe_secret[i] + seed;
+    state->secret[i + 1] = hash_stripe_secret[i + 1] - seed;
+  }
+
+  state->total_len = 0;
+  state->buffer_len = 0;
+  state->stripe_index = 0;
+}
+
+void BLI_hash_stripe_add(BLI_HashStripe *state, const void *data, size_t len)
+{
+  const unsigned char *data_bytes = (const unsigned char *)data;
+
+  state->total_len += len;
+
+  /* Complete the buffered stripe first. */
+  if (state->buffer_len > 0) {
+    const size_t fill_len = MIN2(BLI_HASH_STRIPE_LEN - (size_t)state->buffer_len, len);
+    memcpy(state->buffer + state->buffer_len, data_bytes, fill_len);
+    state->buffer_len += (uint32_t)fill_len;
+    data_bytes += fill_len;
+    len -= fill_len;
+
+    if (state->buffer_len < BLI_HASH_STRIPE_LEN) {
+      return;
+    }
+    hash_stripe_consume(state, state->buffer, 1);
+    state->buffer_len = 0;
+  }
+
+  /* Read whole stripes straight from the data. */
+  const size_t stripes_len = len / BLI_HASH_STRIPE_LEN;
+  hash_stripe_consume(state, data_bytes, stripes_len);
+  data_bytes += stripes_len * BLI_HASH_STRIPE_LEN;
+  len -= stripes_len * BLI_HASH_STRIPE_LEN;
+
+  memcpy(state->buffer, data_bytes, len);
+  state->buffer_len = (uint32_t)len;
+}
+
+uint64_t BLI_hash_stripe_end(const BLI_HashStripe *state)
+{
+  uint64_t acc[BLI_HASH_STRIPE_ACC_LEN];
+  hash_stripe_final_acc(state, acc);
+
+  return hash_stripe_merge(acc, state->secret + 3, state->total_len * PRIME64_1);
+}
+
+void BLI_hash_stripe_end_128(const BLI_HashStripe *state, uint64_t r_hash[2])
+{
+  uint64_t acc[BLI_HASH_STRIPE_ACC_LEN];
+  hash_stripe_final_acc(state, acc);
+
+  r_hash[0] = hash_stripe_merge(acc, state->secret + 3, state->total_len * PRIME64_1);
+  r_hash[1] = hash_stripe_merge(acc, state->secret + 11, ~(state->total_len * PRIME64_2));
+}
+
+uint64_t BLI_hash_stripe(const void *data, size_t len, uint64_t seed)
+{
+  BLI_HashStripe state;
+  BLI_hash_stripe_init(&state, seed);
+  BLI_hash_stripe_add(&state, data, len);
+  return BLI_hash_stripe_end(&state);
+}
+
+void BLI_hash_stripe_128(const void *data, size_t len, uint64_t seed, uint64_t r_hash[2])
+{
+  BLI_HashStripe state;
+  BLI_hash_stripe_init(&state, seed);
+  BLI_hash_stripe_add(&state, data, len);
+  BLI_hash_stripe_end_128(&state, r_hash);
+}
@@ -22,6 +22,7 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_strict_flags.h"
 #include "BLI_utildefines.h"
 
@@ -52,9 +53,12 @@ struct KDTree {
 #endif
 };
 
-#define KD_STACK_INIT 100     /* initial size for array (on the stack) */
-#define KD_NEAR_ALLOC_INC 100 /* alloc increment for collecting nearest */
-#define KD_FOUND_ALLOC_INC 50 /* alloc increment for collecting nearest */
+#define KD_STACK_INIT 100      /* initial size for array (on the stack) */
+#define KD_NEAR_ALLOC_INC 100  /* alloc increment for collecting nearest */
+#define KD_FOUND_ALLOC_INIT 50 /* initial size for collecting nearest in range */
+
+#define KD_BALANCE_TASK_MIN 10000  /* smaller subtrees are balanced in a single task */
+#define KD_BATCH_THREADING_MIN 256 /* minimum number of batched queries to use threads */
 
 #define KD_NODE_UNSET ((uint)-1)
 
@@ -145,20 +149,14 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Quicksort style sorting around the median on \a axis, returns the median.
+ */
+static uint kdtree_balance_partition(KDTreeNode *nodes, uint nodes_len, uint axis)
 {
-  KDTreeNode *node;
   float co;
   uint left, right, median, i, j;
 
-  if (nodes_len <= 0) {
-    return KD_NODE_UNSET;
-  }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
-
-  /* quicksort style sorting around median */
   left = 0;
   right = nodes_len - 1;
   median = nodes_len / 2;
@@ -190,6 +188,23 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  return median;
+}
+
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
   /* set node and sort subnodes */
   node = &nodes[median];
   node->d = axis;
@@ -201,6 +216,59 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+/**
+ * Balance large trees in parallel: after partitioning a subtree around its median, both halves
+ * are independent and balanced in separate tasks. Gives the same tree as #kdtree_balance.
+ */
+typedef struct KDTreeBalanceTask {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+  /* Set to the root of the balanced subtree. */
+  uint *r_root;
+} KDTreeBalanceTask;
+
+static void kdtree_balance_task_run(TaskPool *__restrict pool, void *taskdata);
+
+static void kdtree_balance_task_push(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, uint ofs, uint *r_root)
+{
+  KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+  task->nodes = nodes;
+  task->nodes_len = nodes_len;
+  task->axis = axis;
+  task->ofs = ofs;
+  task->r_root = r_root;
+  BLI_task_pool_push(pool, kdtree_balance_task_run, task, true, NULL);
+}
+
+static void kdtree_balance_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  const KDTreeBalanceTask *task = taskdata;
+  KDTreeNode *nodes = task->nodes;
+  const uint nodes_len = task->nodes_len;
+
+  if (nodes_len < KD_BALANCE_TASK_MIN) {
+    *task->r_root = kdtree_balance(nodes, nodes_len, task->axis, task->ofs);
+    return;
+  }
+
+  const uint median = kdtree_balance_partition(nodes, nodes_len, task->axis);
+  const uint axis = (task->axis + 1) % KD_DIMS;
+  KDTreeNode *node = &nodes[median];
+  node->d = task->axis;
+  *task->r_root = median + task->ofs;
+
+  kdtree_balance_task_push(pool, nodes, median, axis, task->ofs, &node->left);
+  kdtree_balance_task_push(pool,
+                           nodes + median + 1,
+                           nodes_len - (median + 1),
+                           axis,
+                           (median + 1) + task->ofs,
+                           &node->right);
+}
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -210,7 +278,15 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len >= KD_BALANCE_TASK_MIN) {
+    TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+    kdtree_balance_task_push(pool, tree->nodes, tree->nodes_len, 0, 0, &tree->root);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -625,8 +701,11 @@ static void nearest_add_in_range(KDTreeNearest **r_nearest,
   KDTreeNearest *to;
 
   if (UNLIKELY(nearest_index >= *nearest_len_capacity)) {
+    /* Grow geometrically, large ranges can contain many points. */
+    *nearest_len_capacity = (*nearest_len_capacity == 0) ? KD_FOUND_ALLOC_INIT :
+                                                           *nearest_len_capacity * 2;
     *r_nearest = MEM_reallocN_id(
-        *r_nearest, (*nearest_len_capacity += KD_FOUND_ALLOC_INC) * sizeof(KDTreeNode), __func__);
+        *r_nearest, *nearest_len_capacity * sizeof(KDTreeNearest), __func__);
   }
 
   to = (*r_nearest) + nearest_index;
@@ -806,6 +885,134 @@ finally:
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Queries
+ *
+ * Run the same kind of query for many coordinates, in parallel when there are enough of them.
+ * \{ */
+
+struct BatchQueryData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  KDTreeNearest *r_nearest;
+  uint nearest_len_capacity;
+  int *r_nearest_len;
+  float range;
+  KDTreeNearest **r_nearest_range;
+};
+
+static void batch_query_settings_init(TaskParallelSettings *settings, const uint co_len)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (co_len >= KD_BATCH_THREADING_MIN);
+  settings->min_iter_per_thread = 64;
+}
+
+static void find_nearest_batch_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct BatchQueryData *data = userdata;
+  if (BLI_kdtree_nd_(find_nearest)(data->tree, data->co[i], &data->r_nearest[i]) == -1) {
+    data->r_nearest[i].index = -1;
+  }
+}
+
+/**
+ * Batched version of #BLI_kdtree_3d_find_nearest.
+ *
+ * \param r_nearest: An array of \a co_len nearest, the index is -1 when no node is found.
+ */
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const uint co_len,
+                                        KDTreeNearest *r_nearest)
+{
+  struct BatchQueryData data = {
+      .tree = tree,
+      .co = co,
+      .r_nearest = r_nearest,
+  };
+  TaskParallelSettings settings;
+  batch_query_settings_init(&settings, co_len);
+  BLI_task_parallel_range(0, (int)co_len, &data, find_nearest_batch_cb, &settings);
+}
+
+static void find_nearest_n_batch_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct BatchQueryData *data = userdata;
+  data->r_nearest_len[i] = BLI_kdtree_nd_(find_nearest_n)(
+      data->tree,
+      data->co[i],
+      &data->r_nearest[(uint)i * data->nearest_len_capacity],
+      data->nearest_len_capacity);
+}
+
+/**
+ * Batched version of #BLI_kdtree_3d_find_nearest_n.
+ *
+ * \param r_nearest: An array of \a co_len * \a nearest_len_capacity nearest,
+ * the nearest of each coordinate are stored one after the other.
+ * \param r_nearest_len: An array of \a co_len, the number of nearest found per coordinate.
+ */
+void BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                          const float (*co)[KD_DIMS],
+                                          const uint co_len,
+                                          KDTreeNearest *r_nearest,
+                                          const uint nearest_len_capacity,
+                                          int *r_nearest_len)
+{
+  struct BatchQueryData data = {
+      .tree = tree,
+      .co = co,
+      .r_nearest = r_nearest,
+      .nearest_len_capacity = nearest_len_capacity,
+      .r_nearest_len = r_nearest_len,
+  };
+  TaskParallelSettings settings;
+  batch_query_settings_init(&settings, co_len);
+  BLI_task_parallel_range(0, (int)co_len, &data, find_nearest_n_batch_cb, &settings);
+}
+
+static void range_search_batch_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct BatchQueryData *data = userdata;
+  data->r_nearest_len[i] = BLI_kdtree_nd_(range_search)(
+      data->tree, data->co[i], &data->r_nearest_range[i], data->range);
+}
+
+/**
+ * Batched version of #BLI_kdtree_3d_range_search.
+ *
+ * \param r_nearest: An array of \a co_len, set to an allocated array of the nearest of each
+ * coordinate or NULL when there are none (caller is responsible for freeing).
+ * \param r_nearest_len: An array of \a co_len, the number of nearest found per coordinate.
+ */
+void BLI_kdtree_nd_(range_search_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const uint co_len,
+                                        const float range,
+                                        KDTreeNearest **r_nearest,
+                                        int *r_nearest_len)
+{
+  struct BatchQueryData data = {
+      .tree = tree,
+      .co = co,
+      .range = range,
+      .r_nearest_range = r_nearest,
+      .r_nearest_len = r_nearest_len,
+  };
+  TaskParallelSettings settings;
+  batch_query_settings_init(&settings, co_len);
+  BLI_task_parallel_range(0, (int)co_len, &data, range_search_batch_cb, &settings);
+}
+
+/** \} */
+
 /**
  * Use when we want to loop over nodes ordered by index.
  * Requires indices to be aligned with nodes.
@@ -0,0 +1,366 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * Stable parallel merge sort and radix sort.
+ */
+
+#include <cstring>
+#include <utility>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_sort.h"
+#include "BLI_task.hh"
+#include "BLI_utildefines.h"
+
+namespace blender {
+
+/* -------------------------------------------------------------------- */
+/** \name Merge Sort
+ * \{ */
+
+/* Runs up to this length are sorted with insertion sort. */
+#define MERGE_SORT_INSERTION_MAX 16
+/* Arrays and merges below this length are not split into parallel tasks. */
+#define MERGE_SORT_PARALLEL_MIN 8192
+
+struct MergeSortData {
+  size_t es;
+  BLI_sort_cmp_t cmp;
+  void *thunk;
+
+  int compare(const char *a, const char *b) const
+  {
+    return cmp(a, b, thunk);
+  }
+};
+
+/* Sort in place, using the element at r_temp as temporary storage. */
+static void merge_sort_insertion(const MergeSortData &data, char *a, size_t n, char *r_temp)
+{
+  const size_t es = data.es;
+  for (size_t i = 1; i < n; i++) {
+    char *elem = a + i * es;
+    size_t j = i;
+    while (j > 0 && data.compare(elem, a + (j - 1) * es) < 0) {
+      j--;
+    }
+    if (j != i) {
+      memcpy(r_temp, elem, es);
+      memmove(a + (j + 1) * es, a + j * es, (i - j) * es);
+      memcpy(a + j * es, r_temp, es);
+    }
+  }
+}
+
+/* Find the first element in a that is not less than the key. */
+static size_t merge_sort_lower_bound(const MergeSortData &data,
+                                     const char *a,
+                                     size_t n,
+                                     const char *key)
+{
+  size_t first = 0;
+  while (n > 0) {
+    const size_t half = n / 2;
+    if (data.compare(a + (first + half) * data.es, key) < 0) {
+      first += half + 1;
+      n -= half + 1;
+    }
+    else {
+      n = half;
+    }
+  }
+  return first;
+}
+
+/* Find the first element in a that is greater than the key. */
+static size_t merge_sort_upper_bound(const MergeSortData &data,
+                                     const char *a,
+                                     size_t n,
+                                     const char *key)
+{
+  size_t first = 0;
+  while (n > 0) {
+    const size_t half = n / 2;
+    if (data.compare(key, a + (first + half) * data.es) < 0) {
+      n = half;
+    }
+    else {
+      first += half + 1;
+      n -= half + 1;
+    }
+  }
+  return first;
+}
+
+/* Merge the sorted runs a and b into dst. Of equal elements, those of a come first. */
+static void merge_sort_merge(const MergeSortData &data,
+                             const char *a,
+                             size_t a_len,
+                             const char *b,
+                             size_t b_len,
+                             char *dst)
+{
+  const size_t es = data.es;
+
+  if (a_len + b_len < MERGE_SORT_PARALLEL_MIN) {
+    const char *a_end = a + a_len * es;
+    const char *b_end = b + b_len * es;
+    while (a != a_end && b != b_end) {
+      if (data.compare(b, a) < 0) {
+        memcpy(dst, b, es);
+        b += es;
+      }
+      else {
+        memcpy(dst, a, es);
+        a += es;
+      }
+      dst += es;
+    }
+    memcpy(dst, a, (size_t)(a_end - a));
+    dst += a_end - a;
+    memcpy(dst, b, (size_t)(b_end - b));
+    return;
+  }
+
+  /* Split both runs at the middle element of the longer one, and merge both halves in parallel.
+   * Elements equal to the split element stay on the side that keeps elements of a first. */
+  size_t a_mid, b_mid;
+  if (a_len >= b_len) {
+    a_mid = a_len / 2;
+    b_mid = merge_sort_lower_bound(data, b, b_len, a + a_mid * es);
+  }
+  else {
+    b_mid = b_len / 2;
+    a_mid = merge_sort_upper_bound(data, a, a_len, b + b_mid * es);
+  }
+
+  parallel_invoke([&]() { merge_sort_merge(data, a, a_mid, b, b_mid, dst); },
+                  [&]() {
+                    merge_sort_merge(data,
+                                     a + a_mid * es,
+                                     a_len - a_mid,
+                                     b + b_mid * es,
+                                     b_len - b_mid,
+                                     dst + (a_mid + b_mid) * es);
+                  });
+}
+
+/* Sort a, leaving the result in a or in the buffer of the same size. */
+static void merge_sort_recursive(
+    const MergeSortData &data, char *a, char *buffer, size_t n, bool result_in_buffer)
+{
+  const size_t es = data.es;
+
+  if (n <= MERGE_SORT_INSERTION_MAX) {
+    merge_sort_insertion(data, a, n, buffer);
+    if (result_in_buffer) {
+      memcpy(buffer, a, n * es);
+    }
+    return;
+  }
+
+  /* Sort the halves into the other array, so merging them puts the result in place. */
+  const size_t half = n / 2;
+  auto sort_left = [&]() { merge_sort_recursive(data, a, buffer, half, !result_in_buffer); };
+  auto sort_right = [&]() {
+    merge_sort_recursive(data, a + half * es, buffer + half * es, n - half, !result_in_buffer);
+  };
+  if (n >= MERGE_SORT_PARALLEL_MIN) {
+    parallel_invoke(sort_left, sort_right);
+  }
+  else {
+    sort_left();
+    sort_right();
+  }
+
+  const char *src = result_in_buffer ? a : buffer;
+  char *dst = result_in_buffer ? buffer : a;
+  merge_sort_merge(data, src, half, src + half * es, n - half, dst);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Radix Sort
+ *
+ * Least significant digit radix sort of key and index pairs, 8 bits per pass. The array is
+ * split in chunks, which count their digits and then scatter their elements in parallel. Each
+ * chunk writes to its own range of every digit, so the sort is stable.
+ * \{ */
+
+#define RADIX_SORT_DIGIT_BITS 8
+#define RADIX_SORT_DIGIT_LEN (1 << RADIX_SORT_DIGIT_BITS)
+#define RADIX_SORT_CHUNK_LEN (1 << 16)
+
+struct RadixSortItem {
+  uint32_t key;
+  uint32_t index;
+};
+
+static void radix_sort_order(const uint32_t *keys, const uint32_t len, uint32_t *r_order)
+{
+  if (len == 0) {
+    return;
+  }
+
+  const uint32_t chunks_len = (len + RADIX_SORT_CHUNK_LEN - 1) / RADIX_SORT_CHUNK_LEN;
+  RadixSortItem *items = (RadixSortItem *)MEM_malloc_arrayN(
+      len, sizeof(RadixSortItem), "radix sort items");
+  RadixSortItem *items_other = (RadixSortItem *)MEM_malloc_arrayN(
+      len, sizeof(RadixSortItem), "radix sort items");
+  uint32_t(*chunk_offsets)[RADIX_SORT_DIGIT_LEN] = (uint32_t(*)[RADIX_SORT_DIGIT_LEN])
+      MEM_malloc_arrayN(chunks_len, sizeof(*chunk_offsets), "radix sort offsets");
+
+  auto chunk_range = [&](const int64_t chunk) {
+    const uint32_t start = (uint32_t)chunk * RADIX_SORT_CHUNK_LEN;
+    return IndexRange(start, MIN2(len - start, (uint32_t)RADIX_SORT_CHUNK_LEN));
+  };
+
+  parallel_for(IndexRange(len), RADIX_SORT_CHUNK_LEN, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      items[i].key = keys[i];
+      items[i].index = (uint32_t)i;
+    }
+  });
+
+  for (int shift = 0; shift < 32; shift += RADIX_SORT_DIGIT_BITS) {
+    /* Count digits per chunk. */
+    parallel_for(IndexRange(chunks_len), 1, [&](IndexRange range) {
+      for (const int64_t chunk : range) {
+        uint32_t *counts = chunk_offsets[chunk];
+        memset(counts, 0, sizeof(*chunk_offsets));
+        for (const int64_t i : chunk_range(chunk)) {
+          counts[(items[i].key >> shift) & (RADIX_SORT_DIGIT_LEN - 1)]++;
+        }
+      }
+    });
+
+    /* Nothing to do when all keys have the same digit, which is common for the upper digits. */
+    const uint32_t first_digit = (items[0].key >> shift) & (RADIX_SORT_DIGIT_LEN - 1);
+    uint32_t first_digit_len = 0;
+    for (uint32_t chunk = 0; chunk < chunks_len; chunk++) {
+      first_digit_len += chunk_offsets[chunk][first_digit];
+    }
+    if (first_digit_len == len) {
+      continue;
+    }
+
+    /* Turn counts into the start of every digit in every chunk. */
+    uint32_t offset = 0;
+    for (int digit = 0; digit < RADIX_SORT_DIGIT_LEN; digit++) {
+      for (uint32_t chunk = 0; chunk < chunks_len; chunk++) {
+        const uint32_t count = chunk_offsets[chunk][digit];
+        chunk_offsets[chunk][digit] = offset;
+        offset += count;
+      }
+    }
+
+    parallel_for(IndexRange(chunks_len), 1, [&](IndexRange range) {
+      for (const int64_t chunk : range) {
+        uint32_t *offsets = chunk_offsets[chunk];
+        for (const int64_t i : chunk_range(chunk)) {
+          const RadixSortItem item = items[i];
+          items_other[offsets[(item.key >> shift) & (RADIX_SORT_DIGIT_LEN - 1)]++] = item;
+        }
+      }
+    });
+
+    std::swap(items, items_other);
+  }
+
+  parallel_for(IndexRange(len), RADIX_SORT_CHUNK_LEN, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      r_order[i] = items[i].index;
+    }
+  });
+
+  MEM_freeN(items);
+  MEM_freeN(items_other);
+  MEM_freeN(chunk_offsets);
+}
+
+/* Map keys to unsigned integers with the same order. */
+static uint32_t *radix_sort_keys_from_int(const int *keys, const uint32_t len)
+{
+  uint32_t *ukeys = (uint32_t *)MEM_malloc_arrayN(len, sizeof(uint32_t), __func__);
+  parallel_for(IndexRange(len), RADIX_SORT_CHUNK_LEN, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      ukeys[i] = (uint32_t)keys[i] ^ 0x80000000u;
+    }
+  });
+  return ukeys;
+}
+
+static uint32_t *radix_sort_keys_from_float(const float *keys, const uint32_t len)
+{
+  uint32_t *ukeys = (uint32_t *)MEM_malloc_arrayN(len, sizeof(uint32_t), __func__);
+  parallel_for(IndexRange(len), RADIX_SORT_CHUNK_LEN, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      uint32_t bits;
+      memcpy(&bits, &keys[i], sizeof(bits));
+      /* Flip all bits of negative numbers, to reverse their order. */
+      ukeys[i] = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+  });
+  return ukeys;
+}
+
+/** \} */
+
+}  // namespace blender
+
+using namespace blender;
+
+void BLI_sort_merge_r(void *a, size_t n, size_t es, BLI_sort_cmp_t cmp, void *thunk)
+{
+  if (n <= 1) {
+    return;
+  }
+
+  const MergeSortData data = {es, cmp, thunk};
+  char *buffer = (char *)MEM_malloc_arrayN(n, es, __func__);
+  merge_sort_recursive(data, (char *)a, buffer, n, false);
+  MEM_freeN(buffer);
+}
+
+void BLI_sort_radix_order_uint(const unsigned int *keys, unsigned int len, unsigned int *r_order)
+{
+  radix_sort_order(keys, len, r_order);
+}
+
+void BLI_sort_radix_order_int(const int *keys, unsigned int len, unsigned int *r_order)
+{
+  if (len == 0) {
+    return;
+  }
+  uint32_t *ukeys = radix_sort_keys_from_int(keys, len);
+  radix_sort_order(ukeys, len, r_order);
+  MEM_freeN(ukeys);
+}
+
+void BLI_sort_radix_order_float(const float *keys, unsigned int len, unsigned int *r_order)
+{
+  if (len == 0) {
+    return;
+  }
+  uint32_t *ukeys = radix_sort_keys_from_float(keys, len);
+  radix_sort_order(ukeys, len, r_order);
+  MEM_freeN(ukeys);
+}
@@ -27,20 +27,39 @@
 #include <memory>
 #include <vector>
 
+#include "task_scheduler_intern.hh"
+
 #ifdef WITH_TBB
-/* Quiet top level deprecation message, unrelated to API usage here. */
-#  define TBB_SUPPRESS_DEPRECATED_MESSAGES 1
 #  include <tbb/flow_graph.h>
-#  include <tbb/tbb.h>
 #endif
 
 /* Task Graph */
 struct TaskGraph {
+  TaskPriority priority;
 #ifdef WITH_TBB
-  tbb::flow::graph tbb_graph;
+#  ifndef WITH_TBB_ARENA_PRIORITY
+  tbb::task_group_context tbb_context;
+#  endif
+  std::unique_ptr<tbb::flow::graph> tbb_graph;
 #endif
   std::vector<std::unique_ptr<TaskNode>> nodes;
 
+  TaskGraph(TaskPriority priority) : priority(priority)
+  {
+#ifdef WITH_TBB
+#  ifndef WITH_TBB_ARENA_PRIORITY
+    if (priority == TASK_PRIORITY_LOW) {
+      tbb_context.set_priority(tbb::priority_low);
+    }
+    tbb_graph = std::make_unique<tbb::flow::graph>(tbb_context);
+#  else
+    /* The graph spawns its tasks in the arena it was created in. */
+    task_scheduler_arena_execute(priority,
+                                 [&] { tbb_graph = std::make_unique<tbb::flow::graph>(); });
+#  endif
+#endif
+  }
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("task_graph:TaskGraph")
 #endif
@@ -61,6 +80,8 @@ struct TaskNode {
   /* Optional callback to free task data along with the graph. If task data
    * is shared between nodes, only a single task node should free the data. */
   TaskGraphNodeFreeFunction free_func;
+  /* Priority of the graph, for profiling. */
+  TaskPriority priority;
 
   TaskNode(TaskGraph *task_graph,
            TaskGraphNodeRunFunction run_func,
@@ -68,17 +89,15 @@ struct TaskNode {
            TaskGraphNodeFreeFunction free_func)
       :
 #ifdef WITH_TBB
-        tbb_node(task_graph->tbb_graph,
+        tbb_node(*task_graph->tbb_graph,
                  tbb::flow::unlimited,
                  std::bind(&TaskNode::run, this, std::placeholders::_1)),
 #endif
         run_func(run_func),
         task_data(task_data),
-        free_func(free_func)
+        free_func(free_func),
+        priority(task_graph->priority)
   {
-#ifndef WITH_TBB
-    UNUSED_VARS(task_graph);
-#endif
   }
 
   TaskNode(const TaskNode &other) = delete;
@@ -94,14 +113,16 @@ struct TaskNode {
 #ifdef WITH_TBB
   tbb::flow::continue_msg run(const tbb::flow::continue_msg UNUSED(input))
   {
-    tbb::this_task_arena::isolate([this] { run_func(task_data); });
+    task_scheduler_run_task(priority, [this] {
+      tbb::this_task_arena::isolate([this] { run_func(task_data); });
+    });
     return tbb::flow::continue_msg();
   }
 #endif
 
   void run_serial()
   {
-    run_func(task_data);
+    task_scheduler_run_task(priority, [this] { run_func(task_data); });
     for (TaskNode *successor : successors) {
       successor->run_serial();
     }
@@ -112,9 +133,10 @@ struct TaskNode {
 #endif
 };
 
-TaskGraph *BLI_task_graph_create(void)
+TaskGraph *BLI_task_graph_create(TaskPriority priority)
 {
-  return new TaskGraph();
+  /* Graphs created by low priority work are low priority too. */
+  return new TaskGraph(task_scheduler_priority_clamp(priority));
 }
 
 void BLI_task_graph_free(TaskGraph *task_graph)
@@ -125,7 +147,7 @@ void BLI_task_graph_free(TaskGraph *task_graph)
 void BLI_task_graph_work_and_wait(TaskGraph *task_graph)
 {
 #ifdef WITH_TBB
-  task_graph->tbb_graph.wait_for_all();
+  task_graph->tbb_graph->wait_for_all();
 #else
   UNUSED_VARS(task_graph);
 #endif
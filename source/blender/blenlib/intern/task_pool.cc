@@ -33,11 +33,7 @@
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
-#ifdef WITH_TBB
-/* Quiet top level deprecation message, unrelated to API usage here. */
-#  define TBB_SUPPRESS_DEPRECATED_MESSAGES 1
-#  include <tbb/tbb.h>
-#endif
+#include "task_scheduler_intern.hh"
 
 /* Task
  *
@@ -112,47 +108,8 @@ class Task {
   Task &operator=(Task &&other) = delete;
 
   /* Execute task. */
-  void operator()() const
-  {
-#ifdef WITH_TBB
-    tbb::this_task_arena::isolate([this] { run(pool, taskdata); });
-#else
-    run(pool, taskdata);
-#endif
-  }
-};
-
-/* TBB Task Group.
- *
- * Subclass since there seems to be no other way to set priority. */
-
-#ifdef WITH_TBB
-class TBBTaskGroup : public tbb::task_group {
- public:
-  TBBTaskGroup(TaskPriority priority)
-  {
-#  if TBB_INTERFACE_VERSION_MAJOR >= 12
-    /* TODO: support priorities in TBB 2021, where they are only available as
-     * part of task arenas, no longer for task groups. Or remove support for
-     * task priorities if they are no longer useful. */
-    UNUSED_VARS(priority);
-#  else
-    switch (priority) {
-      case TASK_PRIORITY_LOW:
-        my_context.set_priority(tbb::priority_low);
-        break;
-      case TASK_PRIORITY_HIGH:
-        my_context.set_priority(tbb::priority_normal);
-        break;
-    }
-#  endif
-  }
-
-  ~TBBTaskGroup()
-  {
-  }
+  void operator()() const;
 };
-#endif
 
 /* Task Pool */
 
@@ -171,6 +128,8 @@ struct TaskPool {
   ThreadMutex user_mutex;
   void *userdata;
 
+  TaskPriority priority;
+
   /* TBB task pool. */
 #ifdef WITH_TBB
   TBBTaskGroup tbb_group;
@@ -184,6 +143,17 @@ struct TaskPool {
   volatile bool background_is_canceling;
 };
 
+void Task::operator()() const
+{
+  task_scheduler_run_task(pool->priority, [this] {
+#ifdef WITH_TBB
+    tbb::this_task_arena::isolate([this] { run(pool, taskdata); });
+#else
+    run(pool, taskdata);
+#endif
+  });
+}
+
 /* TBB Task Pool.
  *
  * Task pool using the TBB scheduler for tasks. When building without TBB
@@ -225,7 +195,8 @@ static void tbb_task_pool_run(TaskPool *pool, Task &&task)
 #ifdef WITH_TBB
   else if (pool->use_threads) {
     /* Execute in TBB task group. */
-    pool->tbb_group.run(std::move(task));
+    task_scheduler_arena_execute(pool->priority,
+                                 [&] { pool->tbb_group.run(std::move(task)); });
   }
 #endif
   else {
@@ -254,7 +225,7 @@ static void tbb_task_pool_work_and_wait(TaskPool *pool)
     /* This is called wait(), but internally it can actually do work. This
      * matters because we don't want recursive usage of task pools to run
      * out of threads and get stuck. */
-    pool->tbb_group.wait();
+    task_scheduler_arena_execute(pool->priority, [&] { pool->tbb_group.wait(); });
   }
 #endif
 }
@@ -264,7 +235,7 @@ static void tbb_task_pool_cancel(TaskPool *pool)
 #ifdef WITH_TBB
   if (pool->use_threads) {
     pool->tbb_group.cancel();
-    pool->tbb_group.wait();
+    task_scheduler_arena_execute(pool->priority, [&] { pool->tbb_group.wait(); });
   }
 #else
   UNUSED_VARS(pool);
@@ -380,6 +351,9 @@ static TaskPool *task_pool_create_ex(void *userdata, TaskPoolType type, TaskPrio
     type = TASK_POOL_TBB;
   }
 
+  /* Pools created by low priority work are low priority too. */
+  priority = task_scheduler_priority_clamp(priority);
+
   /* Allocate task pool. */
   TaskPool *pool = (TaskPool *)MEM_callocN(sizeof(TaskPool), "TaskPool");
 
@@ -387,6 +361,7 @@ static TaskPool *task_pool_create_ex(void *userdata, TaskPoolType type, TaskPrio
   pool->use_threads = use_threads;
 
   pool->userdata = userdata;
+  pool->priority = priority;
   BLI_mutex_init(&pool->user_mutex);
 
   switch (type) {
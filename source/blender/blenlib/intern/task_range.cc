@@ -31,11 +31,7 @@
 
 #include "atomic_ops.h"
 
-#ifdef WITH_TBB
-/* Quiet top level deprecation message, unrelated to API usage here. */
-#  define TBB_SUPPRESS_DEPRECATED_MESSAGES 1
-#  include <tbb/tbb.h>
-#endif
+#include "task_scheduler_intern.hh"
 
 #ifdef WITH_TBB
 
@@ -44,26 +40,37 @@ struct RangeTask {
   TaskParallelRangeFunc func;
   void *userdata;
   const TaskParallelSettings *settings;
+  /* Priority of the work running the loop, kept by pools created in iterations. */
+  TaskPriority priority;
 
   void *userdata_chunk;
 
   /* Root constructor. */
   RangeTask(TaskParallelRangeFunc func, void *userdata, const TaskParallelSettings *settings)
-      : func(func), userdata(userdata), settings(settings)
+      : func(func),
+        userdata(userdata),
+        settings(settings),
+        priority(task_scheduler_thread_priority)
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Copy constructor. */
   RangeTask(const RangeTask &other)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        priority(other.priority)
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Splitting constructor for parallel reduce. */
   RangeTask(RangeTask &other, tbb::split /* unused */)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        priority(other.priority)
   {
     init_chunk(settings->userdata_chunk);
   }
@@ -90,11 +97,13 @@ struct RangeTask {
   void operator()(const tbb::blocked_range<int> &r) const
   {
     tbb::this_task_arena::isolate([this, r] {
-      TaskParallelTLS tls;
-      tls.userdata_chunk = userdata_chunk;
-      for (int i = r.begin(); i != r.end(); ++i) {
-        func(userdata, i, &tls);
-      }
+      task_scheduler_thread_priority_execute(priority, [this, r] {
+        TaskParallelTLS tls;
+        tls.userdata_chunk = userdata_chunk;
+        for (int i = r.begin(); i != r.end(); ++i) {
+          func(userdata, i, &tls);
+        }
+      });
     });
   }
 
@@ -119,14 +128,22 @@ void BLI_task_parallel_range(const int start,
     const size_t grainsize = MAX2(settings->min_iter_per_thread, 1);
     const tbb::blocked_range<int> range(start, stop, grainsize);
 
+    tbb::task_group_context context;
+#  ifndef WITH_TBB_ARENA_PRIORITY
+    /* Low priority work that doesn't run in a task has no low priority context to inherit. */
+    if (task.priority == TASK_PRIORITY_LOW) {
+      context.set_priority(tbb::priority_low);
+    }
+#  endif
+
     if (settings->func_reduce) {
-      parallel_reduce(range, task);
+      parallel_reduce(range, task, context);
       if (settings->userdata_chunk) {
         memcpy(settings->userdata_chunk, task.userdata_chunk, settings->userdata_chunk_size);
       }
     }
     else {
-      parallel_for(range, task);
+      parallel_for(range, task, context);
     }
     return;
   }
@@ -25,10 +25,9 @@
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "task_scheduler_intern.hh"
+
 #ifdef WITH_TBB
-/* Quiet top level deprecation message, unrelated to API usage here. */
-#  define TBB_SUPPRESS_DEPRECATED_MESSAGES 1
-#  include <tbb/tbb.h>
 #  if TBB_INTERFACE_VERSION_MAJOR >= 10
 #    define WITH_TBB_GLOBAL_CONTROL
 #  endif
@@ -40,6 +39,14 @@ static int task_scheduler_num_threads = 1;
 #ifdef WITH_TBB_GLOBAL_CONTROL
 static tbb::global_control *task_scheduler_global_control = nullptr;
 #endif
+#ifdef WITH_TBB_ARENA_PRIORITY
+static tbb::task_arena *task_scheduler_low_priority_arena = nullptr;
+#endif
+
+thread_local TaskPriority task_scheduler_thread_priority = TASK_PRIORITY_HIGH;
+
+TaskProfileFunction task_scheduler_profile_func = nullptr;
+void *task_scheduler_profile_data = nullptr;
 
 void BLI_task_scheduler_init()
 {
@@ -63,10 +70,22 @@ void BLI_task_scheduler_init()
 #else
   task_scheduler_num_threads = BLI_system_thread_count();
 #endif
+
+#ifdef WITH_TBB_ARENA_PRIORITY
+  if (task_scheduler_low_priority_arena == nullptr) {
+    task_scheduler_low_priority_arena = OBJECT_GUARDED_NEW(tbb::task_arena,
+                                                           task_scheduler_num_threads,
+                                                           1,
+                                                           tbb::task_arena::priority::low);
+  }
+#endif
 }
 
 void BLI_task_scheduler_exit()
 {
+#ifdef WITH_TBB_ARENA_PRIORITY
+  OBJECT_GUARDED_SAFE_DELETE(task_scheduler_low_priority_arena, tbb::task_arena);
+#endif
 #ifdef WITH_TBB_GLOBAL_CONTROL
   OBJECT_GUARDED_DELETE(task_scheduler_global_control, tbb::global_control);
 #endif
@@ -76,3 +95,26 @@ int BLI_task_scheduler_num_threads()
 {
   return task_scheduler_num_threads;
 }
+
+#ifdef WITH_TBB_ARENA_PRIORITY
+tbb::task_arena *task_scheduler_arena(TaskPriority priority)
+{
+  return (priority == TASK_PRIORITY_LOW) ? task_scheduler_low_priority_arena : nullptr;
+}
+#endif
+
+void BLI_task_scheduler_run_with_priority(TaskPriority priority,
+                                          void (*func)(void *userdata),
+                                          void *userdata)
+{
+  priority = task_scheduler_priority_clamp(priority);
+  task_scheduler_arena_execute(priority, [&] {
+    task_scheduler_thread_priority_execute(priority, [&] { func(userdata); });
+  });
+}
+
+void BLI_task_scheduler_profile_set(TaskProfileFunction func, void *userdata)
+{
+  task_scheduler_profile_func = func;
+  task_scheduler_profile_data = userdata;
+}
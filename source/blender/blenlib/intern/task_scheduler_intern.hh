@@ -0,0 +1,139 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Task scheduler internals shared by task pools and task graphs.
+ */
+
+#include "BLI_task.h"
+
+#include "PIL_time.h"
+
+#ifdef WITH_TBB
+/* Quiet top level deprecation message, unrelated to API usage here. */
+#  define TBB_SUPPRESS_DEPRECATED_MESSAGES 1
+#  include <tbb/tbb.h>
+#  if TBB_INTERFACE_VERSION_MAJOR >= 12
+/* TBB 2021 only supports priorities for task arenas, no longer for task groups. */
+#    define WITH_TBB_ARENA_PRIORITY
+#  endif
+#endif
+
+/* Task Priority
+ *
+ * With TBB 2021, low priority tasks run in a separate task arena. Worker threads only join it
+ * when there is no work in arenas of higher priority. High priority tasks run in the arena of
+ * the thread that creates them, so that work created by low priority tasks stays low priority.
+ *
+ * Older TBB versions set the priority on the task group context instead, which is inherited by
+ * the contexts of nested task groups and parallel loops.
+ *
+ * Work that doesn't run in a task, like the function given to
+ * #BLI_task_scheduler_run_with_priority, has no task context to inherit. So every thread also
+ * keeps the priority of the work it is running, and task pools, task graphs and parallel loops
+ * created by it get at most that priority. */
+
+/* Priority of the work running on the current thread. */
+extern thread_local TaskPriority task_scheduler_thread_priority;
+
+/* Lower the priority to the priority of the work running on the current thread. */
+inline TaskPriority task_scheduler_priority_clamp(TaskPriority priority)
+{
+  return (task_scheduler_thread_priority == TASK_PRIORITY_LOW) ? TASK_PRIORITY_LOW : priority;
+}
+
+/* Execute function with the priority of the current thread set to the given priority. */
+template<typename Function>
+inline void task_scheduler_thread_priority_execute(TaskPriority priority,
+                                                   const Function &function)
+{
+  const TaskPriority prev_priority = task_scheduler_thread_priority;
+  task_scheduler_thread_priority = priority;
+  function();
+  task_scheduler_thread_priority = prev_priority;
+}
+
+#ifdef WITH_TBB_ARENA_PRIORITY
+tbb::task_arena *task_scheduler_arena(TaskPriority priority);
+#endif
+
+/* Execute function in the task arena of the given priority. Tasks it spawns run in the same
+ * arena. */
+template<typename Function>
+inline void task_scheduler_arena_execute(TaskPriority priority, const Function &function)
+{
+#ifdef WITH_TBB_ARENA_PRIORITY
+  tbb::task_arena *arena = task_scheduler_arena(priority);
+  if (arena != nullptr) {
+    arena->execute(function);
+    return;
+  }
+#else
+  UNUSED_VARS(priority);
+#endif
+  function();
+}
+
+/* TBB Task Group.
+ *
+ * Subclass since there seems to be no other way to set priority. High priority keeps the
+ * priority of the parent context, which is normal unless the task group is created from low
+ * priority work. */
+
+#ifdef WITH_TBB
+class TBBTaskGroup : public tbb::task_group {
+ public:
+  TBBTaskGroup(TaskPriority priority)
+  {
+#  ifdef WITH_TBB_ARENA_PRIORITY
+    /* Tasks are pushed in the arena of the priority instead. */
+    UNUSED_VARS(priority);
+#  else
+    if (priority == TASK_PRIORITY_LOW) {
+      my_context.set_priority(tbb::priority_low);
+    }
+#  endif
+  }
+
+  ~TBBTaskGroup()
+  {
+  }
+};
+#endif
+
+/* Task Profiling */
+
+extern TaskProfileFunction task_scheduler_profile_func;
+extern void *task_scheduler_profile_data;
+
+/* Run a single task, reporting its execution time if profiling is enabled. */
+template<typename Function>
+inline void task_scheduler_run_task(TaskPriority priority, const Function &function)
+{
+  const TaskProfileFunction profile_func = task_scheduler_profile_func;
+  if (profile_func == nullptr) {
+    task_scheduler_thread_priority_execute(priority, function);
+    return;
+  }
+
+  const double start_time = PIL_check_seconds_timer();
+  task_scheduler_thread_priority_execute(priority, function);
+  profile_func(task_scheduler_profile_data, priority, start_time, PIL_check_seconds_timer());
+}
@@ -21,6 +21,7 @@ extern "C" {
 
 #include "BLI_array.hh"
 #include "BLI_double2.hh"
+#include "BLI_map.hh"
 #include "BLI_math_boolean.hh"
 #include "BLI_math_mpq.hh"
 #include "BLI_mpq2.hh"
@@ -1246,6 +1247,61 @@ template<typename T> void repeattri_test()
   }
 }
 
+/* Enough points to triangulate parts of the input in parallel. Check that the output is a
+ * Delaunay triangulation: all triangles are CCW, and no vertex is inside the circumcircle of the
+ * triangle on the other side of an edge. */
+template<typename T> void manypts_test(bool grid)
+{
+  const int grid_size = 100;
+  const int npts = grid_size * grid_size;
+  Array<vec2<T>> verts(npts);
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < npts; ++i) {
+    if (grid) {
+      verts[i] = vec2<T>(T(i % grid_size), T(i / grid_size));
+    }
+    else {
+      verts[i] = vec2<T>(T(BLI_rng_get_double(rng)), T(BLI_rng_get_double(rng)));
+    }
+  }
+  BLI_rng_free(rng);
+
+  CDT_input<T> in;
+  in.vert = verts;
+  in.epsilon = T(0);
+  CDT_result<T> out = delaunay_2d_calc(in, CDT_FULL);
+  EXPECT_EQ(out.vert.size(), npts);
+  if (grid) {
+    EXPECT_EQ(out.face.size(), 2 * (grid_size - 1) * (grid_size - 1));
+  }
+
+  /* Opposite vertex of each directed edge of a triangle, keyed by `v1 * npts + v2`. */
+  Map<int64_t, int> opposite;
+  for (const Vector<int> &face : out.face) {
+    ASSERT_EQ(face.size(), 3);
+    EXPECT_GT(orient2d(out.vert[face[0]], out.vert[face[1]], out.vert[face[2]]), 0);
+    for (int i = 0; i < 3; ++i) {
+      const int64_t key = int64_t(face[i]) * npts + face[(i + 1) % 3];
+      opposite.add_new(key, face[(i + 2) % 3]);
+    }
+  }
+  int nhull = 0;
+  for (const Map<int64_t, int>::Item item : opposite.items()) {
+    const int v1 = int(item.key / npts);
+    const int v2 = int(item.key % npts);
+    const int *v_other = opposite.lookup_ptr(int64_t(v2) * npts + v1);
+    if (v_other == nullptr) {
+      nhull++;
+      continue;
+    }
+    EXPECT_LE(
+        incircle(out.vert[v1], out.vert[v2], out.vert[item.value], out.vert[*v_other]), 0);
+  }
+  if (grid) {
+    EXPECT_EQ(nhull, 4 * (grid_size - 1));
+  }
+}
+
 TEST(delaunay_d, Empty)
 {
   empty_test<double>();
@@ -1371,6 +1427,16 @@ TEST(delaunay_d, RepeatTri)
   repeattri_test<double>();
 }
 
+TEST(delaunay_d, ManyPts)
+{
+  manypts_test<double>(false);
+}
+
+TEST(delaunay_d, ManyPtsGrid)
+{
+  manypts_test<double>(true);
+}
+
 #  ifdef WITH_GMP
 TEST(delaunay_m, Empty)
 {
@@ -1495,6 +1561,16 @@ TEST(delaunay_m, RepeatTri)
 {
   repeattri_test<mpq_class>();
 }
+
+TEST(delaunay_m, ManyPts)
+{
+  manypts_test<mpq_class>(false);
+}
+
+TEST(delaunay_m, ManyPtsGrid)
+{
+  manypts_test<mpq_class>(true);
+}
 #  endif
 
 #endif
@@ -0,0 +1,146 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_hash_md5.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_hash_mm3.h"
+#include "BLI_hash_stripe.h"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+static Vector<unsigned char> test_data(const int len)
+{
+  Vector<unsigned char> data(len);
+  for (int i = 0; i < len; i++) {
+    data[i] = (unsigned char)(i * 7 + (i >> 8));
+  }
+  return data;
+}
+
+/* The hash is endian independent and the same with or without SSE2, so the reference results
+ * are the same on all platforms. */
+TEST(hash_stripe, Basic)
+{
+  const char *data = "Blender";
+  EXPECT_EQ(BLI_hash_stripe(data, strlen(data), 0), 10780774994928861348ULL);
+  EXPECT_EQ(BLI_hash_stripe(nullptr, 0, 0), 5519903123016696813ULL);
+
+  Vector<unsigned char> buffer = test_data(5000);
+  EXPECT_EQ(BLI_hash_stripe(buffer.data(), buffer.size(), 0), 9343172244507587168ULL);
+  EXPECT_EQ(BLI_hash_stripe(buffer.data(), buffer.size(), 42), 18223179002812540492ULL);
+
+  uint64_t hash[2];
+  BLI_hash_stripe_128(buffer.data(), buffer.size(), 0, hash);
+  EXPECT_EQ(hash[0], 9343172244507587168ULL);
+  EXPECT_EQ(hash[1], 13272522467536697663ULL);
+}
+
+/* Adding data in pieces gives the same hash as adding it at once, regardless of where it is
+ * split relative to stripes and blocks. */
+TEST(hash_stripe, Streaming)
+{
+  Vector<unsigned char> buffer = test_data(5000);
+  const uint64_t reference = BLI_hash_stripe(buffer.data(), buffer.size(), 7);
+
+  for (const int piece_len : {1, 3, 63, 64, 65, 1000, 1024, 4999}) {
+    BLI_HashStripe state;
+    BLI_hash_stripe_init(&state, 7);
+    for (int offset = 0; offset < buffer.size(); offset += piece_len) {
+      const int len = std::min(piece_len, int(buffer.size()) - offset);
+      BLI_hash_stripe_add(&state, buffer.data() + offset, len);
+    }
+    EXPECT_EQ(BLI_hash_stripe_end(&state), reference);
+  }
+
+  /* Ending does not change the state. */
+  BLI_HashStripe state;
+  BLI_hash_stripe_init(&state, 7);
+  BLI_hash_stripe_add(&state, buffer.data(), 100);
+  const uint64_t partial = BLI_hash_stripe_end(&state);
+  EXPECT_EQ(partial, BLI_hash_stripe(buffer.data(), 100, 7));
+  BLI_hash_stripe_add(&state, buffer.data() + 100, buffer.size() - 100);
+  EXPECT_EQ(BLI_hash_stripe_end(&state), reference);
+}
+
+/* Short inputs are zero padded, the length must still make a difference. */
+TEST(hash_stripe, Length)
+{
+  const unsigned char data[4] = {1, 2, 0, 0};
+  const uint64_t hash_2 = BLI_hash_stripe(data, 2, 0);
+  const uint64_t hash_3 = BLI_hash_stripe(data, 3, 0);
+  const uint64_t hash_4 = BLI_hash_stripe(data, 4, 0);
+  EXPECT_NE(hash_2, hash_3);
+  EXPECT_NE(hash_2, hash_4);
+  EXPECT_NE(hash_3, hash_4);
+}
+
+/* Flipping any single bit changes the hash. */
+TEST(hash_stripe, BitFlips)
+{
+  Vector<unsigned char> buffer = test_data(1100);
+  const uint64_t reference = BLI_hash_stripe(buffer.data(), buffer.size(), 0);
+
+  for (int byte = 0; byte < buffer.size(); byte += 13) {
+    for (int bit = 0; bit < 8; bit++) {
+      buffer[byte] ^= (unsigned char)(1 << bit);
+      EXPECT_NE(BLI_hash_stripe(buffer.data(), buffer.size(), 0), reference);
+      buffer[byte] ^= (unsigned char)(1 << bit);
+    }
+  }
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
+ */
+#if 0
+TEST(hash_stripe, Benchmark)
+{
+  const int len = 256 * 1024 * 1024;
+  Vector<unsigned char> buffer = test_data(len);
+  uint64_t result = 0;
+
+  for (int i = 0; i < 3; i++) {
+    {
+      SCOPED_TIMER("Stripe 256 MB");
+      result += BLI_hash_stripe(buffer.data(), len, 0);
+    }
+    {
+      SCOPED_TIMER("Stripe 128 bit 256 MB");
+      uint64_t hash[2];
+      BLI_hash_stripe_128(buffer.data(), len, 0, hash);
+      result += hash[1];
+    }
+    {
+      SCOPED_TIMER("Stripe streaming 256 MB in 100 byte pieces");
+      BLI_HashStripe state;
+      BLI_hash_stripe_init(&state, 0);
+      for (int offset = 0; offset < len; offset += 100) {
+        BLI_hash_stripe_add(&state, buffer.data() + offset, std::min(100, len - offset));
+      }
+      result += BLI_hash_stripe_end(&state);
+    }
+    {
+      SCOPED_TIMER("MM2 256 MB");
+      result += BLI_hash_mm2(buffer.data(), len, 0);
+    }
+    {
+      SCOPED_TIMER("MM3 256 MB");
+      result += BLI_hash_mm3(buffer.data(), len, 0);
+    }
+    {
+      SCOPED_TIMER("MD5 256 MB");
+      unsigned char digest[16];
+      BLI_hash_md5_buffer((const char *)buffer.data(), len, digest);
+      result += digest[0];
+    }
+    std::cout << "\n";
+  }
+  EXPECT_NE(result, 0);
+}
+
+#endif /* Benchmark */
+
+}  // namespace blender::tests
@@ -132,3 +132,127 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/* Large enough to build sub-trees in parallel and have more branches than a balanced tree. */
+TEST(kdopbvh, FindNearest_10000)
+{
+  find_nearest_points_test(10000, 1.0, 1000, 42);
+}
+
+static BVHTree *random_boxes_tree(struct RNG *rng, int boxes_len, char tree_type, char axis)
+{
+  BVHTree *tree = BLI_bvhtree_new(boxes_len, 0.0, tree_type, axis);
+  for (int i = 0; i < boxes_len; i++) {
+    float box[2][3];
+    rng_v3_round(box[0], 3, rng, 1000, 1.0f);
+    for (int j = 0; j < 3; j++) {
+      box[1][j] = box[0][j] + BLI_rng_get_float(rng) * 0.05f;
+    }
+    BLI_bvhtree_insert(tree, i, box[0], 2);
+  }
+  BLI_bvhtree_balance(tree);
+  return tree;
+}
+
+static void find_nearest_batch_test(
+    int boxes_len, int points_len, char tree_type, char axis, int seed)
+{
+  struct RNG *rng = BLI_rng_new(seed);
+  BVHTree *tree = random_boxes_tree(rng, boxes_len, tree_type, axis);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(BVHTreeNearest) * points_len,
+                                                          __func__);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.5f);
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+
+  BLI_bvhtree_find_nearest_batch(tree, points, points_len, nearest, nullptr, nullptr);
+
+  for (int i = 0; i < points_len; i++) {
+    BVHTreeNearest expected;
+    expected.index = -1;
+    expected.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, points[i], &expected, nullptr, nullptr);
+
+    /* Points inside of overlapping boxes have distance ties, the same box should be found. */
+    EXPECT_EQ(nearest[i].index, expected.index);
+    EXPECT_EQ(nearest[i].dist_sq, expected.dist_sq);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(nearest);
+}
+
+static void ray_cast_batch_test(int boxes_len, int rays_len, float radius, char axis, int seed)
+{
+  struct RNG *rng = BLI_rng_new(seed);
+  BVHTree *tree = random_boxes_tree(rng, boxes_len, 4, axis);
+
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(BVHTreeRayHit) * rays_len, __func__);
+  for (int i = 0; i < rays_len; i++) {
+    rng_v3_round(co[i], 3, rng, 1000, 1.5f);
+    BLI_rng_get_float_unit_v3(rng, dir[i]);
+    /* Some rays along the axes. */
+    if (i % 7 == 0) {
+      zero_v3(dir[i]);
+      dir[i][i % 3] = 1.0f;
+    }
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  BLI_bvhtree_ray_cast_batch(
+      tree, co, dir, rays_len, radius, hits, nullptr, nullptr, BVH_RAYCAST_DEFAULT);
+
+  int hits_len = 0;
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit expected;
+    expected.index = -1;
+    expected.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, co[i], dir[i], radius, &expected, nullptr, nullptr);
+
+    EXPECT_EQ(hits[i].index, expected.index);
+    EXPECT_EQ(hits[i].dist, expected.dist);
+    hits_len += (expected.index != -1);
+  }
+  EXPECT_GT(hits_len, 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(hits);
+}
+
+TEST(kdopbvh, FindNearestBatch_Binary)
+{
+  find_nearest_batch_test(2000, 1001, 2, 6, 12);
+}
+TEST(kdopbvh, FindNearestBatch_Octree)
+{
+  find_nearest_batch_test(2000, 1001, 8, 6, 34);
+}
+TEST(kdopbvh, FindNearestBatch_KDop14)
+{
+  find_nearest_batch_test(2000, 1001, 4, 14, 90);
+}
+
+TEST(kdopbvh, RayCastBatch)
+{
+  ray_cast_batch_test(2000, 1001, 0.0f, 6, 56);
+}
+TEST(kdopbvh, RayCastBatch_Radius)
+{
+  ray_cast_batch_test(2000, 1001, 0.01f, 6, 78);
+}
+TEST(kdopbvh, RayCastBatch_KDop14)
+{
+  ray_cast_batch_test(2000, 1001, 0.0f, 14, 91);
+}
@@ -0,0 +1,176 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_task.h"
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+static float (*random_coords(int coords_len, int seed))[3]
+{
+  float(*coords)[3] = (float(*)[3])MEM_malloc_arrayN(coords_len, sizeof(*coords), __func__);
+  RNG *rng = BLI_rng_new(seed);
+  for (int i = 0; i < coords_len; i++) {
+    BLI_rng_get_float_unit_v3(rng, coords[i]);
+    mul_v3_fl(coords[i], BLI_rng_get_float(rng));
+  }
+  BLI_rng_free(rng);
+  return coords;
+}
+
+static KDTree_3d *kdtree_from_coords(const float (*coords)[3], int coords_len)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new((uint)coords_len);
+  for (int i = 0; i < coords_len; i++) {
+    BLI_kdtree_3d_insert(tree, i, coords[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  return tree;
+}
+
+static int find_nearest_brute_force(const float (*coords)[3], int coords_len, const float co[3])
+{
+  int nearest = -1;
+  float nearest_dist_sq = FLT_MAX;
+  for (int i = 0; i < coords_len; i++) {
+    const float dist_sq = len_squared_v3v3(coords[i], co);
+    if (dist_sq < nearest_dist_sq) {
+      nearest_dist_sq = dist_sq;
+      nearest = i;
+    }
+  }
+  return nearest;
+}
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+TEST(kdtree, Empty)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(0);
+  BLI_kdtree_3d_balance(tree);
+  const float co[3] = {0.0f, 0.0f, 0.0f};
+  EXPECT_EQ(-1, BLI_kdtree_3d_find_nearest(tree, co, nullptr));
+
+  KDTreeNearest_3d nearest;
+  BLI_kdtree_3d_find_nearest_batch(tree, &co, 1, &nearest);
+  EXPECT_EQ(-1, nearest.index);
+  BLI_kdtree_3d_free(tree);
+}
+
+/* Large enough to balance the tree in multiple tasks. */
+TEST(kdtree, FindNearestLarge)
+{
+  const int coords_len = 50000;
+  float(*coords)[3] = random_coords(coords_len, 1);
+
+  BLI_task_scheduler_init();
+  KDTree_3d *tree = kdtree_from_coords(coords, coords_len);
+
+  const int queries_len = 100;
+  float(*queries)[3] = random_coords(queries_len, 2);
+  for (int i = 0; i < queries_len; i++) {
+    KDTreeNearest_3d nearest;
+    EXPECT_EQ(find_nearest_brute_force(coords, coords_len, queries[i]),
+              BLI_kdtree_3d_find_nearest(tree, queries[i], &nearest));
+  }
+
+  /* Every point is its own nearest. */
+  for (int i = 0; i < coords_len; i += 97) {
+    EXPECT_EQ(i, BLI_kdtree_3d_find_nearest(tree, coords[i], nullptr));
+  }
+
+  BLI_kdtree_3d_free(tree);
+  BLI_task_scheduler_exit();
+  MEM_freeN(queries);
+  MEM_freeN(coords);
+}
+
+TEST(kdtree, Batch)
+{
+  const int coords_len = 5000;
+  float(*coords)[3] = random_coords(coords_len, 3);
+
+  BLI_task_scheduler_init();
+  KDTree_3d *tree = kdtree_from_coords(coords, coords_len);
+
+  const uint queries_len = 1000;
+  const uint nearest_len_capacity = 4;
+  const float range = 0.1f;
+  float(*queries)[3] = random_coords(queries_len, 4);
+
+  KDTreeNearest_3d *nearest = (KDTreeNearest_3d *)MEM_malloc_arrayN(
+      queries_len, sizeof(*nearest), __func__);
+  KDTreeNearest_3d *nearest_n = (KDTreeNearest_3d *)MEM_malloc_arrayN(
+      queries_len * nearest_len_capacity, sizeof(*nearest_n), __func__);
+  int *nearest_n_len = (int *)MEM_malloc_arrayN(queries_len, sizeof(int), __func__);
+  KDTreeNearest_3d **nearest_range = (KDTreeNearest_3d **)MEM_malloc_arrayN(
+      queries_len, sizeof(*nearest_range), __func__);
+  int *nearest_range_len = (int *)MEM_malloc_arrayN(queries_len, sizeof(int), __func__);
+
+  BLI_kdtree_3d_find_nearest_batch(tree, queries, queries_len, nearest);
+  BLI_kdtree_3d_find_nearest_n_batch(
+      tree, queries, queries_len, nearest_n, nearest_len_capacity, nearest_n_len);
+  BLI_kdtree_3d_range_search_batch(
+      tree, queries, queries_len, range, nearest_range, nearest_range_len);
+
+  for (uint i = 0; i < queries_len; i++) {
+    EXPECT_EQ(BLI_kdtree_3d_find_nearest(tree, queries[i], nullptr), nearest[i].index);
+
+    KDTreeNearest_3d expected_n[nearest_len_capacity];
+    const int expected_n_len = BLI_kdtree_3d_find_nearest_n(
+        tree, queries[i], expected_n, nearest_len_capacity);
+    ASSERT_EQ(expected_n_len, nearest_n_len[i]);
+    for (int j = 0; j < expected_n_len; j++) {
+      EXPECT_EQ(expected_n[j].index, nearest_n[i * nearest_len_capacity + (uint)j].index);
+    }
+
+    KDTreeNearest_3d *expected_range = nullptr;
+    const int expected_range_len = BLI_kdtree_3d_range_search(
+        tree, queries[i], &expected_range, range);
+    ASSERT_EQ(expected_range_len, nearest_range_len[i]);
+    for (int j = 0; j < expected_range_len; j++) {
+      EXPECT_EQ(expected_range[j].dist, nearest_range[i][j].dist);
+      EXPECT_LE(nearest_range[i][j].dist, range);
+    }
+    MEM_SAFE_FREE(expected_range);
+    MEM_SAFE_FREE(nearest_range[i]);
+  }
+
+  MEM_freeN(nearest);
+  MEM_freeN(nearest_n);
+  MEM_freeN(nearest_n_len);
+  MEM_freeN(nearest_range);
+  MEM_freeN(nearest_range_len);
+  MEM_freeN(queries);
+
+  BLI_kdtree_3d_free(tree);
+  BLI_task_scheduler_exit();
+  MEM_freeN(coords);
+}
+
+/* Range searches with many results grow the result array multiple times. */
+TEST(kdtree, RangeSearchLarge)
+{
+  const int coords_len = 20000;
+  float(*coords)[3] = random_coords(coords_len, 5);
+  KDTree_3d *tree = kdtree_from_coords(coords, coords_len);
+
+  const float co[3] = {0.0f, 0.0f, 0.0f};
+  KDTreeNearest_3d *nearest = nullptr;
+  const int nearest_len = BLI_kdtree_3d_range_search(tree, co, &nearest, 2.0f);
+  EXPECT_EQ(coords_len, nearest_len);
+  for (int i = 1; i < nearest_len; i++) {
+    EXPECT_LE(nearest[i - 1].dist, nearest[i].dist);
+  }
+
+  MEM_freeN(nearest);
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(coords);
+}
@@ -0,0 +1,113 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "BLI_rand.h"
+#include "BLI_sort.h"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+struct SortElem {
+  int key;
+  int index;
+};
+
+static int sort_elem_cmp(const void *a, const void *b, void *UNUSED(thunk))
+{
+  const SortElem *elem_a = (const SortElem *)a;
+  const SortElem *elem_b = (const SortElem *)b;
+  return (elem_a->key > elem_b->key) - (elem_a->key < elem_b->key);
+}
+
+/* Keys with many duplicates, so stability makes a difference. */
+static Vector<SortElem> random_elems(const int len, const int key_range)
+{
+  RNG *rng = BLI_rng_new(0);
+  Vector<SortElem> elems(len);
+  for (int i = 0; i < len; i++) {
+    elems[i] = {BLI_rng_get_int(rng) % key_range, i};
+  }
+  BLI_rng_free(rng);
+  return elems;
+}
+
+TEST(sort, MergeSortStable)
+{
+  for (const int len : {0, 1, 2, 15, 17, 1000, 100000}) {
+    Vector<SortElem> elems = random_elems(len, 100);
+    Vector<SortElem> expected = elems;
+    std::stable_sort(expected.begin(), expected.end(), [](const SortElem &a, const SortElem &b) {
+      return a.key < b.key;
+    });
+
+    BLI_sort_merge_r(elems.data(), elems.size(), sizeof(SortElem), sort_elem_cmp, nullptr);
+
+    for (const int i : elems.index_range()) {
+      EXPECT_EQ(elems[i].key, expected[i].key);
+      EXPECT_EQ(elems[i].index, expected[i].index);
+    }
+  }
+}
+
+template<typename T, typename Fn>
+static void test_radix_order(const Vector<T> &keys, const Fn &radix_order_fn)
+{
+  Vector<unsigned int> expected(keys.size());
+  for (const int i : keys.index_range()) {
+    expected[i] = (unsigned int)i;
+  }
+  std::stable_sort(expected.begin(), expected.end(), [&](unsigned int a, unsigned int b) {
+    return keys[a] < keys[b];
+  });
+
+  Vector<unsigned int> order(keys.size());
+  radix_order_fn(keys.data(), (unsigned int)keys.size(), order.data());
+  EXPECT_EQ_ARRAY(order.data(), expected.data(), keys.size());
+}
+
+TEST(sort, RadixSortUInt)
+{
+  for (const int len : {1, 100, 200000}) {
+    RNG *rng = BLI_rng_new(len);
+    Vector<unsigned int> keys(len);
+    for (const int i : keys.index_range()) {
+      /* Small keys so that passes for the upper digits are skipped. */
+      keys[i] = (i % 2) ? BLI_rng_get_uint(rng) : BLI_rng_get_uint(rng) % 1000;
+    }
+    BLI_rng_free(rng);
+    test_radix_order(keys, BLI_sort_radix_order_uint);
+  }
+}
+
+TEST(sort, RadixSortInt)
+{
+  for (const int len : {1, 100, 200000}) {
+    RNG *rng = BLI_rng_new(len);
+    Vector<int> keys(len);
+    for (const int i : keys.index_range()) {
+      keys[i] = BLI_rng_get_int(rng) % 2000 - 1000;
+    }
+    BLI_rng_free(rng);
+    test_radix_order(keys, BLI_sort_radix_order_int);
+  }
+}
+
+TEST(sort, RadixSortFloat)
+{
+  Vector<float> keys = {3.0f, -0.5f, INFINITY, 0.0f, -INFINITY, 1e-30f, -1e30f, 3.0f, -0.5f};
+  test_radix_order(keys, BLI_sort_radix_order_float);
+
+  RNG *rng = BLI_rng_new(0);
+  keys.resize(200000);
+  for (const int i : keys.index_range()) {
+    keys[i] = (BLI_rng_get_float(rng) - 0.5f) * 1000.0f;
+  }
+  BLI_rng_free(rng);
+  test_radix_order(keys, BLI_sort_radix_order_float);
+}
+
+}  // namespace blender::tests
@@ -2,6 +2,8 @@
 
 #include "testing/testing.h"
 
+#include "atomic_ops.h"
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_task.h"
@@ -49,7 +51,7 @@ static void TaskData_square_value(void *taskdata)
 TEST(task, GraphSequential)
 {
   TaskData data = {0};
-  TaskGraph *graph = BLI_task_graph_create();
+  TaskGraph *graph = BLI_task_graph_create(TASK_PRIORITY_HIGH);
 
   /* 0 => 1 */
   TaskNode *node_a = BLI_task_graph_node_create(graph, TaskData_increase_value, &data, nullptr);
@@ -80,7 +82,7 @@ TEST(task, GraphSequential)
 TEST(task, GraphStartAtAnyNode)
 {
   TaskData data = {4};
-  TaskGraph *graph = BLI_task_graph_create();
+  TaskGraph *graph = BLI_task_graph_create(TASK_PRIORITY_HIGH);
 
   TaskNode *node_a = BLI_task_graph_node_create(graph, TaskData_increase_value, &data, nullptr);
   TaskNode *node_b = BLI_task_graph_node_create(
@@ -108,7 +110,7 @@ TEST(task, GraphSplit)
 {
   TaskData data = {1};
 
-  TaskGraph *graph = BLI_task_graph_create();
+  TaskGraph *graph = BLI_task_graph_create(TASK_PRIORITY_HIGH);
   TaskNode *node_a = BLI_task_graph_node_create(graph, TaskData_increase_value, &data, nullptr);
   TaskNode *node_b = BLI_task_graph_node_create(graph, TaskData_store_value, &data, nullptr);
   TaskNode *node_c = BLI_task_graph_node_create(graph, TaskData_increase_value, &data, nullptr);
@@ -130,7 +132,7 @@ TEST(task, GraphForest)
   TaskData data1 = {1};
   TaskData data2 = {3};
 
-  TaskGraph *graph = BLI_task_graph_create();
+  TaskGraph *graph = BLI_task_graph_create(TASK_PRIORITY_HIGH);
 
   {
     TaskNode *tree1_node_a = BLI_task_graph_node_create(
@@ -174,7 +176,7 @@ TEST(task, GraphForest)
 TEST(task, GraphTaskData)
 {
   TaskData data = {0};
-  TaskGraph *graph = BLI_task_graph_create();
+  TaskGraph *graph = BLI_task_graph_create(TASK_PRIORITY_HIGH);
   TaskNode *node_a = BLI_task_graph_node_create(
       graph, TaskData_store_value, &data, TaskData_increase_value);
   TaskNode *node_b = BLI_task_graph_node_create(graph, TaskData_store_value, &data, nullptr);
@@ -188,3 +190,54 @@ TEST(task, GraphTaskData)
   EXPECT_EQ(1, data.value);
   EXPECT_EQ(0, data.store);
 }
+
+struct TaskProfileData {
+  int low_count;
+  int high_count;
+  bool valid_times;
+};
+
+static void TaskData_profile(void *userdata,
+                             TaskPriority priority,
+                             double start_time,
+                             double end_time)
+{
+  TaskProfileData *profile = (TaskProfileData *)userdata;
+  if (priority == TASK_PRIORITY_LOW) {
+    atomic_add_and_fetch_int32(&profile->low_count, 1);
+  }
+  else {
+    atomic_add_and_fetch_int32(&profile->high_count, 1);
+  }
+  if (end_time < start_time) {
+    profile->valid_times = false;
+  }
+}
+
+TEST(task, GraphLowPriorityProfile)
+{
+  TaskProfileData profile = {0, 0, true};
+  BLI_task_scheduler_init();
+  BLI_task_scheduler_profile_set(TaskData_profile, &profile);
+
+  TaskData data = {0};
+  TaskGraph *graph = BLI_task_graph_create(TASK_PRIORITY_LOW);
+  TaskNode *node_a = BLI_task_graph_node_create(graph, TaskData_increase_value, &data, nullptr);
+  TaskNode *node_b = BLI_task_graph_node_create(
+      graph, TaskData_multiply_by_two_value, &data, nullptr);
+  TaskNode *node_c = BLI_task_graph_node_create(graph, TaskData_store_value, &data, nullptr);
+  BLI_task_graph_edge_create(node_a, node_b);
+  BLI_task_graph_edge_create(node_b, node_c);
+  EXPECT_TRUE(BLI_task_graph_node_push_work(node_a));
+  BLI_task_graph_work_and_wait(graph);
+  BLI_task_graph_free(graph);
+
+  BLI_task_scheduler_profile_set(nullptr, nullptr);
+  BLI_task_scheduler_exit();
+
+  EXPECT_EQ(2, data.value);
+  EXPECT_EQ(2, data.store);
+  EXPECT_EQ(3, profile.low_count);
+  EXPECT_EQ(0, profile.high_count);
+  EXPECT_TRUE(profile.valid_times);
+}
@@ -181,3 +181,104 @@ TEST(task, ListBaseIter)
   MEM_freeN(items_buffer);
   BLI_threadapi_exit();
 }
+
+/* *** Task pools used from low priority work. *** */
+
+static void task_pool_add_func(TaskPool *__restrict pool, void *taskdata)
+{
+  int *sum = (int *)BLI_task_pool_user_data(pool);
+  atomic_add_and_fetch_int32(sum, POINTER_AS_INT(taskdata));
+}
+
+static void task_pool_low_priority_func(void *userdata)
+{
+  TaskPool *pool = BLI_task_pool_create(userdata, TASK_PRIORITY_HIGH);
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    BLI_task_pool_push(pool, task_pool_add_func, POINTER_FROM_INT(i), false, nullptr);
+  }
+  BLI_task_pool_work_and_wait(pool);
+  BLI_task_pool_free(pool);
+}
+
+static void task_range_low_priority_iter_func(void *userdata,
+                                              const int UNUSED(index),
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  task_pool_low_priority_func(userdata);
+}
+
+static void task_range_low_priority_func(void *userdata)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, 4, userdata, task_range_low_priority_iter_func, &settings);
+}
+
+/* Count the tasks that ran with low priority. */
+static void task_pool_profile_func(void *userdata,
+                                   TaskPriority priority,
+                                   double start_time,
+                                   double end_time)
+{
+  if (priority == TASK_PRIORITY_LOW && end_time >= start_time) {
+    atomic_add_and_fetch_int32((int *)userdata, 1);
+  }
+}
+
+TEST(task, PoolRunWithPriority)
+{
+  int sum = 0;
+  int num_profiled = 0;
+
+  BLI_threadapi_init();
+  BLI_task_scheduler_init();
+  BLI_task_scheduler_profile_set(task_pool_profile_func, &num_profiled);
+
+  BLI_task_scheduler_run_with_priority(TASK_PRIORITY_LOW, task_pool_low_priority_func, &sum);
+
+  BLI_task_scheduler_profile_set(nullptr, nullptr);
+  BLI_task_scheduler_exit();
+  BLI_threadapi_exit();
+
+  EXPECT_EQ(sum, NUM_ITEMS * (NUM_ITEMS - 1) / 2);
+  EXPECT_EQ(num_profiled, NUM_ITEMS);
+}
+
+TEST(task, PoolRunWithHighPriority)
+{
+  int sum = 0;
+  int num_profiled = 0;
+
+  BLI_threadapi_init();
+  BLI_task_scheduler_init();
+  BLI_task_scheduler_profile_set(task_pool_profile_func, &num_profiled);
+
+  BLI_task_scheduler_run_with_priority(TASK_PRIORITY_HIGH, task_pool_low_priority_func, &sum);
+
+  BLI_task_scheduler_profile_set(nullptr, nullptr);
+  BLI_task_scheduler_exit();
+  BLI_threadapi_exit();
+
+  EXPECT_EQ(sum, NUM_ITEMS * (NUM_ITEMS - 1) / 2);
+  EXPECT_EQ(num_profiled, 0);
+}
+
+TEST(task, PoolInRangeRunWithPriority)
+{
+  int sum = 0;
+  int num_profiled = 0;
+
+  BLI_threadapi_init();
+  BLI_task_scheduler_init();
+  BLI_task_scheduler_profile_set(task_pool_profile_func, &num_profiled);
+
+  BLI_task_scheduler_run_with_priority(TASK_PRIORITY_LOW, task_range_low_priority_func, &sum);
+
+  BLI_task_scheduler_profile_set(nullptr, nullptr);
+  BLI_task_scheduler_exit();
+  BLI_threadapi_exit();
+
+  EXPECT_EQ(sum, 4 * NUM_ITEMS * (NUM_ITEMS - 1) / 2);
+  EXPECT_EQ(num_profiled, 4 * NUM_ITEMS);
+}
@@ -158,6 +158,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
 {
   MemFile *memfile = mem_data->written_memfile;
   MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
+  const eMEM_Tag tag_prev = MEM_tag_set(MEM_TAG_UNDO);
 
   MemFileChunk *curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
   curchunk->size = size;
@@ -190,6 +191,8 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     curchunk->buf = buf_new;
     memfile->size += size;
   }
+
+  MEM_tag_set(tag_prev);
 }
 
 struct Main *BLO_memfile_main_get(struct MemFile *memfile,
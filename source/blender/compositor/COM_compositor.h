@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include "BLI_sys_types.h"
+
 #include "DNA_color_types.h"
 #include "DNA_node_types.h"
 
@@ -353,6 +355,43 @@ void COM_execute(RenderData *rd,
  */
 void COM_deinitialize(void);
 
+/**
+ * \brief Execution statistics of a node, recorded when NTREE_COM_PROFILE is enabled.
+ * \note Operations are evaluated interleaved per pixel. Their time is estimated by timing a
+ * sample of the pixels, and scaled so that all nodes add up to the measured time.
+ */
+typedef struct CompositorNodeStatistics {
+  /** CPU time spent in seconds, summed over all threads. */
+  double time;
+  /** Number of chunks that were executed. */
+  int chunks;
+  /** Bytes of memory buffers allocated. */
+  size_t memory;
+  /** Number of output pixels of the executed chunks. */
+  uint64_t chunk_pixels;
+  /** Number of input pixels read by the executed chunks, the overhead of the area of interest
+   * is the ratio of this and chunk_pixels. */
+  uint64_t area_of_interest_pixels;
+} CompositorNodeStatistics;
+
+/**
+ * \brief Get the statistics of a node of the last profiled execution of the scene.
+ * \return false when no statistics were recorded for the node.
+ */
+bool COM_profiler_node_statistics(const struct Scene *scene,
+                                  bNodeInstanceKey key,
+                                  CompositorNodeStatistics *r_statistics);
+
+/**
+ * \brief Get the CPU time in seconds of the last profiled execution of the scene.
+ */
+double COM_profiler_total_time(const struct Scene *scene);
+
+/**
+ * \brief Free all recorded execution statistics.
+ */
+void COM_profiler_clear(void);
+
 /**
  * \brief Clear all compositor caches. (Compositor system will still remain available).
  * To deinitialize the compositor use the COM_deinitialize method.
@@ -17,6 +17,7 @@
  */
 
 #include "COM_CPUDevice.h"
+#include "COM_Profiler.h"
 
 CPUDevice::CPUDevice(int thread_id) : m_thread_id(thread_id)
 {
@@ -30,7 +31,9 @@ void CPUDevice::execute(WorkPackage *work)
 
   executionGroup->determineChunkRect(&rect, chunkNumber);
 
+  Profiler::chunk_started(executionGroup);
   executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
+  Profiler::chunk_finished(executionGroup, false);
 
   executionGroup->finalizeChunkExecution(chunkNumber, nullptr);
 }
@@ -77,6 +77,11 @@ class CompositorContext {
    */
   bool m_fastCalculation;
 
+  /**
+   * \brief Reduce the resolution of the evaluation by this factor, 1 for full resolution.
+   */
+  int m_resolutionDivider;
+
   /* \brief color management settings */
   const ColorManagedViewSettings *m_viewSettings;
   const ColorManagedDisplaySettings *m_displaySettings;
@@ -263,6 +268,22 @@ class CompositorContext {
   {
     return this->m_fastCalculation;
   }
+  void setResolutionDivider(int resolutionDivider)
+  {
+    this->m_resolutionDivider = resolutionDivider;
+  }
+  int getResolutionDivider() const
+  {
+    return this->m_resolutionDivider;
+  }
+  /**
+   * \brief Factor to apply to sizes in pixels, smaller than one when evaluating at a reduced
+   * resolution.
+   */
+  float getResolutionFactor() const
+  {
+    return 1.0f / this->m_resolutionDivider;
+  }
   bool isGroupnodeBufferEnabled() const
   {
     return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0;
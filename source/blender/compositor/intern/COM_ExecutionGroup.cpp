@@ -27,6 +27,7 @@
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
 #include "COM_ExecutionSystem.h"
+#include "COM_Profiler.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_ViewerOperation.h"
 #include "COM_WorkScheduler.h"
@@ -59,6 +60,10 @@ ExecutionGroup::ExecutionGroup()
   this->m_chunksFinished = 0;
   BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
   this->m_executionStartTime = 0;
+  BLI_rcti_init(&this->m_regionOfInterest, 0, 0, 0, 0);
+  this->m_hasRegionOfInterest = false;
+  this->m_profiling = false;
+  this->m_statistics = ExecutionGroupStatistics();
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -446,8 +451,11 @@ inline void ExecutionGroup::determineChunkRect(rcti *rect,
   const int border_height = BLI_rcti_size_y(&this->m_viewerBorder);
 
   if (this->m_singleThreaded) {
-    BLI_rcti_init(
-        rect, this->m_viewerBorder.xmin, border_width, this->m_viewerBorder.ymin, border_height);
+    BLI_rcti_init(rect,
+                  this->m_viewerBorder.xmin,
+                  this->m_viewerBorder.xmin + border_width,
+                  this->m_viewerBorder.ymin,
+                  this->m_viewerBorder.ymin + border_height);
   }
   else {
     const unsigned int minx = xChunk * this->m_chunkSize + this->m_viewerBorder.xmin;
@@ -487,21 +495,9 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
     return scheduleChunkWhenPossible(graph, 0, 0);
   }
   // find all chunks inside the rect
-  // determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
-
   int indexx, indexy;
-  int minx = max_ii(area->xmin - m_viewerBorder.xmin, 0);
-  int maxx = min_ii(area->xmax - m_viewerBorder.xmin, m_viewerBorder.xmax - m_viewerBorder.xmin);
-  int miny = max_ii(area->ymin - m_viewerBorder.ymin, 0);
-  int maxy = min_ii(area->ymax - m_viewerBorder.ymin, m_viewerBorder.ymax - m_viewerBorder.ymin);
-  int minxchunk = minx / (int)m_chunkSize;
-  int maxxchunk = (maxx + (int)m_chunkSize - 1) / (int)m_chunkSize;
-  int minychunk = miny / (int)m_chunkSize;
-  int maxychunk = (maxy + (int)m_chunkSize - 1) / (int)m_chunkSize;
-  minxchunk = max_ii(minxchunk, 0);
-  minychunk = max_ii(minychunk, 0);
-  maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
-  maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
+  int minxchunk, maxxchunk, minychunk, maxychunk;
+  determineChunkRange(area, &minxchunk, &maxxchunk, &minychunk, &maxychunk);
 
   bool result = true;
   for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
@@ -515,6 +511,27 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   return result;
 }
 
+void ExecutionGroup::determineChunkRange(const rcti *area,
+                                         int *r_minxchunk,
+                                         int *r_maxxchunk,
+                                         int *r_minychunk,
+                                         int *r_maxychunk) const
+{
+  // determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
+  int minx = max_ii(area->xmin - m_viewerBorder.xmin, 0);
+  int maxx = min_ii(area->xmax - m_viewerBorder.xmin, m_viewerBorder.xmax - m_viewerBorder.xmin);
+  int miny = max_ii(area->ymin - m_viewerBorder.ymin, 0);
+  int maxy = min_ii(area->ymax - m_viewerBorder.ymin, m_viewerBorder.ymax - m_viewerBorder.ymin);
+  int minxchunk = minx / (int)m_chunkSize;
+  int maxxchunk = (maxx + (int)m_chunkSize - 1) / (int)m_chunkSize;
+  int minychunk = miny / (int)m_chunkSize;
+  int maxychunk = (maxy + (int)m_chunkSize - 1) / (int)m_chunkSize;
+  *r_minxchunk = max_ii(minxchunk, 0);
+  *r_minychunk = max_ii(minychunk, 0);
+  *r_maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
+  *r_maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
+}
+
 bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
 {
   if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
@@ -553,6 +570,7 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
   unsigned int index;
   bool canBeExecuted = true;
   rcti area;
+  uint64_t areaOfInterestPixels = 0;
 
   for (index = 0; index < this->m_cachedReadOperations.size(); index++) {
     ReadBufferOperation *readOperation =
@@ -562,6 +580,15 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
     determineDependingAreaOfInterest(&rect, readOperation, &area);
     ExecutionGroup *group = memoryProxy->getExecutor();
 
+    if (this->m_profiling) {
+      rcti bounds, clipped;
+      BLI_rcti_init(&bounds, 0, readOperation->getWidth(), 0, readOperation->getHeight());
+      if (BLI_rcti_isect(&area, &bounds, &clipped)) {
+        areaOfInterestPixels += (uint64_t)BLI_rcti_size_x(&clipped) *
+                                BLI_rcti_size_y(&clipped);
+      }
+    }
+
     if (group != nullptr) {
       if (!group->scheduleAreaWhenPossible(graph, &area)) {
         canBeExecuted = false;
@@ -573,7 +600,10 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
   }
 
   if (canBeExecuted) {
-    scheduleChunk(chunkNumber);
+    if (scheduleChunk(chunkNumber)) {
+      Profiler::chunk_scheduled(
+          this, (uint64_t)BLI_rcti_size_x(&rect) * BLI_rcti_size_y(&rect), areaOfInterestPixels);
+    }
   }
 
   return false;
@@ -586,6 +616,101 @@ void ExecutionGroup::determineDependingAreaOfInterest(rcti *input,
   this->getOutputOperation()->determineDependingAreaOfInterest(input, readOperation, output);
 }
 
+bool ExecutionGroup::hasBorder() const
+{
+  return this->m_viewerBorder.xmin > 0 || this->m_viewerBorder.ymin > 0 ||
+         this->m_viewerBorder.xmax < (int)this->m_width ||
+         this->m_viewerBorder.ymax < (int)this->m_height;
+}
+
+void ExecutionGroup::beginRegionOfInterest()
+{
+  this->m_hasRegionOfInterest = false;
+  this->m_chunksRequired.assign(this->m_numberOfChunks, false);
+}
+
+void ExecutionGroup::addRegionOfInterest(const rcti *area)
+{
+  if (this->m_singleThreaded) {
+    /* The single chunk covers the region of interest, grow it when needed. */
+    rcti bounds, clipped;
+    BLI_rcti_init(&bounds, 0, this->m_width, 0, this->m_height);
+    if (!BLI_rcti_isect(area, &bounds, &clipped)) {
+      return;
+    }
+    if (this->m_hasRegionOfInterest) {
+      if (BLI_rcti_inside_rcti(&this->m_regionOfInterest, &clipped)) {
+        return;
+      }
+      BLI_rcti_union(&this->m_regionOfInterest, &clipped);
+    }
+    else {
+      this->m_regionOfInterest = clipped;
+      this->m_hasRegionOfInterest = true;
+    }
+    propagateRegionOfInterest(&this->m_regionOfInterest);
+    return;
+  }
+
+  /* Visit every chunk only once, the same chunks will be scheduled by scheduleAreaWhenPossible
+   * during execution. */
+  int minxchunk, maxxchunk, minychunk, maxychunk;
+  determineChunkRange(area, &minxchunk, &maxxchunk, &minychunk, &maxychunk);
+  for (int yChunk = minychunk; yChunk < maxychunk; yChunk++) {
+    for (int xChunk = minxchunk; xChunk < maxxchunk; xChunk++) {
+      const int chunkNumber = yChunk * this->m_numberOfXChunks + xChunk;
+      if (this->m_chunksRequired[chunkNumber]) {
+        continue;
+      }
+      this->m_chunksRequired[chunkNumber] = true;
+
+      rcti rect;
+      determineChunkRect(&rect, xChunk, yChunk);
+      if (this->m_hasRegionOfInterest) {
+        BLI_rcti_union(&this->m_regionOfInterest, &rect);
+      }
+      else {
+        this->m_regionOfInterest = rect;
+        this->m_hasRegionOfInterest = true;
+      }
+      propagateRegionOfInterest(&rect);
+    }
+  }
+}
+
+void ExecutionGroup::propagateRegionOfInterest(rcti *rect)
+{
+  rcti area;
+  for (unsigned int index = 0; index < this->m_cachedReadOperations.size(); index++) {
+    ReadBufferOperation *readOperation =
+        (ReadBufferOperation *)this->m_cachedReadOperations[index];
+    BLI_rcti_init(&area, 0, 0, 0, 0);
+    determineDependingAreaOfInterest(rect, readOperation, &area);
+    ExecutionGroup *group = readOperation->getMemoryProxy()->getExecutor();
+    if (group != nullptr) {
+      group->addRegionOfInterest(&area);
+    }
+  }
+}
+
+void ExecutionGroup::finishRegionOfInterest()
+{
+  this->m_chunksRequired.clear();
+  if (!this->m_hasRegionOfInterest) {
+    return;
+  }
+
+  if (this->m_singleThreaded) {
+    /* The single chunk only calculates the region of interest. */
+    this->m_viewerBorder = this->m_regionOfInterest;
+  }
+  for (NodeOperation *operation : this->m_operations) {
+    if (operation->isComplex()) {
+      operation->setRegionOfInterest(&this->m_regionOfInterest);
+    }
+  }
+}
+
 void ExecutionGroup::determineDependingMemoryProxies(vector<MemoryProxy *> *memoryProxies)
 {
   unsigned int index;
@@ -28,6 +28,7 @@
 #include "COM_MemoryProxy.h"
 #include "COM_Node.h"
 #include "COM_NodeOperation.h"
+#include "COM_Profiler.h"
 #include <vector>
 
 using std::vector;
@@ -181,6 +182,31 @@ class ExecutionGroup {
    */
   double m_executionStartTime;
 
+  /**
+   * \brief the part of the output that is needed by the output ExecutionGroup's
+   * \note only determined when compositing a border
+   * \see ExecutionSystem.determineRegionsOfInterest
+   */
+  rcti m_regionOfInterest;
+  bool m_hasRegionOfInterest;
+
+  /**
+   * \brief per chunk, is it needed to calculate the region of interest
+   * \note only used while determining the region of interest
+   */
+  vector<bool> m_chunksRequired;
+
+  /**
+   * \brief gather execution statistics of this group
+   * \see Profiler
+   */
+  bool m_profiling;
+
+  /**
+   * \brief statistics gathered while profiling
+   */
+  ExecutionGroupStatistics m_statistics;
+
   // methods
   /**
    * \brief check whether parameter operation can be added to the execution group
@@ -234,6 +260,21 @@ class ExecutionGroup {
    */
   bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area);
 
+  /**
+   * \brief determine the chunks that intersect an area.
+   * \note the range is exclusive, like rcti
+   */
+  void determineChunkRange(const rcti *area,
+                           int *r_minxchunk,
+                           int *r_maxxchunk,
+                           int *r_minychunk,
+                           int *r_maxychunk) const;
+
+  /**
+   * \brief add the areas of the inputs needed to calculate rect to their ExecutionGroup's
+   */
+  void propagateRegionOfInterest(rcti *rect);
+
   /**
    * \brief add a chunk to the WorkScheduler.
    * \param chunknumber:
@@ -439,8 +480,52 @@ class ExecutionGroup {
 
   void setRenderBorder(float xmin, float xmax, float ymin, float ymax);
 
+  /**
+   * \brief is only a part of the output calculated
+   */
+  bool hasBorder() const;
+
+  /**
+   * \brief mark an area of the output as needed and propagate it to the depending
+   * ExecutionGroup's.
+   * \note only the chunks covering the area will be calculated for single threaded groups,
+   * complex operations are informed of the area via NodeOperation.setRegionOfInterest.
+   * \see finishRegionOfInterest
+   */
+  void addRegionOfInterest(const rcti *area);
+
+  /**
+   * \brief start determining the region of interest, the region is empty until areas are added
+   */
+  void beginRegionOfInterest();
+
+  /**
+   * \brief apply the determined region of interest to the group and its operations
+   */
+  void finishRegionOfInterest();
+
+  /**
+   * \brief enable gathering of execution statistics, resets the previous statistics
+   */
+  void setProfiling(bool profiling)
+  {
+    this->m_profiling = profiling;
+    this->m_statistics = ExecutionGroupStatistics();
+  }
+
+  bool isProfiling() const
+  {
+    return this->m_profiling;
+  }
+
+  const ExecutionGroupStatistics &getStatistics() const
+  {
+    return this->m_statistics;
+  }
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
+  friend class Profiler;
 
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:ExecutionGroup")
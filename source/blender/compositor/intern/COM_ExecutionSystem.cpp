@@ -30,6 +30,7 @@
 #include "COM_ExecutionGroup.h"
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
+#include "COM_Profiler.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_WorkScheduler.h"
 
@@ -42,6 +43,7 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
                                  bNodeTree *editingtree,
                                  bool rendering,
                                  bool fastcalculation,
+                                 int resolutionDivider,
                                  const ColorManagedViewSettings *viewSettings,
                                  const ColorManagedDisplaySettings *displaySettings,
                                  const char *viewName)
@@ -51,6 +53,7 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
   this->m_context.setbNodeTree(editingtree);
   this->m_context.setPreviewHash(editingtree->previews);
   this->m_context.setFastCalculation(fastcalculation);
+  this->m_context.setResolutionDivider(resolutionDivider);
   /* initialize the CompositorContext */
   if (rendering) {
     this->m_context.setQuality((CompositorQuality)editingtree->render_quality);
@@ -147,6 +150,12 @@ void ExecutionSystem::execute()
   }
   unsigned int index;
 
+  /* Before initializing the operations, they cache the readers of their inputs. */
+  const bool profiling = (editingtree->flag & NTREE_COM_PROFILE) != 0;
+  if (profiling) {
+    Profiler::execution_started(this);
+  }
+
   // First allocale all write buffer
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -176,6 +185,7 @@ void ExecutionSystem::execute()
     executionGroup->setChunksize(this->m_context.getChunksize());
     executionGroup->initExecution();
   }
+  determineRegionsOfInterest();
 
   WorkScheduler::start(this->m_context);
 
@@ -188,6 +198,10 @@ void ExecutionSystem::execute()
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  if (profiling) {
+    Profiler::execution_finished(this);
+  }
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -199,6 +213,33 @@ void ExecutionSystem::execute()
   }
 }
 
+void ExecutionSystem::determineRegionsOfInterest()
+{
+  vector<ExecutionGroup *> outputGroups;
+  findOutputExecutionGroup(&outputGroups);
+
+  bool useBorder = false;
+  for (ExecutionGroup *group : outputGroups) {
+    useBorder |= group->hasBorder();
+  }
+  /* Without a border every group calculates its full output. */
+  if (!useBorder) {
+    return;
+  }
+
+  for (ExecutionGroup *group : this->m_groups) {
+    group->beginRegionOfInterest();
+  }
+  for (ExecutionGroup *group : outputGroups) {
+    rcti border;
+    BLI_rcti_init(&border, 0, group->getWidth(), 0, group->getHeight());
+    group->addRegionOfInterest(&border);
+  }
+  for (ExecutionGroup *group : this->m_groups) {
+    group->finishRegionOfInterest();
+  }
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
   unsigned int index;
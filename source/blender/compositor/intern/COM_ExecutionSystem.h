@@ -152,12 +152,14 @@ class ExecutionSystem {
    *
    * \param editingtree: [bNodeTree *]
    * \param rendering: [true false]
+   * \param resolutionDivider: evaluate the tree at the resolution divided by this factor.
    */
   ExecutionSystem(RenderData *rd,
                   Scene *scene,
                   bNodeTree *editingtree,
                   bool rendering,
                   bool fastcalculation,
+                  int resolutionDivider,
                   const ColorManagedViewSettings *viewSettings,
                   const ColorManagedDisplaySettings *displaySettings,
                   const char *viewName);
@@ -188,8 +190,16 @@ class ExecutionSystem {
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief determine the part of every ExecutionGroup that is needed by the borders of the
+   * output ExecutionGroup's, so operations that calculate their whole output at once can
+   * limit themselves to it.
+   */
+  void determineRegionsOfInterest();
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
+  friend class Profiler;
 
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:ExecutionSystem")
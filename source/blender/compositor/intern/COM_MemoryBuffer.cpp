@@ -17,6 +17,7 @@
  */
 
 #include "COM_MemoryBuffer.h"
+#include "COM_Profiler.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -60,6 +61,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
   this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  Profiler::memory_allocated(sizeof(float) * determineBufferSize() * this->m_num_channels);
   this->m_state = COM_MB_ALLOCATED;
   this->m_datatype = memoryProxy->getDataType();
 }
@@ -74,6 +76,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
   this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  Profiler::memory_allocated(sizeof(float) * determineBufferSize() * this->m_num_channels);
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = memoryProxy->getDataType();
 }
@@ -88,6 +91,7 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
   this->m_num_channels = determine_num_channels(dataType);
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  Profiler::memory_allocated(sizeof(float) * determineBufferSize() * this->m_num_channels);
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = dataType;
 }
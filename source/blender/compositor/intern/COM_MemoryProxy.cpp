@@ -17,6 +17,7 @@
  */
 
 #include "COM_MemoryProxy.h"
+#include "COM_Profiler.h"
 
 MemoryProxy::MemoryProxy(DataType datatype)
 {
@@ -34,6 +35,10 @@ void MemoryProxy::allocate(unsigned int width, unsigned int height)
   result.ymax = height;
 
   this->m_buffer = new MemoryBuffer(this, 1, &result);
+  Profiler::memory_allocated(this->m_executor,
+                             sizeof(float) * this->m_buffer->getWidth() *
+                                 this->m_buffer->getHeight() *
+                                 this->m_buffer->get_num_channels());
 }
 
 void MemoryProxy::free()
@@ -19,7 +19,10 @@
 #include <cstdio>
 #include <typeinfo>
 
+#include "BKE_node.h"
+
 #include "COM_ExecutionSystem.h"
+#include "COM_Profiler.h"
 #include "COM_defines.h"
 
 #include "COM_NodeOperation.h" /* own include */
@@ -37,10 +40,14 @@ NodeOperation::NodeOperation()
   this->m_isResolutionSet = false;
   this->m_openCL = false;
   this->m_btree = nullptr;
+  this->m_nodeInstanceKey = NODE_INSTANCE_KEY_NONE;
+  this->m_profiledReader = nullptr;
+  this->m_hasRegionOfInterest = false;
 }
 
 NodeOperation::~NodeOperation()
 {
+  delete this->m_profiledReader;
   while (!this->m_outputs.empty()) {
     delete (this->m_outputs.back());
     this->m_outputs.pop_back();
@@ -51,6 +58,16 @@ NodeOperation::~NodeOperation()
   }
 }
 
+void NodeOperation::getRegionOfInterest(rcti *r_regionOfInterest) const
+{
+  if (this->m_hasRegionOfInterest) {
+    *r_regionOfInterest = this->m_regionOfInterest;
+  }
+  else {
+    BLI_rcti_init(r_regionOfInterest, 0, this->m_width, 0, this->m_height);
+  }
+}
+
 NodeOperationOutput *NodeOperation::getOutputSocket(unsigned int index) const
 {
   BLI_assert(index < m_outputs.size());
@@ -136,6 +153,10 @@ void NodeOperation::deinitExecution()
 }
 SocketReader *NodeOperation::getInputSocketReader(unsigned int inputSocketIndex)
 {
+  NodeOperation *operation = this->getInputOperation(inputSocketIndex);
+  if (operation && operation->m_profiledReader) {
+    return operation->m_profiledReader;
+  }
   return this->getInputSocket(inputSocketIndex)->getReader();
 }
 
@@ -38,6 +38,7 @@ using std::max;
 using std::min;
 
 class OpenCLDevice;
+class ProfiledSocketReader;
 class ReadBufferOperation;
 class WriteBufferOperation;
 
@@ -123,6 +124,26 @@ class NodeOperation : public SocketReader {
    */
   bool m_isResolutionSet;
 
+  /**
+   * \brief instance key of the node this operation was created for
+   * \note used to attribute execution statistics to the node, see Profiler
+   */
+  bNodeInstanceKey m_nodeInstanceKey;
+
+  /**
+   * \brief reader used by other operations to read this one while profiling
+   * \see Profiler
+   */
+  ProfiledSocketReader *m_profiledReader;
+
+  /**
+   * \brief part of the output that is needed to calculate the outputs of the ExecutionSystem
+   * \note only set for complex operations when compositing a border
+   * \see ExecutionSystem.determineRegionsOfInterest
+   */
+  rcti m_regionOfInterest;
+  bool m_hasRegionOfInterest;
+
  public:
   virtual ~NodeOperation();
 
@@ -187,6 +208,36 @@ class NodeOperation : public SocketReader {
   {
     this->m_btree = tree;
   }
+
+  void setNodeInstanceKey(bNodeInstanceKey key)
+  {
+    this->m_nodeInstanceKey = key;
+  }
+  bNodeInstanceKey getNodeInstanceKey() const
+  {
+    return this->m_nodeInstanceKey;
+  }
+
+  void setProfiledReader(ProfiledSocketReader *reader)
+  {
+    this->m_profiledReader = reader;
+  }
+  ProfiledSocketReader *getProfiledReader() const
+  {
+    return this->m_profiledReader;
+  }
+
+  void setRegionOfInterest(const rcti *regionOfInterest)
+  {
+    this->m_regionOfInterest = *regionOfInterest;
+    this->m_hasRegionOfInterest = true;
+  }
+
+  /**
+   * \brief get the part of the output that will be read, the whole output when it is unknown
+   * \note operations that calculate their whole output at once can limit their work to this
+   */
+  void getRegionOfInterest(rcti *r_regionOfInterest) const;
   virtual void initExecution();
 
   /**
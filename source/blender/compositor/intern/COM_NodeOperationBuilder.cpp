@@ -28,6 +28,7 @@
 #include "COM_NodeOperation.h"
 #include "COM_PreviewOperation.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResampleOperation.h"
 #include "COM_SetColorOperation.h"
 #include "COM_SetValueOperation.h"
 #include "COM_SetVectorOperation.h"
@@ -102,6 +103,8 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
   add_datatype_conversions();
 
+  add_resolution_divider_operations();
+
   determineResolutions();
 
   /* surround complex ops with read/write buffer */
@@ -125,6 +128,9 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
+  if (m_current_node) {
+    operation->setNodeInstanceKey(m_current_node->getInstanceKey());
+  }
   m_operations.push_back(operation);
 }
 
@@ -299,6 +305,71 @@ void NodeOperationBuilder::add_datatype_conversions()
   }
 }
 
+void NodeOperationBuilder::add_resolution_divider_operations()
+{
+  const int divider = m_context->getResolutionDivider();
+  if (divider <= 1) {
+    return;
+  }
+
+  /* Note: operations cached first to avoid modifying
+   *       m_operations while iterating over it
+   */
+  Operations input_ops, output_ops;
+  for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+    NodeOperation *op = *it;
+    /* Constant values have no resolution of their own. */
+    if (op->isSetOperation()) {
+      continue;
+    }
+    if (op->isInputOperation()) {
+      input_ops.push_back(op);
+    }
+    else if (op->isOutputOperation(m_context->isRendering()) && !op->isPreviewOperation()) {
+      output_ops.push_back(op);
+    }
+  }
+
+  /* Everything between the inputs and the outputs is evaluated at the reduced resolution. */
+  for (Operations::const_iterator it = input_ops.begin(); it != input_ops.end(); ++it) {
+    NodeOperation *op = *it;
+    for (int k = 0; k < op->getNumberOfOutputSockets(); ++k) {
+      NodeOperationOutput *output = op->getOutputSocket(k);
+      OpInputs targets = cache_output_links(output);
+      if (targets.empty()) {
+        continue;
+      }
+
+      DownsampleOperation *downsample = new DownsampleOperation(output->getDataType(), divider);
+      addOperation(downsample);
+      addLink(output, downsample->getInputSocket(0));
+      for (OpInputs::const_iterator it_target = targets.begin(); it_target != targets.end();
+           ++it_target) {
+        NodeOperationInput *target = *it_target;
+        removeInputLink(target);
+        addLink(downsample->getOutputSocket(0), target);
+      }
+    }
+  }
+
+  for (Operations::const_iterator it = output_ops.begin(); it != output_ops.end(); ++it) {
+    NodeOperation *op = *it;
+    for (int k = 0; k < op->getNumberOfInputSockets(); ++k) {
+      NodeOperationInput *input = op->getInputSocket(k);
+      NodeOperationOutput *from = input->getLink();
+      if (!from || from->getOperation().isSetOperation()) {
+        continue;
+      }
+
+      UpsampleOperation *upsample = new UpsampleOperation(input->getDataType(), divider);
+      addOperation(upsample);
+      removeInputLink(input);
+      addLink(from, upsample->getInputSocket(0));
+      addLink(upsample->getOutputSocket(0), input);
+    }
+  }
+}
+
 void NodeOperationBuilder::add_operation_input_constants()
 {
   /* Note: unconnected inputs cached first to avoid modifying
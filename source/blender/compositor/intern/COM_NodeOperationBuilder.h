@@ -139,6 +139,10 @@ class NodeOperationBuilder {
   /** Add datatype conversion where needed */
   void add_datatype_conversions();
 
+  /** Reduce the resolution after the inputs and restore it before the outputs,
+   * when the context is evaluated at a reduced resolution */
+  void add_resolution_divider_operations();
+
   /** Construct a constant value operation for every unconnected input */
   void add_operation_input_constants();
   void add_input_constant_value(NodeOperationInput *input, NodeInput *node_input);
@@ -17,6 +17,7 @@
  */
 
 #include "COM_OpenCLDevice.h"
+#include "COM_Profiler.h"
 #include "COM_WorkScheduler.h"
 
 enum COM_VendorID { NVIDIA = 0x10DE, AMD = 0x1002 };
@@ -65,6 +66,8 @@ void OpenCLDevice::execute(WorkPackage *work)
   ExecutionGroup *executionGroup = work->getExecutionGroup();
   rcti rect;
 
+  Profiler::chunk_started(executionGroup);
+
   executionGroup->determineChunkRect(&rect, chunkNumber);
   MemoryBuffer **inputBuffers = executionGroup->getInputBuffersOpenCL(chunkNumber);
   MemoryBuffer *outputBuffer = executionGroup->allocateOutputBuffer(chunkNumber, &rect);
@@ -74,6 +77,8 @@ void OpenCLDevice::execute(WorkPackage *work)
 
   delete outputBuffer;
 
+  Profiler::chunk_finished(executionGroup, true);
+
   executionGroup->finalizeChunkExecution(chunkNumber, inputBuffers);
 }
 cl_mem OpenCLDevice::COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel,
@@ -0,0 +1,367 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+
+#include "atomic_ops.h"
+
+#include "BLI_threads.h"
+#include "BLI_timeit.hh"
+
+#include "PIL_time.h"
+
+#include "BKE_node.h"
+
+#include "DNA_scene_types.h"
+
+#include "COM_ExecutionGroup.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_NodeOperation.h"
+#include "COM_Profiler.h"
+#include "COM_WriteBufferOperation.h"
+#include "COM_compositor.h"
+
+/* One in this many pixels evaluated by a thread is timed. */
+#define COM_PROFILE_SAMPLE_INTERVAL 16
+
+typedef std::map<unsigned int, CompositorNodeStatistics> NodeStatisticsMap;
+
+struct SceneStatistics {
+  NodeStatisticsMap nodes;
+  double total_time;
+};
+
+/* Statistics of the last profiled execution, per scene. Scenes are looked up by library and name
+ * as the render pipeline executes the tree of the evaluated scene and the editor the original
+ * one. */
+static std::map<std::string, SceneStatistics> g_statistics;
+static ThreadMutex g_statistics_mutex = BLI_MUTEX_INITIALIZER;
+
+/* The chunk executed by the current thread, only set when its group is being profiled. */
+static thread_local ExecutionGroup *g_current_group = nullptr;
+static thread_local double g_chunk_start_time = 0.0;
+
+/* Timing state of the operations evaluated by the current thread. */
+static thread_local ProfiledSocketReader *g_current_reader = nullptr;
+static thread_local int g_depth = 0;
+static thread_local bool g_timed = false;
+static thread_local uint64_t g_weight = 1;
+static thread_local uint64_t *g_child_time_ns = nullptr;
+static thread_local unsigned int g_sample_counter = 0;
+
+static std::string scene_statistics_key(const Scene *scene)
+{
+  std::string key = scene->id.name;
+  if (scene->id.lib) {
+    key += '\0';
+    key += scene->id.lib->filepath;
+  }
+  return key;
+}
+
+/**
+ * Measure the exclusive time of a call into an operation: the time of the nested calls into its
+ * inputs is subtracted. Whether pixels are timed is decided for the outermost call, so either all
+ * or none of the nested calls are timed. Timed pixels are weighted by the sample interval.
+ */
+class ProfileScope {
+ private:
+  ProfiledSocketReader *m_reader;
+  ProfiledSocketReader *m_parent_reader;
+  bool m_parent_timed;
+  uint64_t m_parent_weight;
+  uint64_t *m_parent_child_time_ns;
+  uint64_t m_child_time_ns;
+  blender::timeit::TimePoint m_start;
+
+ public:
+  ProfileScope(ProfiledSocketReader *reader, bool always_timed)
+      : m_reader(reader),
+        m_parent_reader(g_current_reader),
+        m_parent_timed(g_timed),
+        m_parent_weight(g_weight),
+        m_parent_child_time_ns(g_child_time_ns),
+        m_child_time_ns(0)
+  {
+    if (always_timed) {
+      g_timed = true;
+      g_weight = 1;
+    }
+    else if (g_depth == 0) {
+      g_timed = (++g_sample_counter % COM_PROFILE_SAMPLE_INTERVAL) == 0;
+      g_weight = COM_PROFILE_SAMPLE_INTERVAL;
+    }
+    g_depth++;
+    g_current_reader = reader;
+    if (g_timed) {
+      g_child_time_ns = &m_child_time_ns;
+      m_start = blender::timeit::Clock::now();
+    }
+  }
+
+  ~ProfileScope()
+  {
+    if (g_timed) {
+      const uint64_t inclusive_ns = (uint64_t)std::chrono::duration_cast<
+                                        blender::timeit::Nanoseconds>(
+                                        blender::timeit::Clock::now() - m_start)
+                                        .count();
+      const uint64_t exclusive_ns = inclusive_ns - std::min(inclusive_ns, m_child_time_ns);
+      atomic_add_and_fetch_uint64(&m_reader->m_time_ns, exclusive_ns * g_weight);
+      if (m_parent_timed && m_parent_child_time_ns) {
+        *m_parent_child_time_ns += inclusive_ns;
+      }
+    }
+    g_depth--;
+    g_current_reader = m_parent_reader;
+    g_timed = m_parent_timed;
+    g_weight = m_parent_weight;
+    g_child_time_ns = m_parent_child_time_ns;
+  }
+};
+
+ProfiledSocketReader::ProfiledSocketReader(NodeOperation *operation)
+    : m_operation(operation), m_time_ns(0), m_memory(0)
+{
+  this->m_width = operation->getWidth();
+  this->m_height = operation->getHeight();
+}
+
+void *ProfiledSocketReader::initializeTileData(rcti *rect)
+{
+  ProfileScope scope(this, true);
+  return this->m_operation->initializeTileData(rect);
+}
+
+void ProfiledSocketReader::deinitializeTileData(rcti *rect, void *data)
+{
+  ProfileScope scope(this, true);
+  this->m_operation->deinitializeTileData(rect, data);
+}
+
+MemoryBuffer *ProfiledSocketReader::getInputMemoryBuffer(MemoryBuffer **memoryBuffers)
+{
+  return this->m_operation->getInputMemoryBuffer(memoryBuffers);
+}
+
+void ProfiledSocketReader::executePixelSampled(float output[4],
+                                               float x,
+                                               float y,
+                                               PixelSampler sampler)
+{
+  ProfileScope scope(this, false);
+  this->m_operation->readSampled(output, x, y, sampler);
+}
+
+void ProfiledSocketReader::executePixel(float output[4], int x, int y, void *chunkData)
+{
+  ProfileScope scope(this, false);
+  this->m_operation->read(output, x, y, chunkData);
+}
+
+void ProfiledSocketReader::executePixelFiltered(
+    float output[4], float x, float y, float dx[2], float dy[2])
+{
+  ProfileScope scope(this, false);
+  this->m_operation->readFiltered(output, x, y, dx, dy);
+}
+
+void Profiler::chunk_started(ExecutionGroup *group)
+{
+  if (!group->isProfiling()) {
+    return;
+  }
+  g_current_group = group;
+  g_chunk_start_time = PIL_check_seconds_timer();
+}
+
+void Profiler::chunk_finished(ExecutionGroup *group, bool opencl)
+{
+  if (g_current_group != group) {
+    return;
+  }
+  const double elapsed = PIL_check_seconds_timer() - g_chunk_start_time;
+  const uint64_t elapsed_us = (uint64_t)(elapsed * 1000000.0);
+  ExecutionGroupStatistics &statistics = group->m_statistics;
+  atomic_add_and_fetch_uint64(&statistics.time_us, elapsed_us);
+  if (opencl) {
+    atomic_add_and_fetch_uint64(&statistics.opencl_time_us, elapsed_us);
+  }
+  atomic_add_and_fetch_uint64(&statistics.chunks, 1);
+  g_current_group = nullptr;
+}
+
+void Profiler::memory_allocated(size_t bytes)
+{
+  if (g_current_reader != nullptr) {
+    atomic_add_and_fetch_uint64(&g_current_reader->m_memory, (uint64_t)bytes);
+  }
+  else if (g_current_group != nullptr) {
+    memory_allocated(g_current_group, bytes);
+  }
+}
+
+void Profiler::memory_allocated(ExecutionGroup *group, size_t bytes)
+{
+  if (group == nullptr || !group->isProfiling()) {
+    return;
+  }
+  atomic_add_and_fetch_uint64(&group->m_statistics.memory, (uint64_t)bytes);
+}
+
+void Profiler::chunk_scheduled(ExecutionGroup *group,
+                               uint64_t chunk_pixels,
+                               uint64_t area_of_interest_pixels)
+{
+  if (!group->isProfiling()) {
+    return;
+  }
+  ExecutionGroupStatistics &statistics = group->m_statistics;
+  atomic_add_and_fetch_uint64(&statistics.chunk_pixels, chunk_pixels);
+  atomic_add_and_fetch_uint64(&statistics.area_of_interest_pixels, area_of_interest_pixels);
+}
+
+void Profiler::execution_started(ExecutionSystem *system)
+{
+  for (ExecutionGroup *group : system->m_groups) {
+    group->setProfiling(true);
+  }
+  for (NodeOperation *operation : system->m_operations) {
+    operation->setProfiledReader(new ProfiledSocketReader(operation));
+  }
+}
+
+/* The node a group writes, which gets the time and memory that can't be attributed to a single
+ * operation. */
+static unsigned int group_output_node_key(const ExecutionGroup *group)
+{
+  NodeOperation *operation = group->getOutputOperation();
+  if (operation->isWriteBufferOperation()) {
+    operation = ((WriteBufferOperation *)operation)->getInput();
+  }
+  return operation->getNodeInstanceKey().value;
+}
+
+void Profiler::execution_finished(const ExecutionSystem *system)
+{
+  const Scene *scene = system->getContext().getScene();
+  if (scene == nullptr) {
+    return;
+  }
+
+  SceneStatistics scene_statistics;
+  scene_statistics.total_time = 0.0;
+
+  /* Time spent on the CPU is measured per group, and distributed over the operations by their
+   * sampled cost. Chunks executed with OpenCL bypass the operations' readers, their time goes to
+   * the node written by the group. */
+  double cpu_time = 0.0;
+  for (const ExecutionGroup *group : system->m_groups) {
+    const ExecutionGroupStatistics &group_statistics = group->m_statistics;
+    const double time = group_statistics.time_us / 1000000.0;
+    const double opencl_time = group_statistics.opencl_time_us / 1000000.0;
+    scene_statistics.total_time += time;
+    cpu_time += time - opencl_time;
+
+    std::set<unsigned int> node_keys;
+    for (const NodeOperation *operation : group->m_operations) {
+      node_keys.insert(operation->getNodeInstanceKey().value);
+    }
+    const unsigned int output_key = group_output_node_key(group);
+    node_keys.insert(output_key);
+    node_keys.erase(NODE_INSTANCE_KEY_NONE.value);
+
+    /* Chunks and pixels describe the group, every node in it is shown with them. */
+    for (const unsigned int key : node_keys) {
+      CompositorNodeStatistics &statistics = scene_statistics.nodes[key];
+      statistics.chunks += (int)group_statistics.chunks;
+      statistics.chunk_pixels += group_statistics.chunk_pixels;
+      statistics.area_of_interest_pixels += group_statistics.area_of_interest_pixels;
+    }
+    if (output_key != NODE_INSTANCE_KEY_NONE.value) {
+      CompositorNodeStatistics &statistics = scene_statistics.nodes[output_key];
+      statistics.time += opencl_time;
+      statistics.memory += (size_t)group_statistics.memory;
+    }
+  }
+
+  /* The sampled costs include the overhead of measuring them, so they are only used as weights
+   * for the measured time of the chunks. */
+  uint64_t total_cost_ns = 0;
+  for (const NodeOperation *operation : system->m_operations) {
+    total_cost_ns += operation->getProfiledReader()->m_time_ns;
+  }
+  const double time_per_cost = (total_cost_ns > 0) ? cpu_time / total_cost_ns : 0.0;
+
+  for (const NodeOperation *operation : system->m_operations) {
+    const unsigned int key = operation->getNodeInstanceKey().value;
+    if (key == NODE_INSTANCE_KEY_NONE.value) {
+      continue;
+    }
+    const ProfiledSocketReader *reader = operation->getProfiledReader();
+    CompositorNodeStatistics &statistics = scene_statistics.nodes[key];
+    statistics.time += reader->m_time_ns * time_per_cost;
+    statistics.memory += (size_t)reader->m_memory;
+  }
+
+  BLI_mutex_lock(&g_statistics_mutex);
+  g_statistics[scene_statistics_key(scene)] = scene_statistics;
+  BLI_mutex_unlock(&g_statistics_mutex);
+}
+
+bool COM_profiler_node_statistics(const Scene *scene,
+                                  bNodeInstanceKey key,
+                                  CompositorNodeStatistics *r_statistics)
+{
+  bool found = false;
+  BLI_mutex_lock(&g_statistics_mutex);
+  std::map<std::string, SceneStatistics>::const_iterator scene_it = g_statistics.find(
+      scene_statistics_key(scene));
+  if (scene_it != g_statistics.end()) {
+    NodeStatisticsMap::const_iterator node_it = scene_it->second.nodes.find(key.value);
+    if (node_it != scene_it->second.nodes.end()) {
+      *r_statistics = node_it->second;
+      found = true;
+    }
+  }
+  BLI_mutex_unlock(&g_statistics_mutex);
+  return found;
+}
+
+double COM_profiler_total_time(const Scene *scene)
+{
+  double total_time = 0.0;
+  BLI_mutex_lock(&g_statistics_mutex);
+  std::map<std::string, SceneStatistics>::const_iterator scene_it = g_statistics.find(
+      scene_statistics_key(scene));
+  if (scene_it != g_statistics.end()) {
+    total_time = scene_it->second.total_time;
+  }
+  BLI_mutex_unlock(&g_statistics_mutex);
+  return total_time;
+}
+
+void COM_profiler_clear(void)
+{
+  BLI_mutex_lock(&g_statistics_mutex);
+  g_statistics.clear();
+  BLI_mutex_unlock(&g_statistics_mutex);
+}
@@ -0,0 +1,125 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "COM_SocketReader.h"
+
+class ExecutionGroup;
+class ExecutionSystem;
+class NodeOperation;
+
+/**
+ * \brief Statistics gathered for a single ExecutionGroup while profiling.
+ * \note All fields are updated atomically, chunks of a group are executed by several threads.
+ * \ingroup Execution
+ */
+struct ExecutionGroupStatistics {
+  /** Accumulated CPU time spent in the chunks of the group, in microseconds. */
+  uint64_t time_us;
+  /** Part of time_us spent in chunks executed on an OpenCL device. */
+  uint64_t opencl_time_us;
+  /** Number of executed chunks. */
+  uint64_t chunks;
+  /** Bytes of MemoryBuffer's allocated on behalf of the group, outside of its operations. */
+  uint64_t memory;
+  /** Number of pixels the executed chunks cover. */
+  uint64_t chunk_pixels;
+  /** Number of input pixels requested by the executed chunks (area of interest). */
+  uint64_t area_of_interest_pixels;
+};
+
+/**
+ * \brief Reader that measures the time spent in an operation while profiling.
+ *
+ * Operations read their inputs through these instead of the operations themselves, see
+ * NodeOperation.getInputSocketReader. Time is measured exclusive of the inputs, as operations
+ * are evaluated interleaved per pixel. To keep the overhead low only a sample of the pixels is
+ * timed, initializeTileData is always timed.
+ * \ingroup Execution
+ */
+class ProfiledSocketReader : public SocketReader {
+ private:
+  NodeOperation *m_operation;
+
+ public:
+  /** Estimated exclusive time of the operation, in nanoseconds. */
+  uint64_t m_time_ns;
+  /** Bytes of MemoryBuffer's allocated by the operation. */
+  uint64_t m_memory;
+
+  ProfiledSocketReader(NodeOperation *operation);
+
+  NodeOperation *getOperation() const
+  {
+    return this->m_operation;
+  }
+
+  void *initializeTileData(rcti *rect) override;
+  void deinitializeTileData(rcti *rect, void *data) override;
+  MemoryBuffer *getInputMemoryBuffer(MemoryBuffer **memoryBuffers) override;
+
+ protected:
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+  void executePixel(float output[4], int x, int y, void *chunkData) override;
+  void executePixelFiltered(
+      float output[4], float x, float y, float dx[2], float dy[2]) override;
+};
+
+/**
+ * \brief Optional execution profiler of the compositor.
+ *
+ * When NTREE_COM_PROFILE is set on the edited node tree the ExecutionGroup's gather timing and
+ * memory statistics, and the operations are read through a ProfiledSocketReader. After execution
+ * the measured time of the groups is distributed over the operations by their measured cost, and
+ * attributed to the nodes the operations were created for. The results can be queried through
+ * the COM_profiler_* C-API.
+ * \ingroup Execution
+ */
+class Profiler {
+ public:
+  /**
+   * \brief Called by the devices before a chunk of the group is executed.
+   * Memory allocated by the calling thread is attributed to the group until chunk_finished.
+   */
+  static void chunk_started(ExecutionGroup *group);
+  static void chunk_finished(ExecutionGroup *group, bool opencl);
+
+  /**
+   * \brief Attribute an allocation to the operation or chunk executed by the calling thread
+   * (if any).
+   */
+  static void memory_allocated(size_t bytes);
+  /** \brief Attribute an allocation to the given group. */
+  static void memory_allocated(ExecutionGroup *group, size_t bytes);
+
+  /** \brief Called for every scheduled chunk with the pixels it will read from its inputs. */
+  static void chunk_scheduled(ExecutionGroup *group,
+                              uint64_t chunk_pixels,
+                              uint64_t area_of_interest_pixels);
+
+  /** \brief Enable profiling of the groups and operations of the system, before execution. */
+  static void execution_started(ExecutionSystem *system);
+  /** \brief Replace the statistics of the scene with the ones gathered by the system. */
+  static void execution_finished(const ExecutionSystem *system);
+
+  friend class ProfiledSocketReader;
+};
@@ -50,6 +50,11 @@ class SingleThreadedOperation : public NodeOperation {
 
   void *initializeTileData(rcti *rect);
 
+  /**
+   * Calculate the output of the operation.
+   * \param rect: the part of the output that is needed (the region of interest), operations that
+   * can calculate a part of their output only need to fill this part of the buffer.
+   */
   virtual MemoryBuffer *createMemoryBuffer(rcti *rect) = 0;
 
   int isSingleThreaded()
@@ -16,6 +16,8 @@
  * Copyright 2011, Blender Foundation.
  */
 
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -32,6 +34,117 @@
 static ThreadMutex s_compositorMutex;
 static bool is_compositorMutex_init = false;
 
+/**
+ * Nodes known to give the same result at a reduced resolution: per pixel operations, and nodes
+ * whose sizes in pixels are scaled to the reduced resolution. Any other node (Transform, Displace,
+ * Vector Blur, Inpaint, Keying, ...) disables the preview at reduced resolution, as it would look
+ * different from the final result.
+ */
+static bool node_supports_resolution_divider(const bNode *node)
+{
+  switch (node->type) {
+    /* Layout. */
+    case NODE_FRAME:
+    case NODE_REROUTE:
+    case NODE_GROUP_INPUT:
+    case NODE_GROUP_OUTPUT:
+    /* Input and output. */
+    case CMP_NODE_R_LAYERS:
+    case CMP_NODE_IMAGE:
+    case CMP_NODE_MOVIECLIP:
+    case CMP_NODE_TEXTURE:
+    case CMP_NODE_RGB:
+    case CMP_NODE_VALUE:
+    case CMP_NODE_TIME:
+    case CMP_NODE_COMPOSITE:
+    case CMP_NODE_VIEWER:
+    case CMP_NODE_SPLITVIEWER:
+    case CMP_NODE_OUTPUT_FILE:
+    case CMP_NODE_VIEW_LEVELS:
+    /* Color. */
+    case CMP_NODE_MIX_RGB:
+    case CMP_NODE_ALPHAOVER:
+    case CMP_NODE_ZCOMBINE:
+    case CMP_NODE_CURVE_RGB:
+    case CMP_NODE_HUE_SAT:
+    case CMP_NODE_HUECORRECT:
+    case CMP_NODE_BRIGHTCONTRAST:
+    case CMP_NODE_GAMMA:
+    case CMP_NODE_EXPOSURE:
+    case CMP_NODE_INVERT:
+    case CMP_NODE_COLORBALANCE:
+    case CMP_NODE_COLORCORRECTION:
+    case CMP_NODE_TONEMAP:
+    /* Converter. */
+    case CMP_NODE_VALTORGB:
+    case CMP_NODE_RGBTOBW:
+    case CMP_NODE_SETALPHA:
+    case CMP_NODE_PREMULKEY:
+    case CMP_NODE_MATH:
+    case CMP_NODE_SEPRGBA:
+    case CMP_NODE_COMBRGBA:
+    case CMP_NODE_SEPHSVA:
+    case CMP_NODE_COMBHSVA:
+    case CMP_NODE_SEPYCCA:
+    case CMP_NODE_COMBYCCA:
+    case CMP_NODE_SEPYUVA:
+    case CMP_NODE_COMBYUVA:
+    case CMP_NODE_SWITCH:
+    case CMP_NODE_SWITCH_VIEW:
+    /* Vector. */
+    case CMP_NODE_NORMAL:
+    case CMP_NODE_CURVE_VEC:
+    case CMP_NODE_MAP_VALUE:
+    case CMP_NODE_MAP_RANGE:
+    case CMP_NODE_NORMALIZE:
+    /* Matte. */
+    case CMP_NODE_CHROMA_MATTE:
+    case CMP_NODE_COLOR_MATTE:
+    case CMP_NODE_DIFF_MATTE:
+    case CMP_NODE_DIST_MATTE:
+    case CMP_NODE_LUMA_MATTE:
+    case CMP_NODE_CHANNEL_MATTE:
+    case CMP_NODE_COLOR_SPILL:
+    /* Distort, sizes are relative to the image. */
+    case CMP_NODE_FLIP:
+    case CMP_NODE_ROTATE:
+    /* Sizes in pixels are scaled to the reduced resolution. */
+    case CMP_NODE_BLUR:
+    case CMP_NODE_DILATEERODE:
+    case CMP_NODE_TRANSLATE:
+      return true;
+    case CMP_NODE_SCALE:
+      /* Absolute sizes are in pixels. */
+      return node->custom1 != CMP_SCALE_ABSOLUTE;
+    case CMP_NODE_CROP:
+      /* custom2 is the relative option. */
+      return node->custom2 != 0;
+    case CMP_NODE_ID_MASK:
+      /* custom2 is the anti-aliasing option, which works on a pixel neighborhood. */
+      return node->custom2 == 0;
+    default:
+      return false;
+  }
+}
+
+static bool ntree_supports_resolution_divider(const bNodeTree *ntree)
+{
+  LISTBASE_FOREACH (const bNode *, node, &ntree->nodes) {
+    if (node->flag & NODE_MUTED) {
+      continue;
+    }
+    if (node->type == NODE_GROUP) {
+      if (node->id && !ntree_supports_resolution_divider((const bNodeTree *)node->id)) {
+        return false;
+      }
+    }
+    else if (!node_supports_resolution_divider(node)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void COM_execute(RenderData *rd,
                  Scene *scene,
                  bNodeTree *editingtree,
@@ -85,10 +198,22 @@ void COM_execute(RenderData *rd,
   editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing"));
 
   bool twopass = (editingtree->flag & NTREE_TWO_PASS) && !rendering;
+  /* Progressive preview: first show the result at a reduced resolution, then refine. */
+  int divider = rendering ? 1 : max_ii(editingtree->progressive_divider, 1);
+  if (divider > 1 && !ntree_supports_resolution_divider(editingtree)) {
+    divider = 1;
+  }
   /* initialize execution system */
-  if (twopass) {
-    ExecutionSystem *system = new ExecutionSystem(
-        rd, scene, editingtree, rendering, twopass, viewSettings, displaySettings, viewName);
+  if (twopass || divider > 1) {
+    ExecutionSystem *system = new ExecutionSystem(rd,
+                                                  scene,
+                                                  editingtree,
+                                                  rendering,
+                                                  twopass,
+                                                  divider,
+                                                  viewSettings,
+                                                  displaySettings,
+                                                  viewName);
     system->execute();
     delete system;
 
@@ -101,7 +226,7 @@ void COM_execute(RenderData *rd,
   }
 
   ExecutionSystem *system = new ExecutionSystem(
-      rd, scene, editingtree, rendering, false, viewSettings, displaySettings, viewName);
+      rd, scene, editingtree, rendering, false, 1, viewSettings, displaySettings, viewName);
   system->execute();
   delete system;
 
@@ -113,6 +238,7 @@ void COM_deinitialize()
   if (is_compositorMutex_init) {
     BLI_mutex_lock(&s_compositorMutex);
     WorkScheduler::deinitialize();
+    COM_profiler_clear();
     is_compositorMutex_init = false;
     BLI_mutex_unlock(&s_compositorMutex);
     BLI_mutex_end(&s_compositorMutex);
@@ -38,7 +38,15 @@ void BlurNode::convertToOperations(NodeConverter &converter,
                                    const CompositorContext &context) const
 {
   bNode *editorNode = this->getbNode();
-  NodeBlurData *data = (NodeBlurData *)editorNode->storage;
+  /* Copy, the operations take their own copy of the settings anyway. */
+  NodeBlurData scaled_data = *(const NodeBlurData *)editorNode->storage;
+  NodeBlurData *data = &scaled_data;
+  if (!data->relative) {
+    /* Sizes in pixels, match a reduced resolution of the evaluation. */
+    const float factor = context.getResolutionFactor();
+    data->sizex = (short)(data->sizex * factor + 0.5f);
+    data->sizey = (short)(data->sizey * factor + 0.5f);
+  }
   NodeInput *inputSizeSocket = this->getInputSocket(1);
   bool connectedSizeSocket = inputSizeSocket->isLinked();
 
@@ -44,9 +44,11 @@ void DilateErodeNode::convertToOperations(NodeConverter &converter,
 {
 
   bNode *editorNode = this->getbNode();
+  /* Distances in pixels, match a reduced resolution of the evaluation. */
+  const float distance = editorNode->custom2 * context.getResolutionFactor();
   if (editorNode->custom1 == CMP_NODE_DILATEERODE_DISTANCE_THRESH) {
     DilateErodeThresholdOperation *operation = new DilateErodeThresholdOperation();
-    operation->setDistance(editorNode->custom2);
+    operation->setDistance(distance);
     operation->setInset(editorNode->custom3);
     converter.addOperation(operation);
 
@@ -66,7 +68,7 @@ void DilateErodeNode::convertToOperations(NodeConverter &converter,
   else if (editorNode->custom1 == CMP_NODE_DILATEERODE_DISTANCE) {
     if (editorNode->custom2 > 0) {
       DilateDistanceOperation *operation = new DilateDistanceOperation();
-      operation->setDistance(editorNode->custom2);
+      operation->setDistance(distance);
       converter.addOperation(operation);
 
       converter.mapInputSocket(getInputSocket(0), operation->getInputSocket(0));
@@ -74,7 +76,7 @@ void DilateErodeNode::convertToOperations(NodeConverter &converter,
     }
     else {
       ErodeDistanceOperation *operation = new ErodeDistanceOperation();
-      operation->setDistance(-editorNode->custom2);
+      operation->setDistance(-distance);
       converter.addOperation(operation);
 
       converter.mapInputSocket(getInputSocket(0), operation->getInputSocket(0));
@@ -85,8 +87,11 @@ void DilateErodeNode::convertToOperations(NodeConverter &converter,
     /* this uses a modified gaussian blur function otherwise its far too slow */
     CompositorQuality quality = context.getQuality();
 
+    NodeBlurData alpha_blur = m_alpha_blur;
+    alpha_blur.sizex = alpha_blur.sizey = (short)(fabsf(distance) + 0.5f);
+
     GaussianAlphaXBlurOperation *operationx = new GaussianAlphaXBlurOperation();
-    operationx->setData(&m_alpha_blur);
+    operationx->setData(&alpha_blur);
     operationx->setQuality(quality);
     operationx->setFalloff(PROP_SMOOTH);
     converter.addOperation(operationx);
@@ -96,7 +101,7 @@ void DilateErodeNode::convertToOperations(NodeConverter &converter,
     // yet
 
     GaussianAlphaYBlurOperation *operationy = new GaussianAlphaYBlurOperation();
-    operationy->setData(&m_alpha_blur);
+    operationy->setData(&alpha_blur);
     operationy->setQuality(quality);
     operationy->setFalloff(PROP_SMOOTH);
     converter.addOperation(operationy);
@@ -129,9 +134,11 @@ void DilateErodeNode::convertToOperations(NodeConverter &converter,
     }
   }
   else {
+    /* Keep at least one step, so the preview still shows the effect. */
+    const int iterations = max_ii((int)(fabsf(distance) + 0.5f), 1);
     if (editorNode->custom2 > 0) {
       DilateStepOperation *operation = new DilateStepOperation();
-      operation->setIterations(editorNode->custom2);
+      operation->setIterations(iterations);
       converter.addOperation(operation);
 
       converter.mapInputSocket(getInputSocket(0), operation->getInputSocket(0));
@@ -139,7 +146,7 @@ void DilateErodeNode::convertToOperations(NodeConverter &converter,
     }
     else {
       ErodeStepOperation *operation = new ErodeStepOperation();
-      operation->setIterations(-editorNode->custom2);
+      operation->setIterations(iterations);
       converter.addOperation(operation);
 
       converter.mapInputSocket(getInputSocket(0), operation->getInputSocket(0));
@@ -59,13 +59,15 @@ void OutputFileNode::convertToOperations(NodeConverter &converter,
                                                                       context.getViewName());
     }
     else {
-      outputOperation = new OutputOpenExrMultiLayerOperation(context.getScene(),
-                                                             context.getRenderData(),
-                                                             context.getbNodeTree(),
-                                                             storage->base_path,
-                                                             storage->format.exr_codec,
-                                                             use_half_float,
-                                                             context.getViewName());
+      outputOperation = new OutputOpenExrMultiLayerOperation(
+          context.getScene(),
+          context.getRenderData(),
+          context.getbNodeTree(),
+          storage->base_path,
+          storage->format.exr_codec,
+          use_half_float,
+          context.getViewName(),
+          (storage->flag & CMP_NODEFLAG_OUTPUT_FILE_TILED) != 0);
     }
     converter.addOperation(outputOperation);
 
@@ -71,7 +71,8 @@ void ScaleNode::convertToOperations(NodeConverter &converter,
     }
     case CMP_SCALE_RENDERPERCENT: {
       const RenderData *rd = context.getRenderData();
-      const float render_size_factor = context.getRenderPercentageAsFactor();
+      const float render_size_factor = context.getRenderPercentageAsFactor() *
+                                       context.getResolutionFactor();
       ScaleFixedSizeOperation *operation = new ScaleFixedSizeOperation();
       /* framing options */
       operation->setIsAspect((bnode->custom2 & CMP_SCALE_RENDERSIZE_FRAME_ASPECT) != 0);
@@ -40,14 +40,19 @@ void TranslateNode::convertToOperations(NodeConverter &converter,
   NodeOutput *outputSocket = this->getOutputSocket(0);
 
   TranslateOperation *operation = new TranslateOperation();
+  /* Offsets in pixels, match a reduced resolution of the evaluation. */
+  const float resolution_factor = context.getResolutionFactor();
   if (data->relative) {
     const RenderData *rd = context.getRenderData();
     const float render_size_factor = context.getRenderPercentageAsFactor();
-    float fx = rd->xsch * render_size_factor;
-    float fy = rd->ysch * render_size_factor;
+    float fx = rd->xsch * render_size_factor * resolution_factor;
+    float fy = rd->ysch * render_size_factor * resolution_factor;
 
     operation->setFactorXY(fx, fy);
   }
+  else if (resolution_factor != 1.0f) {
+    operation->setFactorXY(resolution_factor, resolution_factor);
+  }
 
   converter.addOperation(operation);
   converter.mapInputSocket(inputXSocket, operation->getInputSocket(1));
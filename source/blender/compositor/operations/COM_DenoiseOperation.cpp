@@ -26,6 +26,12 @@ static pthread_mutex_t oidn_lock = BLI_MUTEX_INITIALIZER;
 #endif
 #include <iostream>
 
+/* The image is denoised in tiles which are much larger than compositor chunks, and are shared by
+ * all chunks inside them. Every tile is denoised together with a margin of surrounding pixels,
+ * which gives the denoiser enough context to avoid seams between tiles. */
+#define COM_DENOISE_TILE_SIZE 1024
+#define COM_DENOISE_MARGIN 64
+
 DenoiseOperation::DenoiseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
@@ -33,13 +39,37 @@ DenoiseOperation::DenoiseOperation()
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_COLOR);
   this->m_settings = nullptr;
+  this->m_device = nullptr;
+  this->m_numberOfXTiles = 0;
+  this->setComplex(true);
 }
 void DenoiseOperation::initExecution()
 {
-  SingleThreadedOperation::initExecution();
   this->m_inputProgramColor = getInputSocketReader(0);
   this->m_inputProgramNormal = getInputSocketReader(1);
   this->m_inputProgramAlbedo = getInputSocketReader(2);
+
+  this->m_numberOfXTiles = (this->getWidth() + COM_DENOISE_TILE_SIZE - 1) /
+                           COM_DENOISE_TILE_SIZE;
+  const int number_of_y_tiles = (this->getHeight() + COM_DENOISE_TILE_SIZE - 1) /
+                                COM_DENOISE_TILE_SIZE;
+  this->m_tiles.resize(this->m_numberOfXTiles * number_of_y_tiles);
+  for (int i = 0; i < this->m_tiles.size(); i++) {
+    rcti tile_rect;
+    determineTileRect(i, &tile_rect);
+    this->m_tiles[i].buffer = nullptr;
+    this->m_tiles[i].pixels_remaining = BLI_rcti_size_x(&tile_rect) * BLI_rcti_size_y(&tile_rect);
+  }
+
+#ifdef WITH_OPENIMAGEDENOISE
+  /* Creating and committing a device is expensive, it is shared by all tiles. */
+  if (BLI_cpu_support_sse41()) {
+    oidn::DeviceRef *device = new oidn::DeviceRef(oidn::newDevice());
+    device->commit();
+    this->m_device = device;
+  }
+#endif
+  initMutex();
 }
 
 void DenoiseOperation::deinitExecution()
@@ -47,42 +77,155 @@ void DenoiseOperation::deinitExecution()
   this->m_inputProgramColor = nullptr;
   this->m_inputProgramNormal = nullptr;
   this->m_inputProgramAlbedo = nullptr;
-  SingleThreadedOperation::deinitExecution();
+
+  for (DenoiseTile &tile : this->m_tiles) {
+    delete tile.buffer;
+  }
+  this->m_tiles.clear();
+
+#ifdef WITH_OPENIMAGEDENOISE
+  delete (oidn::DeviceRef *)this->m_device;
+#endif
+  this->m_device = nullptr;
+  deinitMutex();
 }
 
-MemoryBuffer *DenoiseOperation::createMemoryBuffer(rcti *rect2)
+void DenoiseOperation::determineTileRect(int tile_index, rcti *r_tile_rect)
 {
-  MemoryBuffer *tileColor = (MemoryBuffer *)this->m_inputProgramColor->initializeTileData(rect2);
-  MemoryBuffer *tileNormal = (MemoryBuffer *)this->m_inputProgramNormal->initializeTileData(rect2);
-  MemoryBuffer *tileAlbedo = (MemoryBuffer *)this->m_inputProgramAlbedo->initializeTileData(rect2);
-  rcti rect;
-  rect.xmin = 0;
-  rect.ymin = 0;
-  rect.xmax = getWidth();
-  rect.ymax = getHeight();
-  MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, &rect);
-  float *data = result->getBuffer();
-  this->generateDenoise(data, tileColor, tileNormal, tileAlbedo, this->m_settings);
-  return result;
+  const int tile_x = tile_index % this->m_numberOfXTiles;
+  const int tile_y = tile_index / this->m_numberOfXTiles;
+  r_tile_rect->xmin = tile_x * COM_DENOISE_TILE_SIZE;
+  r_tile_rect->xmax = min_ii(r_tile_rect->xmin + COM_DENOISE_TILE_SIZE, this->getWidth());
+  r_tile_rect->ymin = tile_y * COM_DENOISE_TILE_SIZE;
+  r_tile_rect->ymax = min_ii(r_tile_rect->ymin + COM_DENOISE_TILE_SIZE, this->getHeight());
 }
 
-bool DenoiseOperation::determineDependingAreaOfInterest(rcti * /*input*/,
-                                                        ReadBufferOperation *readOperation,
-                                                        rcti *output)
+void DenoiseOperation::determineDenoiseRect(const rcti *rect, rcti *r_denoise_rect)
+{
+  /* All tiles touching the rect, including their margin. */
+  const int xmin = (rect->xmin / COM_DENOISE_TILE_SIZE) * COM_DENOISE_TILE_SIZE;
+  const int ymin = (rect->ymin / COM_DENOISE_TILE_SIZE) * COM_DENOISE_TILE_SIZE;
+  const int xmax = ((rect->xmax + COM_DENOISE_TILE_SIZE - 1) / COM_DENOISE_TILE_SIZE) *
+                   COM_DENOISE_TILE_SIZE;
+  const int ymax = ((rect->ymax + COM_DENOISE_TILE_SIZE - 1) / COM_DENOISE_TILE_SIZE) *
+                   COM_DENOISE_TILE_SIZE;
+  r_denoise_rect->xmin = max_ii(xmin - COM_DENOISE_MARGIN, 0);
+  r_denoise_rect->xmax = min_ii(xmax + COM_DENOISE_MARGIN, this->getWidth());
+  r_denoise_rect->ymin = max_ii(ymin - COM_DENOISE_MARGIN, 0);
+  r_denoise_rect->ymax = min_ii(ymax + COM_DENOISE_MARGIN, this->getHeight());
+}
+
+void DenoiseOperation::determineTileRange(const rcti *rect, rcti *r_tile_range)
+{
+  /* Inclusive range of the tiles overlapping the rect. */
+  r_tile_range->xmin = rect->xmin / COM_DENOISE_TILE_SIZE;
+  r_tile_range->xmax = (rect->xmax - 1) / COM_DENOISE_TILE_SIZE;
+  r_tile_range->ymin = rect->ymin / COM_DENOISE_TILE_SIZE;
+  r_tile_range->ymax = (rect->ymax - 1) / COM_DENOISE_TILE_SIZE;
+}
+
+void *DenoiseOperation::initializeTileData(rcti *rect)
+{
+  rcti tile_range;
+  determineTileRange(rect, &tile_range);
+
+  /* The first chunk inside a tile denoises it. Denoising is serialized anyway, so the tile is
+   * computed while holding the lock, other chunks of the same tile wait for it. */
+  lockMutex();
+  for (int tile_y = tile_range.ymin; tile_y <= tile_range.ymax; tile_y++) {
+    for (int tile_x = tile_range.xmin; tile_x <= tile_range.xmax; tile_x++) {
+      const int tile_index = tile_y * this->m_numberOfXTiles + tile_x;
+      DenoiseTile &tile = this->m_tiles[tile_index];
+      if (tile.buffer != nullptr) {
+        continue;
+      }
+      rcti tile_rect, denoise_rect;
+      determineTileRect(tile_index, &tile_rect);
+      determineDenoiseRect(&tile_rect, &denoise_rect);
+      MemoryBuffer *tileColor = (MemoryBuffer *)this->m_inputProgramColor->initializeTileData(
+          &denoise_rect);
+      MemoryBuffer *tileNormal = (MemoryBuffer *)this->m_inputProgramNormal->initializeTileData(
+          &denoise_rect);
+      MemoryBuffer *tileAlbedo = (MemoryBuffer *)this->m_inputProgramAlbedo->initializeTileData(
+          &denoise_rect);
+      tile.buffer = new MemoryBuffer(COM_DT_COLOR, &denoise_rect);
+      this->generateDenoise(tile.buffer, tileColor, tileNormal, tileAlbedo, this->m_settings);
+    }
+  }
+  unlockMutex();
+
+  /* The chunk's first tile, callers only release tile data that is not null. */
+  return &this->m_tiles[tile_range.ymin * this->m_numberOfXTiles + tile_range.xmin];
+}
+
+void DenoiseOperation::deinitializeTileData(rcti *rect, void *data)
 {
-  if (isCached()) {
-    return false;
+  BLI_assert(data != nullptr);
+  UNUSED_VARS_NDEBUG(data);
+  rcti tile_range;
+  determineTileRange(rect, &tile_range);
+
+  /* Free tiles once all of their pixels were read. */
+  lockMutex();
+  for (int tile_y = tile_range.ymin; tile_y <= tile_range.ymax; tile_y++) {
+    for (int tile_x = tile_range.xmin; tile_x <= tile_range.xmax; tile_x++) {
+      const int tile_index = tile_y * this->m_numberOfXTiles + tile_x;
+      DenoiseTile &tile = this->m_tiles[tile_index];
+      rcti tile_rect, area;
+      determineTileRect(tile_index, &tile_rect);
+      if (tile.buffer == nullptr || !BLI_rcti_isect(rect, &tile_rect, &area)) {
+        continue;
+      }
+      tile.pixels_remaining -= BLI_rcti_size_x(&area) * BLI_rcti_size_y(&area);
+      if (tile.pixels_remaining <= 0) {
+        delete tile.buffer;
+        tile.buffer = nullptr;
+        /* Denoised again if it is requested another time. */
+        tile.pixels_remaining = BLI_rcti_size_x(&tile_rect) * BLI_rcti_size_y(&tile_rect);
+      }
+    }
   }
+  unlockMutex();
+}
+
+int DenoiseOperation::getNumberOfDenoisedTiles()
+{
+  int number_of_tiles = 0;
+  lockMutex();
+  for (const DenoiseTile &tile : this->m_tiles) {
+    number_of_tiles += (tile.buffer != nullptr);
+  }
+  unlockMutex();
+  return number_of_tiles;
+}
+
+void DenoiseOperation::executePixel(float output[4], int x, int y, void * /*data*/)
+{
+  const int tile_index = (y / COM_DENOISE_TILE_SIZE) * this->m_numberOfXTiles +
+                         x / COM_DENOISE_TILE_SIZE;
+  this->m_tiles[tile_index].buffer->readNoCheck(output, x, y);
+}
 
+bool DenoiseOperation::determineDependingAreaOfInterest(rcti *input,
+                                                        ReadBufferOperation *readOperation,
+                                                        rcti *output)
+{
   rcti newInput;
-  newInput.xmax = this->getWidth();
-  newInput.xmin = 0;
-  newInput.ymax = this->getHeight();
-  newInput.ymin = 0;
+  determineDenoiseRect(input, &newInput);
   return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
 }
 
-void DenoiseOperation::generateDenoise(float *data,
+/* Offset in bytes of the first pixel of `rect` in `buffer`, and the stride between rows. */
+static size_t buffer_rect_offset(MemoryBuffer *buffer, const rcti *rect, size_t *r_row_stride)
+{
+  const rcti *buffer_rect = buffer->getRect();
+  const size_t pixel_stride = sizeof(float) * buffer->get_num_channels();
+  *r_row_stride = pixel_stride * buffer->getWidth();
+  return (rect->ymin - buffer_rect->ymin) * (*r_row_stride) +
+         (rect->xmin - buffer_rect->xmin) * pixel_stride;
+}
+
+void DenoiseOperation::generateDenoise(MemoryBuffer *output,
                                        MemoryBuffer *inputTileColor,
                                        MemoryBuffer *inputTileNormal,
                                        MemoryBuffer *inputTileAlbedo,
@@ -93,44 +236,51 @@ void DenoiseOperation::generateDenoise(float *data,
   if (!inputBufferColor) {
     return;
   }
-#ifdef WITH_OPENIMAGEDENOISE
-  if (BLI_cpu_support_sse41()) {
-    oidn::DeviceRef device = oidn::newDevice();
-    device.commit();
 
+  /* The denoised region, inputs are read in place with a row stride. */
+  const rcti *rect = output->getRect();
+  const int width = output->getWidth();
+  const int height = output->getHeight();
+  float *data = output->getBuffer();
+  size_t row_stride;
+  size_t offset;
+
+#ifdef WITH_OPENIMAGEDENOISE
+  if (this->m_device) {
+    oidn::DeviceRef &device = *(oidn::DeviceRef *)this->m_device;
     oidn::FilterRef filter = device.newFilter("RT");
+    offset = buffer_rect_offset(inputTileColor, rect, &row_stride);
     filter.setImage("color",
                     inputBufferColor,
                     oidn::Format::Float3,
-                    inputTileColor->getWidth(),
-                    inputTileColor->getHeight(),
-                    0,
-                    sizeof(float[4]));
+                    width,
+                    height,
+                    offset,
+                    sizeof(float[4]),
+                    row_stride);
     if (inputTileNormal && inputTileNormal->getBuffer()) {
+      offset = buffer_rect_offset(inputTileNormal, rect, &row_stride);
       filter.setImage("normal",
                       inputTileNormal->getBuffer(),
                       oidn::Format::Float3,
-                      inputTileNormal->getWidth(),
-                      inputTileNormal->getHeight(),
-                      0,
-                      sizeof(float[3]));
+                      width,
+                      height,
+                      offset,
+                      sizeof(float) * inputTileNormal->get_num_channels(),
+                      row_stride);
     }
     if (inputTileAlbedo && inputTileAlbedo->getBuffer()) {
+      offset = buffer_rect_offset(inputTileAlbedo, rect, &row_stride);
       filter.setImage("albedo",
                       inputTileAlbedo->getBuffer(),
                       oidn::Format::Float3,
-                      inputTileAlbedo->getWidth(),
-                      inputTileAlbedo->getHeight(),
-                      0,
-                      sizeof(float[4]));
+                      width,
+                      height,
+                      offset,
+                      sizeof(float) * inputTileAlbedo->get_num_channels(),
+                      row_stride);
     }
-    filter.setImage("output",
-                    data,
-                    oidn::Format::Float3,
-                    inputTileColor->getWidth(),
-                    inputTileColor->getHeight(),
-                    0,
-                    sizeof(float[4]));
+    filter.setImage("output", data, oidn::Format::Float3, width, height, 0, sizeof(float[4]));
 
     BLI_assert(settings);
     if (settings) {
@@ -147,16 +297,22 @@ void DenoiseOperation::generateDenoise(float *data,
     BLI_mutex_unlock(&oidn_lock);
 
     /* copy the alpha channel, OpenImageDenoise currently only supports RGB */
-    size_t numPixels = inputTileColor->getWidth() * inputTileColor->getHeight();
-    for (size_t i = 0; i < numPixels; i++) {
-      data[i * 4 + 3] = inputBufferColor[i * 4 + 3];
+    offset = buffer_rect_offset(inputTileColor, rect, &row_stride) / sizeof(float);
+    for (int y = 0; y < height; y++) {
+      const float *color = inputBufferColor + offset + y * (row_stride / sizeof(float));
+      for (int x = 0; x < width; x++) {
+        data[(y * width + x) * 4 + 3] = color[x * 4 + 3];
+      }
     }
     return;
   }
 #endif
   /* If built without OIDN or running on an unsupported CPU, just pass through. */
   UNUSED_VARS(inputTileAlbedo, inputTileNormal, settings);
-  ::memcpy(data,
-           inputBufferColor,
-           sizeof(float[4]) * inputTileColor->getWidth() * inputTileColor->getHeight());
+  offset = buffer_rect_offset(inputTileColor, rect, &row_stride) / sizeof(float);
+  for (int y = 0; y < height; y++) {
+    ::memcpy(data + y * width * 4,
+             inputBufferColor + offset + y * (row_stride / sizeof(float)),
+             sizeof(float[4]) * width);
+  }
 }
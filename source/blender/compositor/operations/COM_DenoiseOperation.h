@@ -18,10 +18,23 @@
 
 #pragma once
 
-#include "COM_SingleThreadedOperation.h"
+#include "COM_NodeOperation.h"
 #include "DNA_node_types.h"
 
-class DenoiseOperation : public SingleThreadedOperation {
+/* Denoised part of the image, shared by all chunks inside it. */
+struct DenoiseTile {
+  /* Denoised pixels including the margin, allocated by the first chunk using the tile. */
+  MemoryBuffer *buffer;
+  /* Pixels that still have to be read before the buffer can be freed. */
+  int pixels_remaining;
+};
+
+/**
+ * Denoise the image tile by tile. Tiles are larger than chunks, and every tile is denoised
+ * together with a margin of surrounding pixels, so the denoiser has enough context around the
+ * tile borders.
+ */
+class DenoiseOperation : public NodeOperation {
  private:
   /**
    * \brief Cached reference to the input programs
@@ -35,6 +48,12 @@ class DenoiseOperation : public SingleThreadedOperation {
    */
   NodeDenoise *m_settings;
 
+  /* OpenImageDenoise device, created once for all tiles. */
+  void *m_device;
+
+  std::vector<DenoiseTile> m_tiles;
+  int m_numberOfXTiles;
+
  public:
   DenoiseOperation();
   /**
@@ -55,12 +74,29 @@ class DenoiseOperation : public SingleThreadedOperation {
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
 
+  /**
+   * Denoise the tiles overlapping the chunk, unless they were denoised already.
+   * Tiles are freed when all of their chunks released their tile data.
+   */
+  void *initializeTileData(rcti *rect);
+  void deinitializeTileData(rcti *rect, void *data);
+
+  /* Number of denoised tiles kept in memory. */
+  int getNumberOfDenoisedTiles();
+
+  /**
+   * The inner loop of this operation.
+   */
+  void executePixel(float output[4], int x, int y, void *data);
+
  protected:
-  void generateDenoise(float *data,
+  void determineTileRect(int tile_index, rcti *r_tile_rect);
+  void determineTileRange(const rcti *rect, rcti *r_tile_range);
+  void determineDenoiseRect(const rcti *rect, rcti *r_denoise_rect);
+
+  void generateDenoise(MemoryBuffer *output,
                        MemoryBuffer *inputTileColor,
                        MemoryBuffer *inputTileNormal,
                        MemoryBuffer *inputTileAlbedo,
                        NodeDenoise *settings);
-
-  MemoryBuffer *createMemoryBuffer(rcti *rect);
 };
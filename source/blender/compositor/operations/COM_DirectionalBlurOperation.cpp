@@ -131,16 +131,62 @@ void DirectionalBlurOperation::deinitExecution()
   this->m_inputProgram = nullptr;
 }
 
-bool DirectionalBlurOperation::determineDependingAreaOfInterest(rcti * /*input*/,
+/* Above this number of iterations the bounds of the samples aren't worth computing. */
+#define COM_DIRECTIONAL_BLUR_MAX_BOUNDED_ITERATIONS (1 << 12)
+
+bool DirectionalBlurOperation::determineDependingAreaOfInterest(rcti *input,
                                                                 ReadBufferOperation *readOperation,
                                                                 rcti *output)
 {
   rcti newInput;
+  const int iterations = pow(2.0f, this->m_data->iter);
+
+  if (iterations > COM_DIRECTIONAL_BLUR_MAX_BOUNDED_ITERATIONS) {
+    newInput.xmax = this->getWidth();
+    newInput.xmin = 0;
+    newInput.ymax = this->getHeight();
+    newInput.ymin = 0;
+    return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
+  }
+
+  /* Every iteration samples an affine transform of the pixel, so the samples of the area are
+   * bounded by the transformed corners of the area. Same transforms as executePixel. */
+  const float corners[4][2] = {{(float)input->xmin, (float)input->ymin},
+                               {(float)input->xmax, (float)input->ymin},
+                               {(float)input->xmin, (float)input->ymax},
+                               {(float)input->xmax, (float)input->ymax}};
+  float minx = input->xmin, maxx = input->xmax;
+  float miny = input->ymin, maxy = input->ymax;
+  float ltx = this->m_tx;
+  float lty = this->m_ty;
+  float lsc = this->m_sc;
+  float lrot = this->m_rot;
+  for (int i = 0; i < iterations; i++) {
+    const float cs = cosf(lrot), ss = sinf(lrot);
+    const float isc = 1.0f / (1.0f + lsc);
+
+    for (int corner = 0; corner < 4; corner++) {
+      const float v = isc * (corners[corner][1] - this->m_center_y_pix) + lty;
+      const float u = isc * (corners[corner][0] - this->m_center_x_pix) + ltx;
+      const float x = cs * u + ss * v + this->m_center_x_pix;
+      const float y = cs * v - ss * u + this->m_center_y_pix;
+      minx = min_ff(minx, x);
+      maxx = max_ff(maxx, x);
+      miny = min_ff(miny, y);
+      maxy = max_ff(maxy, y);
+    }
+
+    ltx += this->m_tx;
+    lty += this->m_ty;
+    lrot += this->m_rot;
+    lsc += this->m_sc;
+  }
 
-  newInput.xmax = this->getWidth();
-  newInput.xmin = 0;
-  newInput.ymax = this->getHeight();
-  newInput.ymin = 0;
+  /* Margin for bilinear sampling. */
+  newInput.xmin = (int)floorf(minx) - 1;
+  newInput.xmax = (int)ceilf(maxx) + 1;
+  newInput.ymin = (int)floorf(miny) - 1;
+  newInput.ymax = (int)ceilf(maxy) + 1;
 
   return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
 }
@@ -83,37 +83,48 @@ void *FastGaussianBlurOperation::initializeTileData(rcti *rect)
     MemoryBuffer *copy = newBuf->duplicate();
     updateSize();
 
-    int c;
+    rcti region;
+    getRegionOfInterest(&region);
+
     this->m_sx = this->m_data.sizex * this->m_size / 2.0f;
     this->m_sy = this->m_data.sizey * this->m_size / 2.0f;
-
-    if ((this->m_sx == this->m_sy) && (this->m_sx > 0.0f)) {
-      for (c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
-        IIR_gauss(copy, this->m_sx, c, 3);
-      }
-    }
-    else {
-      if (this->m_sx > 0.0f) {
-        for (c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
-          IIR_gauss(copy, this->m_sx, c, 1);
-        }
-      }
-      if (this->m_sy > 0.0f) {
-        for (c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
-          IIR_gauss(copy, this->m_sy, c, 2);
-        }
-      }
-    }
+    gauss_blur(copy, this->m_sx, this->m_sy, &region);
     this->m_iirgaus = copy;
   }
   unlockMutex();
   return this->m_iirgaus;
 }
 
-void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
-                                          float sigma,
-                                          unsigned int chan,
-                                          unsigned int xy)
+void FastGaussianBlurOperation::gauss_blur(MemoryBuffer *buffer,
+                                           float sigma_x,
+                                           float sigma_y,
+                                           const rcti *region)
+{
+  int c;
+  if ((sigma_x == sigma_y) && (sigma_x > 0.0f)) {
+    for (c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+      IIR_gauss(buffer, sigma_x, c, 3, region);
+    }
+    return;
+  }
+
+  if (sigma_x > 0.0f) {
+    /* The vertical pass reads every row of the columns it blurs, so they all have to be blurred
+     * horizontally first. */
+    const bool vertical_pass = sigma_y > 0.0f;
+    for (c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+      IIR_gauss(buffer, sigma_x, c, 1, vertical_pass ? nullptr : region);
+    }
+  }
+  if (sigma_y > 0.0f) {
+    for (c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+      IIR_gauss(buffer, sigma_y, c, 2, region);
+    }
+  }
+}
+
+void FastGaussianBlurOperation::IIR_gauss(
+    MemoryBuffer *src, float sigma, unsigned int chan, unsigned int xy, const rcti *region)
 {
   double q, q2, sc, cf[4], tsM[9], tsu[3], tsv[3];
   double *X, *Y, *W;
@@ -208,6 +219,18 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
   } \
   (void)0
 
+  // rows and columns of the result that are needed, the vertical pass needs all rows
+  unsigned int xmin = 0, xmax = src_width, ymin = 0, ymax = src_height;
+  if (region) {
+    const rcti *src_rect = src->getRect();
+    xmin = (unsigned int)max(region->xmin - src_rect->xmin, 0);
+    xmax = (unsigned int)max(min(region->xmax - src_rect->xmin, (int)src_width), 0);
+    if (!(xy & 2)) {
+      ymin = (unsigned int)max(region->ymin - src_rect->ymin, 0);
+      ymax = (unsigned int)max(min(region->ymax - src_rect->ymin, (int)src_height), 0);
+    }
+  }
+
   // intermediate buffers
   sz = max(src_width, src_height);
   X = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss X buf");
@@ -215,7 +238,7 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
   W = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss W buf");
   if (xy & 1) {  // H
     int offset;
-    for (y = 0; y < src_height; y++) {
+    for (y = ymin; y < ymax; y++) {
       const int yx = y * src_width;
       offset = yx * num_channels + chan;
       for (x = 0; x < src_width; x++) {
@@ -234,7 +257,7 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
     int offset;
     const int add = src_width * num_channels;
 
-    for (x = 0; x < src_width; x++) {
+    for (x = xmin; x < xmax; x++) {
       offset = x * num_channels + chan;
       for (y = 0; y < src_height; y++) {
         X[y] = buffer[offset];
@@ -311,7 +334,9 @@ void *FastGaussianBlurValueOperation::initializeTileData(rcti *rect)
   if (!this->m_iirgaus) {
     MemoryBuffer *newBuf = (MemoryBuffer *)this->m_inputprogram->initializeTileData(rect);
     MemoryBuffer *copy = newBuf->duplicate();
-    FastGaussianBlurOperation::IIR_gauss(copy, this->m_sigma, 0, 3);
+    rcti region;
+    getRegionOfInterest(&region);
+    FastGaussianBlurOperation::IIR_gauss(copy, this->m_sigma, 0, 3, &region);
 
     if (this->m_overlay == FAST_GAUSS_OVERLAY_MIN) {
       float *src = newBuf->getBuffer();
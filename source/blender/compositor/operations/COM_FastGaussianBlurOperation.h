@@ -34,7 +34,23 @@ class FastGaussianBlurOperation : public BlurBaseOperation {
                                         rcti *output);
   void executePixel(float output[4], int x, int y, void *data);
 
-  static void IIR_gauss(MemoryBuffer *src, float sigma, unsigned int channel, unsigned int xy);
+  /**
+   * \param region: when given only this part of the result is needed, the blur is skipped for
+   * the rows and columns that don't contribute to it.
+   */
+  static void IIR_gauss(MemoryBuffer *src,
+                        float sigma,
+                        unsigned int channel,
+                        unsigned int xy,
+                        const rcti *region = nullptr);
+  /**
+   * Blur all color channels with the given sigma in each direction.
+   * \param region: when given only this part of the result is valid.
+   */
+  static void gauss_blur(MemoryBuffer *buffer,
+                         float sigma_x,
+                         float sigma_y,
+                         const rcti *region = nullptr);
   void *initializeTileData(rcti *rect);
   void deinitExecution();
   void initExecution();
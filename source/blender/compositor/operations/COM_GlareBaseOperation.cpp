@@ -39,6 +39,8 @@ void GlareBaseOperation::deinitExecution()
 
 MemoryBuffer *GlareBaseOperation::createMemoryBuffer(rcti *rect2)
 {
+  /* Streaks, ghosts and fog glow spread light over the whole frame, so the full frame is
+   * calculated even when only the region of interest in rect2 is read. */
   MemoryBuffer *tile = (MemoryBuffer *)this->m_inputProgram->initializeTileData(rect2);
   rcti rect;
   rect.xmin = 0;
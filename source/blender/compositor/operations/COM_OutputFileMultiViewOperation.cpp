@@ -151,7 +151,9 @@ OutputOpenExrMultiLayerMultiViewOperation::OutputOpenExrMultiLayerMultiViewOpera
     char exr_codec,
     bool exr_half_float,
     const char *viewName)
-    : OutputOpenExrMultiLayerOperation(scene, rd, tree, path, exr_codec, exr_half_float, viewName)
+    /* All views are collected in full frame buffers and written together by the last view. */
+    : OutputOpenExrMultiLayerOperation(
+          scene, rd, tree, path, exr_codec, exr_half_float, viewName, false)
 {
 }
 
@@ -41,6 +41,10 @@
 
 #include "RE_pipeline.h"
 
+/* Size of the tiles of progressively written multilayer files. Small tiles keep the amount of
+ * partially filled tiles low when chunks and tiles are not aligned. */
+#define COM_EXR_TILE_SIZE 64
+
 void add_exr_channels(void *exrhandle,
                       const char *layerName,
                       const DataType datatype,
@@ -312,7 +316,8 @@ OutputOpenExrMultiLayerOperation::OutputOpenExrMultiLayerOperation(const Scene *
                                                                    const char *path,
                                                                    char exr_codec,
                                                                    bool exr_half_float,
-                                                                   const char *viewName)
+                                                                   const char *viewName,
+                                                                   bool use_tiled_write)
 {
   this->m_scene = scene;
   this->m_rd = rd;
@@ -322,6 +327,11 @@ OutputOpenExrMultiLayerOperation::OutputOpenExrMultiLayerOperation(const Scene *
   this->m_exr_codec = exr_codec;
   this->m_exr_half_float = exr_half_float;
   this->m_viewName = viewName;
+
+  this->m_use_tiled_write = use_tiled_write;
+  this->m_exrhandle = nullptr;
+  this->m_numberOfXTiles = 0;
+  this->m_numberOfYTiles = 0;
 }
 
 void OutputOpenExrMultiLayerOperation::add_layer(const char *name,
@@ -362,14 +372,68 @@ void OutputOpenExrMultiLayerOperation::initExecution()
     if (this->m_layers[i].use_layer) {
       SocketReader *reader = getInputSocketReader(i);
       this->m_layers[i].imageInput = reader;
-      this->m_layers[i].outputBuffer = init_buffer(
-          this->getWidth(), this->getHeight(), this->m_layers[i].datatype);
+      if (!useTiledWrite()) {
+        this->m_layers[i].outputBuffer = init_buffer(
+            this->getWidth(), this->getHeight(), this->m_layers[i].datatype);
+      }
     }
   }
+
+  if (useTiledWrite()) {
+    initTiledWrite();
+  }
 }
 
 void OutputOpenExrMultiLayerOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 {
+  if (useTiledWrite()) {
+    if (this->m_exrhandle == nullptr) {
+      return;
+    }
+    /* Tiles are counted from the top of the image in the file. */
+    const int height = this->getHeight();
+    const int tile_xmin = rect->xmin / COM_EXR_TILE_SIZE;
+    const int tile_xmax = (rect->xmax - 1) / COM_EXR_TILE_SIZE;
+    const int tile_ymin = (height - rect->ymax) / COM_EXR_TILE_SIZE;
+    const int tile_ymax = (height - rect->ymin - 1) / COM_EXR_TILE_SIZE;
+    const int tiles_x = tile_xmax - tile_xmin + 1;
+    const int tiles_y = tile_ymax - tile_ymin + 1;
+
+    /* Buffers of the tiles finished by this chunk, which are now owned by this thread. */
+    std::vector<float *> finished(tiles_x * tiles_y, nullptr);
+    bool all_finished = true;
+    for (int y = 0; y < tiles_y; y++) {
+      for (int x = 0; x < tiles_x; x++) {
+        float *buffer = executeTile(rect, tile_xmin + x, tile_ymin + y);
+        finished[y * tiles_x + x] = buffer;
+        all_finished &= (buffer != nullptr);
+      }
+    }
+
+    /* Write finished tiles in blocks that are as large as possible, OpenEXR compresses the tiles
+     * of a block in parallel. When chunks are aligned to tiles all of them finish together. */
+    if (all_finished) {
+      writeTiles(tile_xmin, tile_ymin, tiles_x, tiles_y, finished.data());
+      return;
+    }
+    for (int y = 0; y < tiles_y; y++) {
+      float **row = finished.data() + y * tiles_x;
+      for (int x = 0; x < tiles_x;) {
+        if (row[x] == nullptr) {
+          x++;
+          continue;
+        }
+        int run = 1;
+        while (x + run < tiles_x && row[x + run] != nullptr) {
+          run++;
+        }
+        writeTiles(tile_xmin + x, tile_ymin + y, run, 1, row + x);
+        x += run;
+      }
+    }
+    return;
+  }
+
   for (unsigned int i = 0; i < this->m_layers.size(); i++) {
     OutputOpenExrLayer &layer = this->m_layers[i];
     if (layer.imageInput) {
@@ -385,6 +449,11 @@ void OutputOpenExrMultiLayerOperation::executeRegion(rcti *rect, unsigned int /*
 
 void OutputOpenExrMultiLayerOperation::deinitExecution()
 {
+  if (useTiledWrite()) {
+    deinitTiledWrite();
+    return;
+  }
+
   unsigned int width = this->getWidth();
   unsigned int height = this->getHeight();
   if (width != 0 && height != 0) {
@@ -441,3 +510,213 @@ void OutputOpenExrMultiLayerOperation::deinitExecution()
     BKE_stamp_data_free(stamp_data);
   }
 }
+
+/* Number of floats per pixel of all connected layers, which is the layout of a tile buffer. */
+static int tile_pixel_size(const std::vector<OutputOpenExrLayer> &layers)
+{
+  int size = 0;
+  for (const OutputOpenExrLayer &layer : layers) {
+    if (layer.imageInput) {
+      size += get_datatype_size(layer.datatype);
+    }
+  }
+  return size;
+}
+
+void OutputOpenExrMultiLayerOperation::initTiledWrite()
+{
+  const int width = this->getWidth();
+  const int height = this->getHeight();
+  if (width == 0 || height == 0) {
+    return;
+  }
+
+  char filename[FILE_MAX];
+  const char *suffix = BKE_scene_multiview_view_suffix_get(this->m_rd, this->m_viewName);
+  BKE_image_path_from_imtype(filename,
+                             this->m_path,
+                             BKE_main_blendfile_path_from_global(),
+                             this->m_rd->cfra,
+                             R_IMF_IMTYPE_MULTILAYER,
+                             (this->m_rd->scemode & R_EXTENSION) != 0,
+                             true,
+                             suffix);
+  BLI_make_existing_file(filename);
+
+  void *exrhandle = IMB_exr_get_handle();
+  for (unsigned int i = 0; i < this->m_layers.size(); i++) {
+    OutputOpenExrLayer &layer = this->m_layers[i];
+    if (!layer.imageInput) {
+      continue; /* skip unconnected sockets */
+    }
+    /* Channels are only declared here, tile buffers are passed when writing each tile. */
+    add_exr_channels(exrhandle,
+                     layer.name,
+                     layer.datatype,
+                     "",
+                     COM_EXR_TILE_SIZE,
+                     this->m_exr_half_float,
+                     nullptr);
+  }
+
+  /* when the filename has no permissions, this can fail */
+  StampData *stamp_data = createStampData();
+  const bool ok = IMB_exr_begin_write_tiled(
+      exrhandle, filename, width, height, COM_EXR_TILE_SIZE, this->m_exr_codec, stamp_data);
+  BKE_stamp_data_free(stamp_data);
+  if (!ok) {
+    printf("Error Writing Render Result, see console\n");
+    IMB_exr_close(exrhandle);
+    return;
+  }
+
+  this->m_exrhandle = exrhandle;
+  this->m_numberOfXTiles = (width + COM_EXR_TILE_SIZE - 1) / COM_EXR_TILE_SIZE;
+  this->m_numberOfYTiles = (height + COM_EXR_TILE_SIZE - 1) / COM_EXR_TILE_SIZE;
+  this->m_tiles.resize(this->m_numberOfXTiles * this->m_numberOfYTiles);
+  for (int tile_y = 0; tile_y < this->m_numberOfYTiles; tile_y++) {
+    for (int tile_x = 0; tile_x < this->m_numberOfXTiles; tile_x++) {
+      OutputOpenExrTile &tile = this->m_tiles[tile_y * this->m_numberOfXTiles + tile_x];
+      const int tile_width = min_ii(COM_EXR_TILE_SIZE, width - tile_x * COM_EXR_TILE_SIZE);
+      const int tile_height = min_ii(COM_EXR_TILE_SIZE, height - tile_y * COM_EXR_TILE_SIZE);
+      tile.buffer = nullptr;
+      tile.pixels_remaining = tile_width * tile_height;
+    }
+  }
+  initMutex();
+}
+
+/* Fill the part of a tile covered by rect. When this completes the tile, its buffer is returned
+ * and owned by the caller, which has to write it. */
+float *OutputOpenExrMultiLayerOperation::executeTile(const rcti *rect, int tile_x, int tile_y)
+{
+  const int height = this->getHeight();
+  OutputOpenExrTile &tile = this->m_tiles[tile_y * this->m_numberOfXTiles + tile_x];
+
+  /* Area of the tile in image space, rows of the file are stored top to bottom. */
+  rcti tile_rect, area;
+  BLI_rcti_init(&tile_rect,
+                tile_x * COM_EXR_TILE_SIZE,
+                (tile_x + 1) * COM_EXR_TILE_SIZE,
+                height - (tile_y + 1) * COM_EXR_TILE_SIZE,
+                height - tile_y * COM_EXR_TILE_SIZE);
+  if (!BLI_rcti_isect(rect, &tile_rect, &area)) {
+    return nullptr;
+  }
+
+  const int pixel_size = tile_pixel_size(this->m_layers);
+  lockMutex();
+  if (tile.buffer == nullptr) {
+    tile.buffer = (float *)MEM_callocN(sizeof(float) * pixel_size * COM_EXR_TILE_SIZE *
+                                           COM_EXR_TILE_SIZE,
+                                       "OutputFile tile");
+  }
+  float *buffer = tile.buffer;
+  unlockMutex();
+
+  /* Chunks never overlap, so the pixels can be filled without holding the lock. */
+  float *layer_buffer = buffer;
+  for (unsigned int i = 0; i < this->m_layers.size(); i++) {
+    OutputOpenExrLayer &layer = this->m_layers[i];
+    if (!layer.imageInput) {
+      continue;
+    }
+    const int size = get_datatype_size(layer.datatype);
+    float color[4];
+    for (int y = area.ymin; y < area.ymax; y++) {
+      const int row = tile_rect.ymax - 1 - y;
+      float *pixel = layer_buffer + (row * COM_EXR_TILE_SIZE + area.xmin - tile_rect.xmin) * size;
+      for (int x = area.xmin; x < area.xmax; x++) {
+        layer.imageInput->readSampled(color, x, y, COM_PS_NEAREST);
+        for (int c = 0; c < size; c++) {
+          pixel[c] = color[c];
+        }
+        pixel += size;
+      }
+      if (isBraked()) {
+        break;
+      }
+    }
+    layer_buffer += size * COM_EXR_TILE_SIZE * COM_EXR_TILE_SIZE;
+  }
+
+  /* Only the bookkeeping is locked, the tile is written by the caller. */
+  lockMutex();
+  tile.pixels_remaining -= BLI_rcti_size_x(&area) * BLI_rcti_size_y(&area);
+  const bool is_finished = (tile.pixels_remaining == 0);
+  if (is_finished) {
+    tile.buffer = nullptr;
+    tile.pixels_remaining = -1;
+  }
+  unlockMutex();
+
+  return is_finished ? buffer : nullptr;
+}
+
+/* Write a block of tiles and free their buffers. Buffers are owned by the calling thread, so no
+ * lock of the operation is needed, imbuf serializes the file access. */
+void OutputOpenExrMultiLayerOperation::writeTiles(
+    int tile_x, int tile_y, int tiles_x, int tiles_y, float *const *buffers)
+{
+  /* Channel pointers of every tile in the order of #add_exr_channels. */
+  std::vector<float *> rects;
+  std::vector<float *const *> tile_rects;
+  rects.reserve(tiles_x * tiles_y * tile_pixel_size(this->m_layers));
+  for (int i = 0; i < tiles_x * tiles_y; i++) {
+    float *layer_buffer = buffers[i];
+    for (unsigned int j = 0; j < this->m_layers.size(); j++) {
+      OutputOpenExrLayer &layer = this->m_layers[j];
+      if (!layer.imageInput) {
+        continue;
+      }
+      const int size = get_datatype_size(layer.datatype);
+      for (int c = 0; c < size; c++) {
+        rects.push_back(layer_buffer + c);
+      }
+      layer_buffer += size * COM_EXR_TILE_SIZE * COM_EXR_TILE_SIZE;
+    }
+  }
+  const int channels_len = tile_pixel_size(this->m_layers);
+  for (int i = 0; i < tiles_x * tiles_y; i++) {
+    tile_rects.push_back(rects.data() + i * channels_len);
+  }
+
+  IMB_exr_write_tiles(this->m_exrhandle, tile_x, tile_y, tiles_x, tiles_y, tile_rects.data());
+
+  for (int i = 0; i < tiles_x * tiles_y; i++) {
+    MEM_freeN(buffers[i]);
+  }
+}
+
+void OutputOpenExrMultiLayerOperation::deinitTiledWrite()
+{
+  if (this->m_exrhandle != nullptr) {
+    /* Tiles which were not finished (e.g. when cancelled) are written as they are. */
+    for (int tile_y = 0; tile_y < this->m_numberOfYTiles; tile_y++) {
+      for (int tile_x = 0; tile_x < this->m_numberOfXTiles; tile_x++) {
+        OutputOpenExrTile &tile = this->m_tiles[tile_y * this->m_numberOfXTiles + tile_x];
+        if (tile.pixels_remaining <= 0) {
+          continue;
+        }
+        if (tile.buffer == nullptr) {
+          /* Never executed, write black pixels so the file is complete. */
+          tile.buffer = (float *)MEM_callocN(sizeof(float) * tile_pixel_size(this->m_layers) *
+                                                 COM_EXR_TILE_SIZE * COM_EXR_TILE_SIZE,
+                                             "OutputFile tile");
+        }
+        writeTiles(tile_x, tile_y, 1, 1, &tile.buffer);
+        tile.buffer = nullptr;
+      }
+    }
+    IMB_exr_close(this->m_exrhandle);
+    this->m_exrhandle = nullptr;
+    deinitMutex();
+  }
+
+  this->m_tiles.clear();
+  this->m_numberOfXTiles = 0;
+  this->m_numberOfYTiles = 0;
+  for (unsigned int i = 0; i < this->m_layers.size(); i++) {
+    this->m_layers[i].imageInput = nullptr;
+  }
+}
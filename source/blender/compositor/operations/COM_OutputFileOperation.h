@@ -88,6 +88,14 @@ struct OutputOpenExrLayer {
   SocketReader *imageInput;
 };
 
+/* Tile of a multilayer file which is written progressively. A tile is filled by the chunks
+ * overlapping it and written as soon as all of its pixels are known. */
+struct OutputOpenExrTile {
+  /* Pixels of all connected layers after each other, allocated on first use. */
+  float *buffer;
+  int pixels_remaining;
+};
+
 /* Writes inputs into OpenEXR multilayer channels. */
 class OutputOpenExrMultiLayerOperation : public NodeOperation {
  protected:
@@ -103,8 +111,29 @@ class OutputOpenExrMultiLayerOperation : public NodeOperation {
   LayerList m_layers;
   const char *m_viewName;
 
+  /* Tiled writing, the file is opened in #initExecution and tiles are written as they finish. */
+  bool m_use_tiled_write;
+  void *m_exrhandle;
+  std::vector<OutputOpenExrTile> m_tiles;
+  int m_numberOfXTiles;
+  int m_numberOfYTiles;
+
   StampData *createStampData() const;
 
+  /**
+   * When true, tiles are streamed to the file while executing, otherwise the layers are kept in
+   * full frame buffers and written in #deinitExecution.
+   */
+  bool useTiledWrite() const
+  {
+    return this->m_use_tiled_write;
+  }
+
+  void initTiledWrite();
+  float *executeTile(const rcti *rect, int tile_x, int tile_y);
+  void writeTiles(int tile_x, int tile_y, int tiles_x, int tiles_y, float *const *buffers);
+  void deinitTiledWrite();
+
  public:
   OutputOpenExrMultiLayerOperation(const Scene *scene,
                                    const RenderData *rd,
@@ -112,7 +141,8 @@ class OutputOpenExrMultiLayerOperation : public NodeOperation {
                                    const char *path,
                                    char exr_codec,
                                    bool exr_half_float,
-                                   const char *viewName);
+                                   const char *viewName,
+                                   bool use_tiled_write);
 
   void add_layer(const char *name, DataType datatype, bool use_layer);
 
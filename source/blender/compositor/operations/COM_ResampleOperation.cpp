@@ -0,0 +1,163 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "COM_ResampleOperation.h"
+
+#include "BLI_math.h"
+
+ResampleOperation::ResampleOperation(DataType datatype, int divider)
+{
+  this->addInputSocket(datatype, COM_SC_NO_RESIZE);
+  this->addOutputSocket(datatype);
+  this->m_inputOperation = nullptr;
+  this->m_divider = divider;
+  this->m_scaleX = 1.0f;
+  this->m_scaleY = 1.0f;
+}
+
+void ResampleOperation::initExecution()
+{
+  this->m_inputOperation = this->getInputSocketReader(0);
+  this->m_scaleX = (float)this->m_inputOperation->getWidth() / MAX2(this->getWidth(), 1u);
+  this->m_scaleY = (float)this->m_inputOperation->getHeight() / MAX2(this->getHeight(), 1u);
+}
+
+void ResampleOperation::deinitExecution()
+{
+  this->m_inputOperation = nullptr;
+}
+
+void ResampleOperation::executePixelSampled(float output[4],
+                                            float x,
+                                            float y,
+                                            PixelSampler /*sampler*/)
+{
+  /* Map pixel centers. */
+  const float u = (x + 0.5f) * this->m_scaleX - 0.5f;
+  const float v = (y + 0.5f) * this->m_scaleY - 0.5f;
+  this->m_inputOperation->readSampled(output, u, v, COM_PS_BILINEAR);
+}
+
+void ResampleOperation::mapArea(const rcti *input,
+                                float scaleX,
+                                float scaleY,
+                                rcti *r_output) const
+{
+  /* One pixel margin for bilinear sampling. */
+  r_output->xmin = (int)floorf(input->xmin * scaleX) - 1;
+  r_output->xmax = (int)ceilf(input->xmax * scaleX) + 1;
+  r_output->ymin = (int)floorf(input->ymin * scaleY) - 1;
+  r_output->ymax = (int)ceilf(input->ymax * scaleY) + 1;
+}
+
+/* ******** Downsample Operation ******** */
+
+DownsampleOperation::DownsampleOperation(DataType datatype, int divider)
+    : ResampleOperation(datatype, divider)
+{
+}
+
+void DownsampleOperation::determineResolution(unsigned int resolution[2],
+                                              unsigned int preferredResolution[2])
+{
+  unsigned int inputPreferredResolution[2] = {preferredResolution[0] * this->m_divider,
+                                              preferredResolution[1] * this->m_divider};
+  NodeOperation::determineResolution(resolution, inputPreferredResolution);
+  resolution[0] = divide_ceil_u(resolution[0], this->m_divider);
+  resolution[1] = divide_ceil_u(resolution[1], this->m_divider);
+}
+
+void DownsampleOperation::executePixelSampled(float output[4],
+                                              float x,
+                                              float y,
+                                              PixelSampler /*sampler*/)
+{
+  /* Box filter, a bilinear sample only averages all covered pixels for a divider of two. */
+  const int divider = this->m_divider;
+  const int xmin = (int)x * divider;
+  const int ymin = (int)y * divider;
+  const int xmax = min_ii(xmin + divider, (int)this->m_inputOperation->getWidth());
+  const int ymax = min_ii(ymin + divider, (int)this->m_inputOperation->getHeight());
+
+  zero_v4(output);
+  int count = 0;
+  for (int iy = ymin; iy < ymax; iy++) {
+    for (int ix = xmin; ix < xmax; ix++) {
+      float color[4];
+      this->m_inputOperation->readSampled(color, ix, iy, COM_PS_NEAREST);
+      add_v4_v4(output, color);
+      count++;
+    }
+  }
+  if (count > 0) {
+    mul_v4_fl(output, 1.0f / count);
+  }
+}
+
+bool DownsampleOperation::determineDependingAreaOfInterest(rcti *input,
+                                                           ReadBufferOperation *readOperation,
+                                                           rcti *output)
+{
+  rcti newInput;
+  newInput.xmin = input->xmin * this->m_divider;
+  newInput.xmax = (input->xmax + 1) * this->m_divider;
+  newInput.ymin = input->ymin * this->m_divider;
+  newInput.ymax = (input->ymax + 1) * this->m_divider;
+  return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
+}
+
+/* ******** Upsample Operation ******** */
+
+UpsampleOperation::UpsampleOperation(DataType datatype, int divider)
+    : ResampleOperation(datatype, divider)
+{
+  this->setComplex(true);
+}
+
+void UpsampleOperation::determineResolution(unsigned int resolution[2],
+                                            unsigned int preferredResolution[2])
+{
+  unsigned int inputPreferredResolution[2] = {
+      divide_ceil_u(preferredResolution[0], this->m_divider),
+      divide_ceil_u(preferredResolution[1], this->m_divider)};
+  NodeOperation::determineResolution(resolution, inputPreferredResolution);
+
+  for (int i = 0; i < 2; i++) {
+    const unsigned int upsampled = resolution[i] * this->m_divider;
+    /* Restore the exact resolution when the input was downsampled from the preferred one. */
+    if (preferredResolution[i] <= upsampled &&
+        upsampled < preferredResolution[i] + this->m_divider) {
+      resolution[i] = preferredResolution[i];
+    }
+    else {
+      resolution[i] = upsampled;
+    }
+  }
+}
+
+bool UpsampleOperation::determineDependingAreaOfInterest(rcti *input,
+                                                         ReadBufferOperation *readOperation,
+                                                         rcti *output)
+{
+  NodeOperation *inputOperation = this->getInputOperation(0);
+  const float scaleX = (float)inputOperation->getWidth() / MAX2(this->getWidth(), 1u);
+  const float scaleY = (float)inputOperation->getHeight() / MAX2(this->getHeight(), 1u);
+  rcti newInput;
+  mapArea(input, scaleX, scaleY, &newInput);
+  return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
+}
@@ -0,0 +1,75 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include "COM_NodeOperation.h"
+
+/**
+ * \brief Base class of the operations that change the resolution of an image by a whole divider.
+ * Used to evaluate the tree at a reduced resolution, see CompositorContext.getResolutionDivider.
+ */
+class ResampleOperation : public NodeOperation {
+ protected:
+  SocketReader *m_inputOperation;
+  int m_divider;
+
+  /* Ratio between input and output coordinates, set at initExecution. */
+  float m_scaleX;
+  float m_scaleY;
+
+  ResampleOperation(DataType datatype, int divider);
+
+  void mapArea(const rcti *input, float scaleX, float scaleY, rcti *r_output) const;
+
+ public:
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+  void initExecution();
+  void deinitExecution();
+};
+
+/**
+ * \brief Reduce the resolution of an input image, inserted after the input operations.
+ * Every output pixel is the average of the divider x divider input pixels it covers.
+ */
+class DownsampleOperation : public ResampleOperation {
+ public:
+  DownsampleOperation(DataType datatype, int divider);
+
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+  void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
+  bool determineDependingAreaOfInterest(rcti *input,
+                                        ReadBufferOperation *readOperation,
+                                        rcti *output);
+};
+
+/**
+ * \brief Restore the resolution of a reduced image, inserted before the output operations.
+ * \note complex, so the operations before it are calculated once at the reduced resolution.
+ */
+class UpsampleOperation : public ResampleOperation {
+ public:
+  UpsampleOperation(DataType datatype, int divider);
+
+  void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
+  bool determineDependingAreaOfInterest(rcti *input,
+                                        ReadBufferOperation *readOperation,
+                                        rcti *output);
+};
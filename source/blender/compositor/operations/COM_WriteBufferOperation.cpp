@@ -41,18 +41,20 @@ void WriteBufferOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  this->m_input->readSampled(output, x, y, sampler);
+  this->m_inputReader->readSampled(output, x, y, sampler);
 }
 
 void WriteBufferOperation::initExecution()
 {
   this->m_input = this->getInputOperation(0);
+  this->m_inputReader = this->getInputSocketReader(0);
   this->m_memoryProxy->allocate(this->m_width, this->m_height);
 }
 
 void WriteBufferOperation::deinitExecution()
 {
   this->m_input = nullptr;
+  this->m_inputReader = nullptr;
   this->m_memoryProxy->free();
 }
 
@@ -62,7 +64,7 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
   float *buffer = memoryBuffer->getBuffer();
   const int num_channels = memoryBuffer->get_num_channels();
   if (this->m_input->isComplex()) {
-    void *data = this->m_input->initializeTileData(rect);
+    void *data = this->m_inputReader->initializeTileData(rect);
     int x1 = rect->xmin;
     int y1 = rect->ymin;
     int x2 = rect->xmax;
@@ -73,7 +75,7 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
     for (y = y1; y < y2 && (!breaked); y++) {
       int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
       for (x = x1; x < x2; x++) {
-        this->m_input->read(&(buffer[offset4]), x, y, data);
+        this->m_inputReader->read(&(buffer[offset4]), x, y, data);
         offset4 += num_channels;
       }
       if (isBraked()) {
@@ -81,7 +83,7 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
       }
     }
     if (data) {
-      this->m_input->deinitializeTileData(rect, data);
+      this->m_inputReader->deinitializeTileData(rect, data);
       data = nullptr;
     }
   }
@@ -97,7 +99,7 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
     for (y = y1; y < y2 && (!breaked); y++) {
       int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
       for (x = x1; x < x2; x++) {
-        this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
+        this->m_inputReader->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
         offset4 += num_channels;
       }
       if (isBraked()) {
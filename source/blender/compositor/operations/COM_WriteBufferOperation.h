@@ -29,6 +29,8 @@ class WriteBufferOperation : public NodeOperation {
   MemoryProxy *m_memoryProxy;
   bool m_single_value; /* single value stored in buffer */
   NodeOperation *m_input;
+  /* Reader of the input, differs from m_input while profiling. */
+  SocketReader *m_inputReader;
 
  public:
   WriteBufferOperation(DataType datatype);
@@ -0,0 +1,95 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_rect.h"
+
+#include "COM_DenoiseOperation.h"
+
+/* Provides a full frame buffer to the operation, like the read buffer operations in front of
+ * complex operations. */
+class BufferInputOperation : public NodeOperation {
+ private:
+  MemoryBuffer *m_buffer;
+
+ public:
+  BufferInputOperation(DataType datatype, MemoryBuffer *buffer) : m_buffer(buffer)
+  {
+    this->addOutputSocket(datatype);
+  }
+
+  void *initializeTileData(rcti * /*rect*/) override
+  {
+    return this->m_buffer;
+  }
+};
+
+static MemoryBuffer *gradient_buffer(const int width, const int height)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, width, 0, height);
+  MemoryBuffer *buffer = new MemoryBuffer(COM_DT_COLOR, &rect);
+  float *data = buffer->getBuffer();
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      float *color = &data[(y * width + x) * COM_NUM_CHANNELS_COLOR];
+      color[0] = (float)x / width;
+      color[1] = (float)y / height;
+      color[2] = 0.5f;
+      color[3] = 1.0f;
+    }
+  }
+  return buffer;
+}
+
+/* Denoised tiles are freed once all chunks inside of them were written, so only a row of tiles
+ * is kept in memory when chunks are executed row by row. */
+TEST(denoise, FreeTilesWhileExecuting)
+{
+  const int width = 2100;
+  const int height = 2100;
+  const int chunk_size = 256;
+  const int number_of_x_tiles = 3;
+
+  MemoryBuffer *buffer = gradient_buffer(width, height);
+  BufferInputOperation color(COM_DT_COLOR, buffer);
+  BufferInputOperation normal(COM_DT_VECTOR, buffer);
+  BufferInputOperation albedo(COM_DT_COLOR, buffer);
+
+  NodeDenoise settings = {0};
+  DenoiseOperation denoise;
+  denoise.setDenoiseSettings(&settings);
+  denoise.getInputSocket(0)->setLink(color.getOutputSocket());
+  denoise.getInputSocket(1)->setLink(normal.getOutputSocket());
+  denoise.getInputSocket(2)->setLink(albedo.getOutputSocket());
+  unsigned int resolution[2] = {width, height};
+  denoise.setResolution(resolution);
+  denoise.initExecution();
+
+  int max_tiles = 0;
+  for (int ymin = 0; ymin < height; ymin += chunk_size) {
+    for (int xmin = 0; xmin < width; xmin += chunk_size) {
+      rcti rect;
+      BLI_rcti_init(
+          &rect, xmin, min_ii(xmin + chunk_size, width), ymin, min_ii(ymin + chunk_size, height));
+
+      /* Same calls as #WriteBufferOperation::executeRegion. */
+      void *data = denoise.initializeTileData(&rect);
+      ASSERT_NE(data, nullptr);
+      max_tiles = max_ii(max_tiles, denoise.getNumberOfDenoisedTiles());
+
+      /* Alpha is copied from the input, color depends on the denoiser. */
+      float output[4];
+      denoise.executePixel(output, rect.xmin, rect.ymin, data);
+      EXPECT_EQ(output[3], 1.0f);
+
+      denoise.deinitializeTileData(&rect, data);
+    }
+  }
+
+  EXPECT_EQ(max_tiles, number_of_x_tiles);
+  EXPECT_EQ(denoise.getNumberOfDenoisedTiles(), 0);
+
+  denoise.deinitExecution();
+  delete buffer;
+}
@@ -0,0 +1,65 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.h"
+#include "BLI_rect.h"
+
+#include "COM_FastGaussianBlurOperation.h"
+
+static MemoryBuffer *noise_buffer(const int width, const int height)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, width, 0, height);
+  MemoryBuffer *buffer = new MemoryBuffer(COM_DT_COLOR, &rect);
+  RNG *rng = BLI_rng_new(1234);
+  float *data = buffer->getBuffer();
+  for (int i = 0; i < width * height * COM_NUM_CHANNELS_COLOR; i++) {
+    data[i] = BLI_rng_get_float(rng);
+  }
+  BLI_rng_free(rng);
+  return buffer;
+}
+
+/* Blurring only a region of interest gives the same pixels inside it as blurring the full frame. */
+static void test_region_of_interest(const float sigma_x, const float sigma_y)
+{
+  const int width = 120;
+  const int height = 90;
+  rcti region;
+  BLI_rcti_init(&region, 40, 70, 30, 50);
+
+  MemoryBuffer *full = noise_buffer(width, height);
+  MemoryBuffer *partial = noise_buffer(width, height);
+  FastGaussianBlurOperation::gauss_blur(full, sigma_x, sigma_y);
+  FastGaussianBlurOperation::gauss_blur(partial, sigma_x, sigma_y, &region);
+
+  for (int y = region.ymin; y < region.ymax; y++) {
+    for (int x = region.xmin; x < region.xmax; x++) {
+      float full_color[4], partial_color[4];
+      full->read(full_color, x, y);
+      partial->read(partial_color, x, y);
+      EXPECT_V4_NEAR(full_color, partial_color, 1e-6f);
+    }
+  }
+
+  delete full;
+  delete partial;
+}
+
+TEST(fast_gaussian_blur, RegionOfInterest)
+{
+  test_region_of_interest(5.0f, 5.0f);
+}
+
+TEST(fast_gaussian_blur, RegionOfInterestSeparate)
+{
+  test_region_of_interest(8.0f, 3.0f);
+  test_region_of_interest(3.0f, 8.0f);
+}
+
+TEST(fast_gaussian_blur, RegionOfInterestSingleDirection)
+{
+  test_region_of_interest(6.0f, 0.0f);
+  test_region_of_interest(0.0f, 6.0f);
+}
@@ -157,7 +157,7 @@ static bool drw_draw_show_annotation(void)
 static void drw_task_graph_init(void)
 {
   BLI_assert(DST.task_graph == NULL);
-  DST.task_graph = BLI_task_graph_create();
+  DST.task_graph = BLI_task_graph_create(TASK_PRIORITY_HIGH);
   DST.delayed_extraction = BLI_gset_ptr_new(__func__);
 }
 
@@ -2751,7 +2751,7 @@ void DRW_draw_depth_object(
       else {
         batch = DRW_mesh_batch_cache_get_surface(me);
       }
-      struct TaskGraph *task_graph = BLI_task_graph_create();
+      struct TaskGraph *task_graph = BLI_task_graph_create(TASK_PRIORITY_HIGH);
       DRW_mesh_batch_cache_create_requested(task_graph, object, me, scene, false, true);
       BLI_task_graph_work_and_wait(task_graph);
       BLI_task_graph_free(task_graph);
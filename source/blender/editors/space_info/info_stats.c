@@ -618,6 +618,22 @@ static const char *info_statusbar_string(Main *bmain,
     uintptr_t mem_in_use = MEM_get_memory_in_use();
     BLI_str_format_byte_unit(formatted_mem, mem_in_use, false);
     ofs += BLI_snprintf(info + ofs, len, TIP_("Memory: %s"), formatted_mem);
+
+    /* Subsystem using most memory, when tracked by the allocator. */
+    eMEM_Tag tag_max = MEM_TAG_NONE;
+    size_t tag_max_mem_in_use = 0;
+    for (int tag = MEM_TAG_NONE + 1; tag < MEM_TAG_LEN; tag++) {
+      const size_t tag_mem_in_use = MEM_tag_get_memory_in_use(tag);
+      if (tag_mem_in_use > tag_max_mem_in_use) {
+        tag_max = tag;
+        tag_max_mem_in_use = tag_mem_in_use;
+      }
+    }
+    if (tag_max != MEM_TAG_NONE) {
+      BLI_str_format_byte_unit(formatted_mem, tag_max_mem_in_use, false);
+      ofs += BLI_snprintf(
+          info + ofs, len - ofs, TIP_(" (%s: %s)"), MEM_tag_name(tag_max), formatted_mem);
+    }
   }
 
   /* GPU VRAM status. */
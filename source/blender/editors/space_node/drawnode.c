@@ -1886,6 +1886,10 @@ static void node_composit_buts_file_output_ex(uiLayout *layout, bContext *C, Poi
   node_composit_buts_file_output(layout, C, ptr);
   uiTemplateImageSettings(layout, &imfptr, false);
 
+  if (multilayer) {
+    uiItemR(layout, ptr, "use_tiled", DEFAULT_FLAGS, NULL, ICON_NONE);
+  }
+
   /* disable stereo output for multilayer, too much work for something that no one will use */
   /* if someone asks for that we can implement it */
   if (is_multiview) {
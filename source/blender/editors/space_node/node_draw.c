@@ -1117,6 +1117,58 @@ void node_draw_sockets(const View2D *v2d,
   GPU_blend(GPU_BLEND_NONE);
 }
 
+#ifdef WITH_COMPOSITOR
+/* Tint the node body by its share of the compositing time and show its execution statistics
+ * above the node, when profiling of the compositor is enabled. */
+static void node_draw_profile_statistics(const bContext *C,
+                                         const SpaceNode *snode,
+                                         bNode *node,
+                                         bNodeInstanceKey key,
+                                         float color[4])
+{
+  const bNodeTree *ntree = snode->nodetree;
+  if (ntree == NULL || ntree->type != NTREE_COMPOSIT || !(ntree->flag & NTREE_COM_PROFILE)) {
+    return;
+  }
+
+  Scene *scene = CTX_data_scene(C);
+  CompositorNodeStatistics statistics;
+  if (!COM_profiler_node_statistics(scene, key, &statistics)) {
+    return;
+  }
+
+  const double total_time = COM_profiler_total_time(scene);
+  const float heat = (total_time > 0.0) ? (float)(statistics.time / total_time) : 0.0f;
+  float heat_color[4];
+  UI_GetThemeColor4fv(TH_REDALERT, heat_color);
+  interp_v3_v3v3(color, color, heat_color, clamp_f(heat, 0.0f, 1.0f));
+
+  char label[128];
+  BLI_snprintf(label,
+               sizeof(label),
+               "%.1f ms | %d chunks | %.1f MiB",
+               statistics.time * 1000.0,
+               statistics.chunks,
+               statistics.memory / (1024.0 * 1024.0));
+
+  const rctf *rct = &node->totr;
+  uiDefBut(node->block,
+           UI_BTYPE_LABEL,
+           0,
+           label,
+           (int)rct->xmin,
+           (int)rct->ymax,
+           (short)BLI_rctf_size_x(rct),
+           (short)NODE_DY,
+           NULL,
+           0,
+           0,
+           0,
+           0,
+           "");
+}
+#endif
+
 static void node_draw_basis(const bContext *C,
                             const View2D *v2d,
                             const SpaceNode *snode,
@@ -1311,6 +1363,11 @@ static void node_draw_basis(const bContext *C,
   if (node->flag & NODE_MUTED) {
     color[3] = 0.5f;
   }
+#ifdef WITH_COMPOSITOR
+  else {
+    node_draw_profile_statistics(C, snode, node, key, color);
+  }
+#endif
 
   UI_draw_roundbox_corner_set(UI_CNR_BOTTOM_LEFT | UI_CNR_BOTTOM_RIGHT);
   UI_draw_roundbox_aa(
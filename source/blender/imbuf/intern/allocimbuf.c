@@ -380,7 +380,10 @@ void *imb_alloc_pixels(
   }
 
   size_t size = (size_t)x * (size_t)y * (size_t)channels * typesize;
-  return MEM_callocN(size, name);
+  const eMEM_Tag tag_prev = MEM_tag_set(MEM_TAG_IMAGE);
+  void *pixels = MEM_callocN(size, name);
+  MEM_tag_set(tag_prev);
+  return pixels;
 }
 
 bool imb_addrectfloatImBuf(ImBuf *ibuf)
@@ -44,6 +44,7 @@
 #include <ImfPixelType.h>
 #include <ImfStandardAttributes.h>
 #include <ImfStringAttribute.h>
+#include <ImfTiledOutputFile.h>
 #include <ImfVersion.h>
 #include <half.h>
 
@@ -635,6 +636,9 @@ struct ExrHandle {
   OFileStream *ofile_stream;
   MultiPartOutputFile *mpofile;
   OutputFile *ofile;
+  TiledOutputFile *tofile;
+  /** Serializes writing tiles of #tofile from multiple threads. */
+  ThreadMutex write_lock;
 
   int tilex, tiley;
   int width, height;
@@ -842,21 +846,13 @@ void IMB_exr_add_channel(void *handle,
   BLI_addtail(&data->channels, echan);
 }
 
-/* used for output files (from RenderResult) (single and multilayer, single and multiview) */
-int IMB_exr_begin_write(void *handle,
-                        const char *filename,
-                        int width,
-                        int height,
-                        int compress,
-                        const StampData *stamp)
+/* Fill in channels and metadata of an image file header, shared by scanline and tiled writing. */
+static void imb_exr_header_from_channels(ExrHandle *data,
+                                         Header &header,
+                                         int compress,
+                                         const StampData *stamp)
 {
-  ExrHandle *data = (ExrHandle *)handle;
-  Header header(width, height);
   ExrChannel *echan;
-
-  data->width = width;
-  data->height = height;
-
   bool is_singlelayer, is_multilayer, is_multiview;
 
   for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
@@ -866,7 +862,6 @@ int IMB_exr_begin_write(void *handle,
   openexr_header_compression(&header, compress);
   BKE_stamp_info_callback(
       &header, const_cast<StampData *>(stamp), openexr_header_metadata_callback, false);
-  /* header.lineOrder() = DECREASING_Y; this crashes in windows for file read! */
 
   imb_exr_type_by_channels(
       header.channels(), *data->multiView, &is_singlelayer, &is_multilayer, &is_multiview);
@@ -878,6 +873,24 @@ int IMB_exr_begin_write(void *handle,
   if (is_multiview) {
     addMultiView(header, *data->multiView);
   }
+}
+
+/* used for output files (from RenderResult) (single and multilayer, single and multiview) */
+int IMB_exr_begin_write(void *handle,
+                        const char *filename,
+                        int width,
+                        int height,
+                        int compress,
+                        const StampData *stamp)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  Header header(width, height);
+
+  data->width = width;
+  data->height = height;
+
+  /* header.lineOrder() = DECREASING_Y; this crashes in windows for file read! */
+  imb_exr_header_from_channels(data, header, compress, stamp);
 
   /* avoid crash/abort when we don't have permission to write here */
   /* manually create ofstream, so we can handle utf-8 filepaths on windows */
@@ -898,6 +911,50 @@ int IMB_exr_begin_write(void *handle,
   return (data->ofile != nullptr);
 }
 
+/* Used for output files which are written progressively, tile by tile in any order
+ * (single and multilayer, single view). The file is the same as written by
+ * #IMB_exr_begin_write, except that pixels are stored in tiles of `tile_size` pixels.
+ * Channel buffers are passed for every block of tiles with #IMB_exr_write_tiles. */
+int IMB_exr_begin_write_tiled(void *handle,
+                              const char *filename,
+                              int width,
+                              int height,
+                              int tile_size,
+                              int compress,
+                              const StampData *stamp)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  Header header(width, height);
+
+  data->width = width;
+  data->height = height;
+  data->tilex = tile_size;
+  data->tiley = tile_size;
+
+  imb_exr_header_from_channels(data, header, compress, stamp);
+  header.setTileDescription(TileDescription(tile_size, tile_size, ONE_LEVEL));
+  /* Tiles are written as soon as they are finished. */
+  header.lineOrder() = RANDOM_Y;
+
+  try {
+    data->ofile_stream = new OFileStream(filename);
+    data->tofile = new TiledOutputFile(*(data->ofile_stream), header);
+  }
+  catch (const std::exception &exc) {
+    std::cerr << "IMB_exr_begin_write_tiled: ERROR: " << exc.what() << std::endl;
+
+    delete data->tofile;
+    delete data->ofile_stream;
+
+    data->tofile = nullptr;
+    data->ofile_stream = nullptr;
+    return 0;
+  }
+
+  BLI_mutex_init(&data->write_lock);
+  return 1;
+}
+
 /* only used for writing temp. render results (not image files)
  * (FSA and Save Buffers) */
 void IMB_exrtile_begin_write(
@@ -1209,6 +1266,112 @@ void IMB_exrtile_write_channels(
   }
 }
 
+/* Write a block of tiles of a file opened with #IMB_exr_begin_write_tiled.
+ * `tile_rects` holds for every tile of the block (row by row) one pointer per channel, in the
+ * order the channels were added. Pixels are relative to the tile origin, using the strides the
+ * channels were added with, and the first row is the top row of the tile (file order, not
+ * bottom-up like ImBuf).
+ * Can be called from multiple threads: pixels are converted without a lock, only the file
+ * access is serialized. OpenEXR compresses the tiles of a block in parallel. */
+void IMB_exr_write_tiles(void *handle,
+                         int tile_x,
+                         int tile_y,
+                         int tiles_x,
+                         int tiles_y,
+                         float *const *const *tile_rects)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  FrameBuffer frameBuffer;
+  ExrChannel *echan;
+  int i;
+
+  if (data->tofile == nullptr) {
+    return;
+  }
+
+  /* Pixel area of the block, clipped to the image. */
+  const int xmin = tile_x * data->tilex;
+  const int ymin = tile_y * data->tiley;
+  const int xmax = std::min((tile_x + tiles_x) * data->tilex, data->width);
+  const int ymax = std::min((tile_y + tiles_y) * data->tiley, data->height);
+  const int block_width = xmax - xmin;
+  const size_t num_pixels = ((size_t)block_width) * (ymax - ymin);
+  const int num_float_channels = BLI_listbase_count(&data->channels) - data->num_half_channels;
+
+  half *rect_half = nullptr, *current_rect_half = nullptr;
+  float *rect_float = nullptr, *current_rect_float = nullptr;
+  if (data->num_half_channels != 0) {
+    rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * num_pixels,
+                                    __func__);
+    current_rect_half = rect_half;
+  }
+  if (num_float_channels != 0) {
+    rect_float = (float *)MEM_mallocN(sizeof(float) * num_float_channels * num_pixels, __func__);
+    current_rect_float = rect_float;
+  }
+
+  /* Gather the tiles into one buffer per channel, with the data window as coordinates. */
+  for (echan = (ExrChannel *)data->channels.first, i = 0; echan; echan = echan->next, i++) {
+    half *dst_half = echan->use_half_float ? current_rect_half : nullptr;
+    float *dst_float = echan->use_half_float ? nullptr : current_rect_float;
+
+    for (int tile = 0; tile < tiles_x * tiles_y; tile++) {
+      const float *rect = tile_rects[tile][i];
+      const int tile_xmin = (tile % tiles_x) * data->tilex;
+      const int tile_ymin = (tile / tiles_x) * data->tiley;
+      const int tile_width = std::min(data->tilex, xmax - xmin - tile_xmin);
+      const int tile_height = std::min(data->tiley, ymax - ymin - tile_ymin);
+      for (int y = 0; y < tile_height; y++) {
+        const float *src = rect + y * echan->ystride;
+        const size_t offset = ((size_t)(tile_ymin + y)) * block_width + tile_xmin;
+        for (int x = 0; x < tile_width; x++, src += echan->xstride) {
+          if (dst_half) {
+            dst_half[offset + x] = float_to_half_safe(*src);
+          }
+          else {
+            dst_float[offset + x] = *src;
+          }
+        }
+      }
+    }
+
+    const ptrdiff_t origin = ((ptrdiff_t)ymin) * block_width + xmin;
+    if (dst_half) {
+      frameBuffer.insert(echan->name,
+                         Slice(Imf::HALF,
+                               (char *)(dst_half - origin),
+                               sizeof(half),
+                               block_width * sizeof(half)));
+      current_rect_half += num_pixels;
+    }
+    else {
+      frameBuffer.insert(echan->name,
+                         Slice(Imf::FLOAT,
+                               (char *)(dst_float - origin),
+                               sizeof(float),
+                               block_width * sizeof(float)));
+      current_rect_float += num_pixels;
+    }
+  }
+
+  BLI_mutex_lock(&data->write_lock);
+  data->tofile->setFrameBuffer(frameBuffer);
+  try {
+    data->tofile->writeTiles(tile_x, tile_x + tiles_x - 1, tile_y, tile_y + tiles_y - 1);
+  }
+  catch (const std::exception &exc) {
+    std::cerr << "OpenEXR-writeTiles: ERROR: " << exc.what() << std::endl;
+  }
+  BLI_mutex_unlock(&data->write_lock);
+
+  if (rect_half != nullptr) {
+    MEM_freeN(rect_half);
+  }
+  if (rect_float != nullptr) {
+    MEM_freeN(rect_float);
+  }
+}
+
 void IMB_exr_read_channels(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
@@ -1347,6 +1510,10 @@ void IMB_exr_close(void *handle)
   delete data->ifile;
   delete data->ifile_stream;
   delete data->ofile;
+  if (data->tofile) {
+    delete data->tofile;
+    BLI_mutex_end(&data->write_lock);
+  }
   delete data->mpofile;
   delete data->ofile_stream;
   delete data->multiView;
@@ -1354,6 +1521,7 @@ void IMB_exr_close(void *handle)
   data->ifile = nullptr;
   data->ifile_stream = nullptr;
   data->ofile = nullptr;
+  data->tofile = nullptr;
   data->mpofile = nullptr;
   data->ofile_stream = nullptr;
 
@@ -57,6 +57,13 @@ int IMB_exr_begin_write(void *handle,
                         int height,
                         int compress,
                         const struct StampData *stamp);
+int IMB_exr_begin_write_tiled(void *handle,
+                              const char *filename,
+                              int width,
+                              int height,
+                              int tile_size,
+                              int compress,
+                              const struct StampData *stamp);
 void IMB_exrtile_begin_write(
     void *handle, const char *filename, int mipmap, int width, int height, int tilex, int tiley);
 
@@ -73,6 +80,12 @@ float *IMB_exr_channel_rect(void *handle,
 
 void IMB_exr_read_channels(void *handle);
 void IMB_exr_write_channels(void *handle);
+void IMB_exr_write_tiles(void *handle,
+                         int tile_x,
+                         int tile_y,
+                         int tiles_x,
+                         int tiles_y,
+                         float *const *const *tile_rects);
 void IMB_exrtile_write_channels(
     void *handle, int partx, int party, int level, const char *viewname, bool empty);
 void IMB_exr_clear_channels(void *handle);
@@ -59,6 +59,16 @@ int IMB_exr_begin_write(void * /*handle*/,
 {
   return 0;
 }
+int IMB_exr_begin_write_tiled(void * /*handle*/,
+                              const char * /*filename*/,
+                              int /*width*/,
+                              int /*height*/,
+                              int /*tile_size*/,
+                              int /*compress*/,
+                              const struct StampData * /*stamp*/)
+{
+  return 0;
+}
 void IMB_exrtile_begin_write(void * /*handle*/,
                              const char * /*filename*/,
                              int /*mipmap*/,
@@ -91,6 +101,14 @@ void IMB_exr_read_channels(void * /*handle*/)
 void IMB_exr_write_channels(void * /*handle*/)
 {
 }
+void IMB_exr_write_tiles(void * /*handle*/,
+                         int /*tile_x*/,
+                         int /*tile_y*/,
+                         int /*tiles_x*/,
+                         int /*tiles_y*/,
+                         float *const *const * /*tile_rects*/)
+{
+}
 void IMB_exrtile_write_channels(void * /*handle*/,
                                 int /*partx*/,
                                 int /*party*/,
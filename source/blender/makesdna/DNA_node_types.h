@@ -447,7 +447,9 @@ typedef struct bNodeTree {
   short is_updating;
   /** Generic temporary flag for recursion check (DFS/BFS). */
   short done;
-  char _pad2[4];
+  /** Resolution divider of the first evaluation while editing, 0 or 1 to disable. */
+  short progressive_divider;
+  char _pad2[2];
 
   /** Specific node type this tree is used for. */
   int nodetype DNA_DEPRECATED;
@@ -517,6 +519,7 @@ typedef struct bNodeTree {
 
 /* tree is localized copy, free when deleting node groups */
 /* #define NTREE_IS_LOCALIZED           (1 << 5) */
+#define NTREE_COM_PROFILE (1 << 6)          /* record execution statistics of nodes */
 
 /* ntree->update */
 typedef enum eNodeTreeUpdate {
@@ -616,6 +619,12 @@ enum {
   CMP_NODEFLAG_BLUR_EXTEND_BOUNDS = (1 << 1),
 };
 
+/* NodeImageMultiFile.flag */
+enum {
+  /* Write multilayer OpenEXR files as tiles while compositing. */
+  CMP_NODEFLAG_OUTPUT_FILE_TILED = (1 << 0),
+};
+
 typedef struct NodeFrame {
   short flag;
   short label_size;
@@ -728,7 +737,9 @@ typedef struct NodeImageMultiFile {
   int sfra DNA_DEPRECATED, efra DNA_DEPRECATED;
   /** Selected input in details view list. */
   int active_input;
-  char _pad[4];
+  /** #CMP_NODEFLAG_OUTPUT_FILE_TILED. */
+  char flag;
+  char _pad[3];
 } NodeImageMultiFile;
 typedef struct NodeImageMultiFileSocket {
   /* single layer file output */
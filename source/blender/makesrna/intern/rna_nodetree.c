@@ -120,6 +120,13 @@ static const EnumPropertyItem node_chunksize_items[] = {
     {NTREE_CHUNKSIZE_1024, "1024", 0, "1024x1024", "Chunksize of 1024x1024"},
     {0, NULL, 0, NULL, NULL},
 };
+
+static const EnumPropertyItem node_progressive_divider_items[] = {
+    {0, "NONE", 0, "None", "Calculate the full resolution only"},
+    {2, "HALF", 0, "Half", "First show the result at half resolution"},
+    {4, "QUARTER", 0, "Quarter", "First show the result at quarter resolution"},
+    {0, NULL, 0, NULL, NULL},
+};
 #endif
 
 const EnumPropertyItem rna_enum_mapping_type_items[] = {
@@ -541,6 +548,10 @@ static const EnumPropertyItem rna_node_geometry_object_info_transform_space_item
 #  include "RE_engine.h"
 #  include "RE_pipeline.h"
 
+#  ifdef WITH_COMPOSITOR
+#    include "COM_compositor.h"
+#  endif
+
 #  include "DNA_scene_types.h"
 #  include "WM_api.h"
 
@@ -3292,6 +3303,68 @@ static void rna_CompositorNode_tag_need_exec(bNode *node)
   node->need_exec = true;
 }
 
+#  ifdef WITH_COMPOSITOR
+/* Sum the statistics of all instances of the node. Nodes inside a group have an instance for
+ * every group node using the group, with a key that depends on the path to it. */
+static void rna_CompositorNode_profile_statistics_add(const Scene *scene,
+                                                      bNodeTree *ntree,
+                                                      bNodeInstanceKey parent_key,
+                                                      const bNodeTree *node_tree,
+                                                      const bNode *node,
+                                                      CompositorNodeStatistics *r_statistics)
+{
+  LISTBASE_FOREACH (bNode *, iter, &ntree->nodes) {
+    const bNodeInstanceKey key = BKE_node_instance_key(parent_key, ntree, iter);
+    if (iter == node && ntree == node_tree) {
+      CompositorNodeStatistics statistics;
+      if (COM_profiler_node_statistics(scene, key, &statistics)) {
+        r_statistics->time += statistics.time;
+        r_statistics->chunks += statistics.chunks;
+        r_statistics->memory += statistics.memory;
+        r_statistics->chunk_pixels += statistics.chunk_pixels;
+        r_statistics->area_of_interest_pixels += statistics.area_of_interest_pixels;
+      }
+    }
+    else if (iter->type == NODE_GROUP && iter->id != NULL) {
+      rna_CompositorNode_profile_statistics_add(
+          scene, (bNodeTree *)iter->id, key, node_tree, node, r_statistics);
+    }
+  }
+}
+#  endif
+
+static void rna_CompositorNode_profile_statistics(ID *id,
+                                                  bNode *node,
+                                                  Scene *scene,
+                                                  float *r_time,
+                                                  int *r_chunks,
+                                                  float *r_memory,
+                                                  float *r_area_of_interest_overhead)
+{
+  *r_time = 0.0f;
+  *r_chunks = 0;
+  *r_memory = 0.0f;
+  *r_area_of_interest_overhead = 0.0f;
+
+#  ifdef WITH_COMPOSITOR
+  if (scene == NULL || scene->nodetree == NULL) {
+    return;
+  }
+  CompositorNodeStatistics statistics = {0};
+  rna_CompositorNode_profile_statistics_add(
+      scene, scene->nodetree, NODE_INSTANCE_KEY_BASE, (bNodeTree *)id, node, &statistics);
+  *r_time = (float)statistics.time;
+  *r_chunks = statistics.chunks;
+  *r_memory = (float)(statistics.memory / (1024.0 * 1024.0));
+  if (statistics.chunk_pixels > 0) {
+    *r_area_of_interest_overhead = (float)((double)statistics.area_of_interest_pixels /
+                                           (double)statistics.chunk_pixels);
+  }
+#  else
+  UNUSED_VARS(id, node, scene);
+#  endif
+}
+
 static void rna_Node_tex_image_update(Main *bmain, Scene *UNUSED(scene), PointerRNA *ptr)
 {
   bNodeTree *ntree = (bNodeTree *)ptr->owner_id;
@@ -6380,6 +6453,14 @@ static void def_cmp_output_file(BlenderRNA *brna, StructRNA *srna)
   RNA_def_property_ui_text(prop, "Base Path", "Base output path for the image");
   RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
 
+  prop = RNA_def_property(srna, "use_tiled", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", CMP_NODEFLAG_OUTPUT_FILE_TILED);
+  RNA_def_property_ui_text(prop,
+                           "Tiled",
+                           "Write multilayer OpenEXR files as tiles while compositing, which uses "
+                           "less memory. Some applications read scanline files faster");
+  RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
+
   prop = RNA_def_property(srna, "active_input_index", PROP_INT, PROP_NONE);
   RNA_def_property_int_sdna(prop, NULL, "active_input");
   RNA_def_property_ui_text(prop, "Active Input Index", "Active input index in details view list");
@@ -8925,6 +9006,7 @@ static void rna_def_compositor_node(BlenderRNA *brna)
 {
   StructRNA *srna;
   FunctionRNA *func;
+  PropertyRNA *parm;
 
   srna = RNA_def_struct(brna, "CompositorNode", "NodeInternal");
   RNA_def_struct_ui_text(srna, "Compositor Node", "");
@@ -8935,6 +9017,41 @@ static void rna_def_compositor_node(BlenderRNA *brna)
   func = RNA_def_function(srna, "tag_need_exec", "rna_CompositorNode_tag_need_exec");
   RNA_def_function_ui_description(func, "Tag the node for compositor update");
 
+  func = RNA_def_function(srna, "profile_statistics", "rna_CompositorNode_profile_statistics");
+  RNA_def_function_ui_description(
+      func,
+      "Execution statistics of the node from the last profiled compositing of the scene, summed "
+      "over all uses of its node group");
+  RNA_def_function_flag(func, FUNC_USE_SELF_ID);
+  parm = RNA_def_pointer(func, "scene", "Scene", "", "Scene that was composited");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+  parm = RNA_def_float(
+      func, "time", 0.0f, 0.0f, FLT_MAX, "Time", "CPU time in seconds", 0.0f, FLT_MAX);
+  RNA_def_function_output(func, parm);
+  parm = RNA_def_int(
+      func, "chunks", 0, 0, INT_MAX, "Chunks", "Number of executed chunks", 0, INT_MAX);
+  RNA_def_function_output(func, parm);
+  parm = RNA_def_float(func,
+                       "memory",
+                       0.0f,
+                       0.0f,
+                       FLT_MAX,
+                       "Memory",
+                       "Memory allocated for buffers in MiB",
+                       0.0f,
+                       FLT_MAX);
+  RNA_def_function_output(func, parm);
+  parm = RNA_def_float(func,
+                       "area_of_interest_overhead",
+                       0.0f,
+                       0.0f,
+                       FLT_MAX,
+                       "Area of Interest Overhead",
+                       "Ratio of input pixels read to output pixels written",
+                       0.0f,
+                       FLT_MAX);
+  RNA_def_function_output(func, parm);
+
   def_cmp_cryptomatte_entry(brna);
 }
 
@@ -10631,6 +10748,25 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
   RNA_def_property_ui_text(
       prop, "Viewer Region", "Use boundaries for viewer nodes and composite backdrop");
   RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_NodeTree_update");
+
+  prop = RNA_def_property(srna, "progressive_resolution", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_sdna(prop, NULL, "progressive_divider");
+  RNA_def_property_enum_items(prop, node_progressive_divider_items);
+  RNA_def_property_ui_text(prop,
+                           "Progressive Resolution",
+                           "During editing first calculate the result at a reduced resolution, "
+                           "then refine it at full resolution. Not used when the tree contains "
+                           "Crop nodes with sizes in pixels, Bokeh Blur, Defocus, Glare, "
+                           "Bilateral Blur or Directional Blur nodes");
+  RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_NodeTree_update");
+
+  prop = RNA_def_property(srna, "use_profiling", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_PROFILE);
+  RNA_def_property_ui_text(
+      prop,
+      "Profiling",
+      "Record execution time and memory usage of the nodes and show them in the node editor");
+  RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_NodeTree_update");
 }
 
 static void rna_def_shader_nodetree(BlenderRNA *brna)
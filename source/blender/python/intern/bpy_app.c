@@ -45,6 +45,8 @@
 #include "bpy_app_icons.h"
 #include "bpy_app_timers.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "BLI_utildefines.h"
 
 #include "BKE_appdir.h"
@@ -361,6 +363,25 @@ static PyObject *bpy_app_autoexec_fail_message_get(PyObject *UNUSED(self), void
   return PyC_UnicodeFromByte(G.autoexec_fail);
 }
 
+PyDoc_STRVAR(bpy_app_memory_statistics_doc,
+             "Memory in use and peak memory in bytes, as a dictionary of tuples by subsystem "
+             "(read-only)");
+static PyObject *bpy_app_memory_statistics_get(PyObject *UNUSED(self), void *UNUSED(closure))
+{
+  PyObject *dict = PyDict_New();
+
+  for (int tag = 0; tag < MEM_TAG_LEN; tag++) {
+    PyObject *item = PyTuple_New(2);
+    PyTuple_SET_ITEMS(item,
+                      PyLong_FromSize_t(MEM_tag_get_memory_in_use(tag)),
+                      PyLong_FromSize_t(MEM_tag_get_peak_memory(tag)));
+    PyDict_SetItemString(dict, MEM_tag_name(tag), item);
+    Py_DECREF(item);
+  }
+
+  return dict;
+}
+
 static PyGetSetDef bpy_app_getsets[] = {
     {"debug", bpy_app_debug_get, bpy_app_debug_set, bpy_app_debug_doc, (void *)G_DEBUG},
     {"debug_ffmpeg",
@@ -455,6 +476,11 @@ static PyGetSetDef bpy_app_getsets[] = {
      bpy_app_debug_value_doc,
      NULL},
     {"tempdir", bpy_app_tempdir_get, NULL, bpy_app_tempdir_doc, NULL},
+    {"memory_statistics",
+     bpy_app_memory_statistics_get,
+     NULL,
+     bpy_app_memory_statistics_doc,
+     NULL},
     {"driver_namespace", bpy_app_driver_dict_get, NULL, bpy_app_driver_dict_doc, NULL},
 
     {"render_icon_size",
@@ -255,7 +255,9 @@ RenderPass *render_layer_add_pass(RenderResult *rr,
     float *rect;
     int x;
 
+    const eMEM_Tag tag_prev = MEM_tag_set(MEM_TAG_RENDER);
     rpass->rect = MEM_callocN(sizeof(float) * rectsize, name);
+    MEM_tag_set(tag_prev);
     if (rpass->rect == NULL) {
       MEM_freeN(rpass);
       return NULL;
@@ -75,6 +75,7 @@
 #include "BKE_autoexec.h"
 #include "BKE_blender.h"
 #include "BKE_blendfile.h"
+#include "BKE_bvhutils.h"
 #include "BKE_callbacks.h"
 #include "BKE_context.h"
 #include "BKE_global.h"
@@ -576,6 +577,9 @@ static void wm_file_read_post(bContext *C,
       wm_window_ghostwindows_remove_invalid(C, wm);
     }
     CTX_wm_window_set(C, wm->windows.first);
+
+    /* Trees of the meshes of the previous file. */
+    bvhcache_shared_clear_unused();
   }
 
 #ifdef WITH_PYTHON
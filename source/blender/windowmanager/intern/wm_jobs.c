@@ -30,6 +30,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -381,12 +382,42 @@ void WM_jobs_callbacks(wmJob *wm_job,
   wm_job->endjob = endjob;
 }
 
+static void do_job_thread_run(void *job_v)
+{
+  wmJob *wm_job = job_v;
+  wm_job->startjob(wm_job->run_customdata, &wm_job->stop, &wm_job->do_update, &wm_job->progress);
+}
+
+/* Offline work like renders and bakes, which should not slow down interactive work. Other jobs
+ * like shader compilation and previews are needed by the interface, so they keep the normal
+ * priority. */
+static bool wm_job_is_background(const wmJob *wm_job)
+{
+  switch (wm_job->job_type) {
+    case WM_JOB_TYPE_RENDER:
+    case WM_JOB_TYPE_OBJECT_BAKE_TEXTURE:
+    case WM_JOB_TYPE_OBJECT_BAKE:
+    case WM_JOB_TYPE_OBJECT_SIM_OCEAN:
+    case WM_JOB_TYPE_OBJECT_SIM_FLUID:
+    case WM_JOB_TYPE_POINTCACHE:
+    case WM_JOB_TYPE_DPAINT_BAKE:
+    case WM_JOB_TYPE_LIGHT_BAKE:
+    case WM_JOB_TYPE_SEQ_BUILD_PROXY:
+    case WM_JOB_TYPE_CLIP_BUILD_PROXY:
+      return true;
+  }
+  return false;
+}
+
 static void *do_job_thread(void *job_v)
 {
   wmJob *wm_job = job_v;
 
   BLI_thread_put_thread_on_fast_node();
-  wm_job->startjob(wm_job->run_customdata, &wm_job->stop, &wm_job->do_update, &wm_job->progress);
+  BLI_task_scheduler_run_with_priority(
+      wm_job_is_background(wm_job) ? TASK_PRIORITY_LOW : TASK_PRIORITY_HIGH,
+      do_job_thread_run,
+      wm_job);
   wm_job->ready = true;
 
   return NULL;